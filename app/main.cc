@@ -4,14 +4,22 @@
 #include <deadfood/lex/lex.hh>
 
 #include <deadfood/parse/create_table_parser.hh>
+#include <deadfood/parse/create_index_parser.hh>
 #include <deadfood/parse/drop_table_parser.hh>
+#include <deadfood/parse/drop_index_parser.hh>
+#include <deadfood/parse/analyze_parser.hh>
+#include <deadfood/parse/vacuum_parser.hh>
 #include <deadfood/parse/insert_parser.hh>
 #include <deadfood/parse/select_parser.hh>
 #include <deadfood/parse/update_parser.hh>
 #include <deadfood/parse/delete_parser.hh>
 
 #include <deadfood/exec/create_table.hh>
+#include <deadfood/exec/create_index.hh>
 #include <deadfood/exec/drop_table.hh>
+#include <deadfood/exec/drop_index.hh>
+#include <deadfood/exec/analyze.hh>
+#include <deadfood/exec/vacuum.hh>
 #include <deadfood/exec/insert_into.hh>
 #include <deadfood/exec/select.hh>
 #include <deadfood/exec/update.hh>
@@ -23,12 +31,26 @@
 using namespace deadfood;
 
 void ProcessQueryInternal(Database& db, const std::vector<lex::Token>& tokens) {
-  if (IsKeyword(tokens[0], lex::Keyword::Create)) {  // create table query
+  if (IsKeyword(tokens[0], lex::Keyword::Create) && tokens.size() > 1 &&
+      IsKeyword(tokens[1], lex::Keyword::Index)) {  // create index query
+    const auto q = parse::ParseCreateIndexQuery(tokens);
+    exec::ExecuteCreateIndexQuery(db, q);
+  } else if (IsKeyword(tokens[0], lex::Keyword::Create)) {  // create table
     const auto q = parse::ParseCreateTableQuery(tokens);
     exec::ExecuteCreateTableQuery(db, q);
+  } else if (IsKeyword(tokens[0], lex::Keyword::Drop) && tokens.size() > 1 &&
+             IsKeyword(tokens[1], lex::Keyword::Index)) {  // drop index query
+    const auto q = parse::ParseDropIndexQuery(tokens);
+    exec::ExecuteDropIndexQuery(db, q);
   } else if (IsKeyword(tokens[0], lex::Keyword::Drop)) {  // drop table query
     const auto q = parse::ParseDropTableQuery(tokens);
     exec::ExecuteDropTableQuery(db, q);
+  } else if (IsKeyword(tokens[0], lex::Keyword::Analyze)) {  // analyze query
+    const auto q = parse::ParseAnalyzeQuery(tokens);
+    exec::ExecuteAnalyzeQuery(db, q);
+  } else if (IsKeyword(tokens[0], lex::Keyword::Vacuum)) {  // vacuum query
+    const auto q = parse::ParseVacuumQuery(tokens);
+    exec::ExecuteVacuumQuery(db, q);
   } else if (IsKeyword(tokens[0], lex::Keyword::Update)) {  // update query
     const auto q = parse::ParseUpdateQuery(tokens);
     exec::ExecuteUpdateQuery(db, q);
@@ -51,31 +73,34 @@ void ProcessQueryInternal(Database& db, const std::vector<lex::Token>& tokens) {
 
     std::cout << '\n';
 
+    scan::ColumnBatch batch{fields};
     while (true) {
       try {
-        if (!scan->Next()) {
+        if (!scan->NextBatch(batch)) {
           break;
         }
-        for (size_t i = 0; i < fields.size(); ++i) {
-          const auto value = scan->GetField(fields[i]);
+        for (const auto row : batch.selection()) {
+          for (size_t i = 0; i < fields.size(); ++i) {
+            const auto value = batch.column(i).Get(row);
 
-          std::visit(
-              [&](auto&& arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, core::null_t>) {
-                  std::cout << "NULL";
-                } else if constexpr (std::is_same_v<T, std::string>) {
-                  std::cout << '\'' << arg << '\'';  // TODO: handle \n...
-                } else {
-                  std::cout << arg;
-                }
-              },
-              value);
-          if (i != fields.size() - 1) {
-            std::cout << '|';
+            std::visit(
+                [&](auto&& arg) {
+                  using T = std::decay_t<decltype(arg)>;
+                  if constexpr (std::is_same_v<T, core::null_t>) {
+                    std::cout << "NULL";
+                  } else if constexpr (std::is_same_v<T, std::string>) {
+                    std::cout << '\'' << arg << '\'';  // TODO: handle \n...
+                  } else {
+                    std::cout << arg;
+                  }
+                },
+                value);
+            if (i != fields.size() - 1) {
+              std::cout << '|';
+            }
           }
+          std::cout << '\n';
         }
-        std::cout << '\n';
       } catch (const std::exception& ex) {
         throw std::runtime_error("failed to execute query");
       }
@@ -116,10 +141,19 @@ int ProcessQuery(Database& db, const std::string& query) {
 
 int main(int argc, char** argv) {
   std::optional<char*> path;
+  LoadOptions options;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string_view{argv[i]} == "--mmap") {
+      options.map_files = true;
+    } else if (std::string_view{argv[i]} == "--lazy") {
+      options.lazy = true;
+    } else {
+      path = argv[i];
+    }
+  }
   Database db;
-  if (argc == 2) {
-    path = argv[1];
-    db = Load(path.value());
+  if (path.has_value()) {
+    db = Load(path.value(), options);
   } else {
     std::cout << "! in-memory\n";
   }
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+
+namespace deadfood::binary {
+
+// writes `value` big-endian at `data`, returns the end of what was written
+template <std::unsigned_integral T>
+char* EncodeUint(char* data, T value) {
+  for (size_t i = sizeof(T); i-- > 0;) {
+    data[i] = static_cast<char>(value & 0xff);
+    value = static_cast<T>(value >> 8);
+  }
+  return data + sizeof(T);
+}
+
+// reads a big-endian `T` from `data`
+template <std::unsigned_integral T>
+T DecodeUint(const char* data) {
+  T value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    value = static_cast<T>((value << 8) | static_cast<unsigned char>(data[i]));
+  }
+  return value;
+}
+
+}  // namespace deadfood::binary
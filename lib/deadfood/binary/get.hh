@@ -2,21 +2,20 @@
 
 #include <istream>
 #include <cstdint>
+#include <string>
 #include <type_traits>
 #include <concepts>
 
+#include <deadfood/binary/big_endian.hh>
+
 namespace deadfood::binary {
 
+// big-endian, read with a single call
 template <std::unsigned_integral T>
 T GetUint(std::istream& stream) {
-  const size_t bytes_count = sizeof(T);
-  T num = 0;
-  for (size_t i = 0; i < bytes_count; ++i) {
-    char ch;
-    stream.get(ch);
-    num = (num << 8) | static_cast<T>(static_cast<uint8_t>(ch));
-  }
-  return num;
+  char bytes[sizeof(T)] = {};
+  stream.read(bytes, sizeof(T));
+  return DecodeUint<T>(bytes);
 };
 
 template <std::signed_integral T>
@@ -25,20 +24,13 @@ T GetInt(std::istream& stream) {
   return static_cast<T>(GetUint<UnsignedT>(stream));
 }
 
-std::string GetCString(std::istream& stream) {
-  char ch;
+inline std::string GetCString(std::istream& stream) {
   std::string ret;
-  while (stream) {
-    stream.get(ch);
-    if (ch == 0) {
-      break;
-    }
-    ret += ch;
-  }
+  std::getline(stream, ret, '\0');
   return ret;
 }
 
-std::unique_ptr<char[]> GetBytes(std::istream& stream, size_t size) {
+inline std::unique_ptr<char[]> GetBytes(std::istream& stream, size_t size) {
   auto ptr = std::make_unique<char[]>(size);
   stream.read(ptr.get(), static_cast<long>(size));
   return ptr;
@@ -5,17 +5,16 @@
 #include <type_traits>
 #include <concepts>
 
+#include <deadfood/binary/big_endian.hh>
+
 namespace deadfood::binary {
 
+// big-endian, written with a single call
 template <std::unsigned_integral T>
 void PutUint(std::ostream& stream, T val) {
-  const size_t bytes_count = sizeof(T);
-  for (int i = bytes_count - 1; i >= 0; --i) {
-    auto shift = static_cast<size_t>(8 * i);
-    const T mask = 0xff << shift;
-    const auto byte = static_cast<uint8_t>((val & mask) >> shift);
-    stream.put(static_cast<char>(byte));
-  }
+  char bytes[sizeof(T)];
+  EncodeUint(bytes, val);
+  stream.write(bytes, sizeof(T));
 }
 
 template <std::signed_integral T>
@@ -23,11 +22,11 @@ void PutInt(std::ostream& stream, T val) {
   PutUint(stream, std::make_unsigned_t<T>(val));
 }
 
-void PutCString(std::ostream& stream, const std::string& string) {
+inline void PutCString(std::ostream& stream, const std::string& string) {
   stream.write(string.c_str(), static_cast<long>(string.size() + 1));
 }
 
-void PutBytes(std::ostream& stream, const char* bytes, size_t size) {
+inline void PutBytes(std::ostream& stream, const char* bytes, size_t size) {
   stream.write(bytes, static_cast<long>(size));
 }
 
@@ -0,0 +1,75 @@
+#include "field_key.hh"
+
+#include <functional>
+#include <optional>
+
+#include <deadfood/util/is_number_t.hh>
+
+namespace deadfood::core {
+
+std::optional<double> AsNumber(const FieldVariant& value) {
+  return std::visit(
+      [](auto&& arg) -> std::optional<double> {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (deadfood::util::IsNumberT<T>::value) {
+          return static_cast<double>(arg);
+        }
+        return std::nullopt;
+      },
+      value);
+}
+
+size_t FieldKeyHash::operator()(const FieldVariant& value) const {
+  if (const auto number = AsNumber(value)) {
+    // +0.0 and -0.0 compare equal, so they must hash equally too
+    return number.value() == 0 ? 0 : std::hash<double>{}(number.value());
+  }
+  if (const auto* str = std::get_if<std::string>(&value)) {
+    return std::hash<std::string>{}(*str);
+  }
+  return 0;
+}
+
+bool FieldKeyEqual::operator()(const FieldVariant& lhs,
+                               const FieldVariant& rhs) const {
+  const auto lhs_number = AsNumber(lhs);
+  const auto rhs_number = AsNumber(rhs);
+  if (lhs_number.has_value() || rhs_number.has_value()) {
+    return lhs_number == rhs_number;
+  }
+  return lhs == rhs;
+}
+
+int KeyRank(const FieldVariant& value) {
+  if (AsNumber(value).has_value()) {
+    return 0;
+  }
+  return std::holds_alternative<std::string>(value) ? 1 : 2;
+}
+
+bool FieldKeyLess::operator()(const FieldVariant& lhs,
+                              const FieldVariant& rhs) const {
+  const int lhs_rank = KeyRank(lhs);
+  const int rhs_rank = KeyRank(rhs);
+  if (lhs_rank != rhs_rank) {
+    return lhs_rank < rhs_rank;
+  }
+  if (lhs_rank == 0) {
+    return AsNumber(lhs).value() < AsNumber(rhs).value();
+  }
+  if (lhs_rank == 1) {
+    return std::get<std::string>(lhs) < std::get<std::string>(rhs);
+  }
+  return false;
+}
+
+size_t MixHash(size_t hash) {
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+}  // namespace deadfood::core
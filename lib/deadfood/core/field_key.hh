@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+#include <deadfood/core/field.hh>
+
+namespace deadfood::core {
+
+// Hashing and equality of field values used as lookup keys. They follow the
+// semantics of `=` in expressions: numbers of different types are equal when
+// their values are (1 = 1.0 = true), strings are compared exactly and NULL
+// matches NULL. The ordering puts numbers (by value) before strings
+// (lexicographically) and NULL after everything else.
+
+struct FieldKeyHash {
+  size_t operator()(const FieldVariant& value) const;
+};
+
+struct FieldKeyEqual {
+  bool operator()(const FieldVariant& lhs, const FieldVariant& rhs) const;
+};
+
+struct FieldKeyLess {
+  bool operator()(const FieldVariant& lhs, const FieldVariant& rhs) const;
+};
+
+// spreads the bits of a hash, so that any range of them can pick a partition
+// or a slot of an open-addressing table
+size_t MixHash(size_t hash);
+
+}  // namespace deadfood::core
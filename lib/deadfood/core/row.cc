@@ -6,56 +6,54 @@ FieldVariant Row::GetField(const std::string& field_name) const {
   if (IsNull(field_name)) {
     return null_t{};
   }
-  const size_t offset = schema_.Offset(field_name);
+  const auto cell = storage_.GetCell(slot_, schema_.Index(field_name));
   const auto info = schema_.field_info(field_name);
   switch (info.type()) {
     case Field::FieldType::Bool:
-      return storage_.ReadBool(offset);
+      return cell.ReadBool(0);
     case Field::FieldType::Int:
-      return storage_.ReadInt(offset);
+      return cell.ReadInt(0);
     case Field::FieldType::Float:
-      return storage_.ReadFloat(offset);
+      return cell.ReadFloat(0);
     case Field::FieldType::Double:
-      return storage_.ReadDouble(offset);
+      return cell.ReadDouble(0);
     case Field::FieldType::Varchar:
-      return storage_.ReadVarchar(offset, info.size());
+      return cell.ReadVarchar(0, info.size());
   }
 }
 
 void Row::SetField(const std::string& field_name, const FieldVariant& value) {
+  const size_t idx = schema_.Index(field_name);
   if (std::holds_alternative<null_t>(value)) {
-    const size_t idx = schema_.Index(field_name);
-    const size_t raw_idx = idx / 8;
-    const auto bit_mask = static_cast<uint8_t>(1 << (idx % 8));
-    const uint8_t modified_byte =
-        static_cast<uint8_t>(storage_.ReadByte(raw_idx)) | bit_mask;
-    storage_.WriteByte(raw_idx, static_cast<char>(modified_byte));
+    storage_.SetNull(slot_, idx, true);
     return;
   }
-  const size_t offset = schema_.Offset(field_name);
+  storage_.SetNull(slot_, idx, false);
+
+  auto cell = storage_.GetCell(slot_, idx);
   const auto info = schema_.field_info(field_name);
   std::visit(
       [&](auto&& v) {
         using T = std::decay_t<decltype(v)>;
         if constexpr (std::is_same_v<T, bool>) {
           if (info.type() == Field::FieldType::Bool) {
-            storage_.WriteBool(offset, v);
+            cell.WriteBool(0, v);
           }
         } else if constexpr (std::is_same_v<T, int>) {
           if (info.type() == Field::FieldType::Int) {
-            storage_.WriteInt(offset, v);
+            cell.WriteInt(0, v);
           }
         } else if constexpr (std::is_same_v<T, float>) {
           if (info.type() == Field::FieldType::Float) {
-            storage_.WriteFloat(offset, v);
+            cell.WriteFloat(0, v);
           }
         } else if constexpr (std::is_same_v<T, double>) {
           if (info.type() == Field::FieldType::Double) {
-            storage_.WriteDouble(offset, v);
+            cell.WriteDouble(0, v);
           }
         } else if constexpr (std::is_same_v<T, std::string>) {
           if (info.type() == Field::FieldType::Varchar) {
-            storage_.WriteVarchar(offset, v.data(), info.size());
+            cell.WriteVarchar(0, v.data(), v.size(), info.size());
           }
         }
       },
@@ -63,10 +61,7 @@ void Row::SetField(const std::string& field_name, const FieldVariant& value) {
 }
 
 bool Row::IsNull(const std::string& field_name) const {
-  const size_t idx = schema_.Index(field_name);
-  const size_t raw_idx = idx / 8;
-  const auto bit_mask = static_cast<uint8_t>(1 << (idx % 8));
-  return static_cast<uint8_t>(storage_.ReadByte(raw_idx)) & bit_mask;
+  return storage_.IsNull(slot_, schema_.Index(field_name));
 }
 
 }  // namespace deadfood::core
\ No newline at end of file
@@ -1,14 +1,15 @@
 #pragma once
 
 #include <deadfood/core/schema.hh>
-#include <deadfood/storage/byte_buffer.hh>
+#include <deadfood/storage/table_storage.hh>
 
 namespace deadfood::core {
 
+// Field-by-name access to one slot of a table, whatever its layout.
 class Row {
  public:
-  Row(storage::ByteBuffer& storage, const Schema& schema)
-      : storage_{storage}, schema_{schema} {}
+  Row(storage::TableStorage& storage, size_t slot, const Schema& schema)
+      : storage_{storage}, slot_{slot}, schema_{schema} {}
 
   [[nodiscard]] FieldVariant GetField(const std::string& field_name) const;
   void SetField(const std::string& field_name, const FieldVariant& value);
@@ -16,7 +17,8 @@ class Row {
   [[nodiscard]] bool IsNull(const std::string& field_name) const;
 
  private:
-  storage::ByteBuffer& storage_;
+  storage::TableStorage& storage_;
+  size_t slot_;
   const Schema& schema_;
 };
 
@@ -0,0 +1,78 @@
+#include "row_set.hh"
+
+#include <cstring>
+#include <functional>
+
+#include <deadfood/core/field_key.hh>
+#include <deadfood/util/is_number_t.hh>
+
+namespace deadfood::core {
+
+template <typename T>
+void AppendBytes(const T& value, std::string& out) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  out.append(bytes, sizeof(T));
+}
+
+void EncodeRow(const std::vector<FieldVariant>& values, std::string& out) {
+  out.clear();
+  for (const auto& value : values) {
+    std::visit(
+        [&](auto&& arg) {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (deadfood::util::IsNumberT<T>::value) {
+            auto number = static_cast<double>(arg);
+            if (number == 0) {
+              number = 0;  // -0.0
+            }
+            out.push_back('d');
+            AppendBytes(number, out);
+          } else if constexpr (std::is_same_v<T, std::string>) {
+            out.push_back('s');
+            AppendBytes(arg.size(), out);
+            out.append(arg);
+          } else {
+            out.push_back('n');
+          }
+        },
+        value);
+  }
+}
+
+uint64_t Fingerprint(std::string_view row) {
+  return MixHash(std::hash<std::string_view>{}(row));
+}
+
+RowSet::RowSet() : offsets_{0} {}
+
+std::string_view RowSet::Row(size_t row) const {
+  return std::string_view(arena_).substr(offsets_[row],
+                                         offsets_[row + 1] - offsets_[row]);
+}
+
+bool RowSet::Insert(std::string_view row) {
+  const auto [_, added] = slots_.FindOrAdd(
+      Fingerprint(row), [&](size_t other) { return Row(other) == row; });
+  if (added) {
+    arena_.append(row);
+    offsets_.push_back(arena_.size());
+  }
+  return added;
+}
+
+bool RowSet::Contains(std::string_view row) const {
+  return slots_
+      .Find(Fingerprint(row), [&](size_t other) { return Row(other) == row; })
+      .has_value();
+}
+
+size_t RowSet::size() const { return slots_.size(); }
+
+void RowSet::Clear() {
+  arena_.clear();
+  offsets_.assign(1, 0);
+  slots_.Clear();
+}
+
+}  // namespace deadfood::core
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <deadfood/core/field.hh>
+#include <deadfood/core/slot_table.hh>
+
+namespace deadfood::core {
+
+// Encodes a row of values into `out`, replacing its contents. Rows encode to
+// the same bytes exactly when their values are equal as lookup keys: numbers
+// of any type are stored as doubles and NULL equals NULL.
+void EncodeRow(const std::vector<FieldVariant>& values, std::string& out);
+
+// A set of encoded rows, for DISTINCT and the set operations. The rows are
+// appended to a single arena and found through a slot table of row numbers,
+// probed by a 64-bit fingerprint of their bytes; the bytes are only compared
+// when the fingerprints match.
+class RowSet {
+ public:
+  RowSet();
+
+  // returns false if the row is already there
+  bool Insert(std::string_view row);
+  [[nodiscard]] bool Contains(std::string_view row) const;
+
+  [[nodiscard]] size_t size() const;
+  void Clear();
+
+ private:
+  [[nodiscard]] std::string_view Row(size_t row) const;
+
+  std::string arena_;
+  // row `r` is arena_[offsets_[r], offsets_[r + 1])
+  std::vector<size_t> offsets_;
+  SlotTable slots_;
+};
+
+}  // namespace deadfood::core
@@ -0,0 +1,45 @@
+#include "slot_table.hh"
+
+#include <limits>
+#include <stdexcept>
+
+namespace deadfood::core {
+
+constexpr size_t kInitialSlots = 64;
+
+SlotTable::SlotTable() : slots_(kInitialSlots, 0) {}
+
+size_t SlotTable::size() const { return hashes_.size(); }
+
+void SlotTable::Clear() {
+  hashes_.clear();
+  slots_.assign(kInitialSlots, 0);
+}
+
+size_t SlotTable::Add(size_t slot, uint64_t hash) {
+  if (size() == std::numeric_limits<uint32_t>::max() - 1) {
+    throw std::runtime_error("too many distinct keys");
+  }
+  const size_t entry = size();
+  slots_[slot] = static_cast<uint32_t>(entry + 1);
+  hashes_.push_back(hash);
+  // at most half of the slots are taken, so probe sequences stay short
+  if (size() * 2 > slots_.size()) {
+    Grow();
+  }
+  return entry;
+}
+
+void SlotTable::Grow() {
+  slots_.assign(slots_.size() * 2, 0);
+  const size_t mask = slots_.size() - 1;
+  for (size_t entry = 0; entry < size(); ++entry) {
+    size_t slot = hashes_[entry] & mask;
+    while (slots_[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+    slots_[slot] = static_cast<uint32_t>(entry + 1);
+  }
+}
+
+}  // namespace deadfood::core
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace deadfood::core {
+
+// An open-addressing table of entry numbers, for the hash tables that keep
+// their entries elsewhere (RowSet, HashAggregateScan). Entries are numbered
+// 0, 1, ... in the order they are added and are found through the 64-bit
+// hash they were added with; the owner compares the entries themselves only
+// when the hashes match.
+class SlotTable {
+ public:
+  SlotTable();
+
+  // the entry with `hash` for which `equal(entry)` holds
+  template <typename Equal>
+  [[nodiscard]] std::optional<size_t> Find(uint64_t hash, Equal equal) const {
+    const size_t slot = FindSlot(hash, equal);
+    if (slots_[slot] == 0) {
+      return std::nullopt;
+    }
+    return slots_[slot] - 1;
+  }
+
+  // the entry with `hash` for which `equal(entry)` holds, with false; if
+  // there is none, entry `size()` is added and returned with true
+  template <typename Equal>
+  std::pair<size_t, bool> FindOrAdd(uint64_t hash, Equal equal) {
+    const size_t slot = FindSlot(hash, equal);
+    if (slots_[slot] != 0) {
+      return {slots_[slot] - 1, false};
+    }
+    return {Add(slot, hash), true};
+  }
+
+  [[nodiscard]] size_t size() const;
+  void Clear();
+
+ private:
+  // the slot holding the entry, or the empty slot where it would go
+  template <typename Equal>
+  [[nodiscard]] size_t FindSlot(uint64_t hash, Equal& equal) const {
+    const size_t mask = slots_.size() - 1;
+    size_t slot = hash & mask;
+    while (slots_[slot] != 0) {
+      const size_t entry = slots_[slot] - 1;
+      if (hashes_[entry] == hash && equal(entry)) {
+        break;
+      }
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  size_t Add(size_t slot, uint64_t hash);
+  void Grow();
+
+  std::vector<uint64_t> hashes_;
+  // entry number + 1 per slot, 0 for an empty slot; the size is a power of 2
+  std::vector<uint32_t> slots_;
+};
+
+}  // namespace deadfood::core
@@ -0,0 +1,92 @@
+#include "table_stats.hh"
+
+#include <algorithm>
+
+#include <deadfood/core/field_key.hh>
+#include <deadfood/core/row.hh>
+
+namespace deadfood::core {
+
+constexpr size_t kHistogramBuckets = 16;
+
+double ColumnStats::FractionBelow(double value, bool inclusive) const {
+  if (bounds.empty()) {
+    return 0;
+  }
+  // share of the values equal to any one of them
+  const double equal =
+      distinct_count > 0 ? 1.0 / static_cast<double>(distinct_count) : 0;
+  if (value < bounds.front() || (value == bounds.front() && !inclusive)) {
+    return 0;
+  }
+  if (value > bounds.back()) {
+    return 1;
+  }
+  const size_t buckets = bounds.size() - 1;
+  // the last bound not above `value`
+  const auto bucket = static_cast<size_t>(
+      std::upper_bound(bounds.begin(), bounds.end(), value) - bounds.begin() -
+      1);
+  // values are assumed to spread evenly within a bucket
+  double fraction = 1 - equal;
+  if (bucket < buckets) {
+    const double low = bounds[bucket];
+    const double high = bounds[bucket + 1];
+    const double within = high > low ? (value - low) / (high - low) : 0;
+    fraction = (static_cast<double>(bucket) + within) /
+               static_cast<double>(buckets);
+  }
+  return std::clamp(inclusive ? fraction + equal : fraction, 0.0, 1.0);
+}
+
+double ToDouble(const FieldVariant& value) {
+  return std::visit(
+      [](auto&& arg) -> double {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, int> ||
+                      std::is_same_v<T, float> || std::is_same_v<T, double>) {
+          return static_cast<double>(arg);
+        }
+        return 0;
+      },
+      value);
+}
+
+TableStats CollectTableStats(storage::TableStorage& storage,
+                             const Schema& schema) {
+  TableStats stats{.row_count = storage.size(), .columns = {}};
+  for (const auto& field : schema.fields()) {
+    ColumnStats column{.null_count = 0, .distinct_count = 0, .bounds = {}};
+    std::vector<FieldVariant> values;
+    for (size_t slot = 0; slot < storage.slot_count(); ++slot) {
+      if (!storage.IsLive(slot)) {
+        continue;
+      }
+      const auto row = Row(storage, slot, schema);
+      if (row.IsNull(field)) {
+        ++column.null_count;
+      } else {
+        values.push_back(row.GetField(field));
+      }
+    }
+
+    std::sort(values.begin(), values.end(), FieldKeyLess{});
+    const FieldKeyEqual equal;
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (i == 0 || !equal(values[i - 1], values[i])) {
+        ++column.distinct_count;
+      }
+    }
+    if (schema.field_info(field).type() != Field::FieldType::Varchar &&
+        !values.empty()) {
+      for (size_t bucket = 0; bucket <= kHistogramBuckets; ++bucket) {
+        column.bounds.push_back(
+            ToDouble(values[bucket * (values.size() - 1) / kHistogramBuckets]));
+      }
+    }
+    stats.columns.emplace(field, std::move(column));
+  }
+  return stats;
+}
+
+}  // namespace deadfood::core
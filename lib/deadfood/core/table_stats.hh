@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <deadfood/core/schema.hh>
+#include <deadfood/storage/table_storage.hh>
+
+namespace deadfood::core {
+
+// Statistics of one column, collected by ANALYZE.
+struct ColumnStats {
+  size_t null_count;
+  size_t distinct_count;
+  // Equi-depth histogram of the non-NULL values of a numeric column: about as
+  // many values fall between each pair of neighbouring bounds. The first and
+  // last bound are the minimum and the maximum. Empty for varchar columns and
+  // for columns without non-NULL values.
+  std::vector<double> bounds;
+
+  // estimated fraction of the non-NULL values below `value`, or not above it
+  // if `inclusive`
+  [[nodiscard]] double FractionBelow(double value, bool inclusive) const;
+};
+
+struct TableStats {
+  size_t row_count;
+  std::map<std::string, ColumnStats> columns;
+};
+
+// the value of a bool, int, float or double field as a double, 0 otherwise
+double ToDouble(const FieldVariant& value);
+
+TableStats CollectTableStats(storage::TableStorage& storage,
+                             const Schema& schema);
+
+}  // namespace deadfood::core
@@ -2,13 +2,42 @@
 
 #include <algorithm>
 #include <istream>
+#include <iterator>
 #include <fstream>
+#include <optional>
 
+#include <deadfood/core/row.hh>
+#include <deadfood/binary/big_endian.hh>
 #include <deadfood/binary/get.hh>
 #include <deadfood/binary/put.hh>
+#include <deadfood/storage/block_file.hh>
+#include <deadfood/storage/page_file.hh>
+#include <deadfood/util/thread_pool.hh>
 
 namespace deadfood {
 
+template <typename Index>
+void FillIndex(Index& index, storage::TableStorage& storage,
+               const core::Schema& schema, const std::string& field) {
+  for (size_t slot = 0; slot < storage.slot_count(); ++slot) {
+    if (storage.IsLive(slot)) {
+      const auto row = core::Row(storage, slot, schema);
+      index.Insert(row.GetField(field), storage.RowIdAt(slot));
+    }
+  }
+}
+
+// creates a hash index for every unique column and fills it with the rows
+// already stored in the table
+void BuildHashIndices(storage::TableStorage& storage,
+                      const core::Schema& schema) {
+  for (const auto& field : schema.fields()) {
+    if (schema.IsUnique(field)) {
+      FillIndex(storage.AddHashIndex(field), storage, schema, field);
+    }
+  }
+}
+
 void RemoveUnnecessaryConstraints(std::vector<core::Constraint>& constraints,
                                   const std::string& slave_table_name) {
   std::remove_if(
@@ -23,10 +52,10 @@ void RemoveUnnecessaryConstraints(std::vector<core::Constraint>& constraints,
       });
 }
 
-Database::Database(deadfood::storage::DBStorage& storage,
-                   std::map<std::string, core::Schema>& schemas,
-                   std::vector<core::Constraint>& constraints)
-    : storage_{std::move(storage)},
+Database::Database(std::map<std::string, core::Schema>& schemas,
+                   std::vector<core::Constraint>& constraints,
+                   std::map<std::string, TableLoader>& loaders)
+    : loaders_{std::move(loaders)},
       schemas_{std::move(schemas)},
       constraints_{std::move(constraints)} {
   for (const auto& [table_name, _] : schemas_) {
@@ -41,12 +70,62 @@ const std::vector<core::Constraint>& Database::constraints_const() const {
 }
 
 storage::TableStorage& Database::table_storage(const std::string& table_name) {
-  return storage_.Get(table_name);
+  return LoadedStorage(table_name);
 }
 
 const storage::TableStorage& Database::table_storage_const(
     const std::string& table_name) const {
-  return storage_.GetConst(table_name);
+  return LoadedStorage(table_name);
+}
+
+storage::Layout Database::layout(const std::string& table_name) const {
+  const auto it = loaders_.find(table_name);
+  return it != loaders_.end() ? it->second.layout
+                              : storage_.GetConst(table_name).layout();
+}
+
+bool Database::IsLoaded(const std::string& table_name) const {
+  return !loaders_.contains(table_name);
+}
+
+void Database::LoadTables() {
+  std::vector<const std::pair<const std::string, TableLoader>*> pending;
+  for (const auto& entry : loaders_) {
+    pending.push_back(&entry);
+  }
+  std::vector<std::optional<storage::TableStorage>> tables(pending.size());
+  util::ThreadPool::Shared().Run(pending.size(), [&](size_t, size_t i) {
+    tables[i].emplace(ReadTable(pending[i]->first, pending[i]->second));
+  });
+  for (size_t i = 0; i < pending.size(); ++i) {
+    storage_.Add(pending[i]->first, tables[i].value());
+  }
+  loaders_.clear();
+}
+
+storage::TableStorage& Database::LoadedStorage(
+    const std::string& table_name) const {
+  const auto it = loaders_.find(table_name);
+  if (it != loaders_.end()) {
+    auto table = ReadTable(table_name, it->second);
+    loaders_.erase(it);
+    storage_.Add(table_name, table);
+  }
+  return storage_.Get(table_name);
+}
+
+storage::TableStorage Database::ReadTable(const std::string& table_name,
+                                          const TableLoader& loader) const {
+  auto table = loader.load();
+  const auto& schema = schemas_.at(table_name);
+  BuildHashIndices(table, schema);
+  for (const auto& [_, index] : indices_) {
+    if (index.table_name == table_name) {
+      FillIndex(table.AddBTreeIndex(index.field_name), table, schema,
+                index.field_name);
+    }
+  }
+  return table;
 }
 
 const std::set<std::string>& Database::table_names() const {
@@ -62,13 +141,14 @@ bool Database::Exists(const std::string& table_name) const {
 }
 
 void Database::AddTable(const std::string& table_name,
-                        const core::Schema& schema) {
+                        const core::Schema& schema, storage::Layout layout) {
   if (Exists(table_name)) {
     return;
   }
   table_names_.emplace(table_name);
   schemas_.emplace(table_name, schema);
-  storage_.Add(table_name);
+  storage_.Add(table_name, schema, layout);
+  BuildHashIndices(storage_.Get(table_name), schema);
 }
 
 void Database::RemoveTable(const std::string& table_name) {
@@ -77,148 +157,726 @@ void Database::RemoveTable(const std::string& table_name) {
   }
   table_names_.erase(table_name);
   schemas_.erase(table_name);
+  loaders_.erase(table_name);
   storage_.Remove(table_name);
   RemoveUnnecessaryConstraints(constraints_, table_name);
+  std::erase_if(indices_, [&](const auto& entry) {
+    return entry.second.table_name == table_name;
+  });
+  stats_.erase(table_name);
+}
+
+const std::map<std::string, IndexDefinition>& Database::indices() const {
+  return indices_;
+}
+
+void Database::AddIndex(const std::string& index_name,
+                        const IndexDefinition& index) {
+  // a table not loaded yet gets the index as it is loaded
+  if (IsLoaded(index.table_name)) {
+    auto& storage = storage_.Get(index.table_name);
+    FillIndex(storage.AddBTreeIndex(index.field_name), storage,
+              schemas_.at(index.table_name), index.field_name);
+  }
+  indices_.emplace(index_name, index);
+}
+
+void Database::RemoveIndex(const std::string& index_name) {
+  const auto it = indices_.find(index_name);
+  if (it == indices_.end()) {
+    return;
+  }
+  if (IsLoaded(it->second.table_name)) {
+    storage_.Get(it->second.table_name)
+        .RemoveBTreeIndex(it->second.field_name);
+  }
+  indices_.erase(it);
 }
 
-std::unique_ptr<scan::IScan> Database::GetTableScan(
+const std::map<std::string, core::TableStats>& Database::stats() const {
+  return stats_;
+}
+
+void Database::SetStats(const std::string& table_name,
+                        core::TableStats stats) {
+  stats_.insert_or_assign(table_name, std::move(stats));
+}
+
+std::unique_ptr<scan::TableScan> Database::GetTableScan(
     const std::string& table_name) {
   auto& schema = schemas_.at(table_name);
-  auto& table_storage = storage_.Get(table_name);
+  auto& table_storage = LoadedStorage(table_name);
   return std::make_unique<scan::TableScan>(table_storage, schema, table_name);
 }
 
-std::unique_ptr<scan::IScan> Database::GetTableScan(
+std::unique_ptr<scan::TableScan> Database::GetTableScan(
     const std::string& table_name, const std::string& rename_table) {
   auto& schema = schemas_.at(table_name);
-  auto& table_storage = storage_.Get(table_name);
+  auto& table_storage = LoadedStorage(table_name);
   return std::make_unique<scan::TableScan>(table_storage, schema, rename_table);
 }
+
+storage::WriteAheadLog* Database::wal() const { return wal_.get(); }
+
+void Database::set_wal(std::unique_ptr<storage::WriteAheadLog> wal) {
+  wal_ = std::move(wal);
+}
+
+bool Database::failed() const { return failed_; }
+
+void Database::set_failed() { failed_ = true; }
+
+const storage::Manifest* Database::manifest(
+    const std::filesystem::path& path) const {
+  if (!manifest_.has_value() || !std::filesystem::exists(snapshot_path_) ||
+      !std::filesystem::equivalent(snapshot_path_, path)) {
+    return nullptr;
+  }
+  return &manifest_.value();
+}
+
+void Database::set_manifest(const std::filesystem::path& path,
+                            storage::Manifest manifest) {
+  snapshot_path_ = path;
+  manifest_ = std::move(manifest);
+}
+
+void DumpSchema(const std::string& table_name, const core::Schema& schema,
+                std::ostream& stream) {
+  binary::PutCString(stream, table_name);
+  binary::PutUint<uint32_t>(stream,
+                            static_cast<uint32_t>(schema.fields().size()));
+  for (const auto& field : schema.fields()) {
+    const auto& field_info = schema.field_info(field);
+    binary::PutCString(stream, field);
+    binary::PutUint<uint8_t>(stream,
+                             static_cast<uint8_t>(schema.MayBeNull(field)));
+    binary::PutUint<uint8_t>(stream,
+                             static_cast<uint8_t>(schema.IsUnique(field)));
+    binary::PutUint<uint8_t>(stream, static_cast<uint8_t>(field_info.type()));
+    binary::PutUint<uint32_t>(stream,
+                              static_cast<uint32_t>(field_info.size()));
+  }
+}
+
 void DumpSchemas(const std::map<std::string, core::Schema>& schemas,
                  std::ostream& stream) {
   for (const auto& [table_name, schema] : schemas) {
-    binary::PutCString(stream, table_name);
-    binary::PutUint<uint32_t>(stream, schema.fields().size());
-    for (const auto& field : schema.fields()) {
-      const auto& field_info = schema.field_info(field);
-      binary::PutCString(stream, field);
-      binary::PutUint<uint8_t>(stream,
-                               static_cast<uint8_t>(schema.MayBeNull(field)));
-      binary::PutUint<uint8_t>(stream,
-                               static_cast<uint8_t>(schema.IsUnique(field)));
-      binary::PutUint<uint8_t>(stream, static_cast<uint8_t>(field_info.type()));
-      binary::PutUint<uint32_t>(stream,
-                                static_cast<uint32_t>(field_info.size()));
-    }
+    DumpSchema(table_name, schema, stream);
+  }
+}
+
+void DumpConstraint(const core::Constraint& constraint, std::ostream& stream) {
+  if (!std::holds_alternative<core::ReferencesConstraint>(constraint)) {
+    throw std::runtime_error(
+        "a new type of constraint is added, but not handled");
   }
+  const auto& ref_constr = std::get<core::ReferencesConstraint>(constraint);
+  binary::PutCString(stream, ref_constr.slave_table);
+  binary::PutCString(stream, ref_constr.slave_field);
+  binary::PutCString(stream, ref_constr.master_table);
+  binary::PutCString(stream, ref_constr.master_field);
 }
 
 void DumpConstraints(const std::vector<core::Constraint>& constraints,
                      std::ostream& stream) {
   for (const auto& constraint : constraints) {
-    if (!std::holds_alternative<core::ReferencesConstraint>(constraint)) {
-      throw std::runtime_error(
-          "a new type of constraint is added, but not handled");
+    DumpConstraint(constraint, stream);
+  }
+}
+
+void DumpIndices(const std::map<std::string, IndexDefinition>& indices,
+                 std::ostream& stream) {
+  for (const auto& [index_name, index] : indices) {
+    binary::PutCString(stream, index_name);
+    binary::PutCString(stream, index.table_name);
+    binary::PutCString(stream, index.field_name);
+  }
+}
+
+// only tables that are not stored row-wise are listed
+void DumpLayouts(const Database& db, std::ostream& stream) {
+  for (const auto& table_name : db.table_names()) {
+    const auto layout = db.layout(table_name);
+    if (layout != storage::Layout::Row) {
+      binary::PutCString(stream, table_name);
+      binary::PutUint<uint8_t>(stream, static_cast<uint8_t>(layout));
     }
-    const auto& ref_constr = std::get<core::ReferencesConstraint>(constraint);
-    binary::PutCString(stream, ref_constr.slave_table);
-    binary::PutCString(stream, ref_constr.slave_field);
-    binary::PutCString(stream, ref_constr.master_table);
-    binary::PutCString(stream, ref_constr.master_field);
   }
 }
 
-void DumpTable(const storage::TableStorage& storage, std::ostream& stream) {
-  for (const auto& [rowid, row_buf] : storage.storage_const()) {
-    binary::PutUint<size_t>(stream, rowid);
-    binary::PutBytes(stream, row_buf.data(), row_buf.size());
+void DumpStats(const std::map<std::string, core::TableStats>& stats,
+               std::ostream& stream) {
+  for (const auto& [table_name, table] : stats) {
+    binary::PutCString(stream, table_name);
+    binary::PutUint<uint64_t>(stream, table.row_count);
+    binary::PutUint<uint32_t>(stream,
+                              static_cast<uint32_t>(table.columns.size()));
+    for (const auto& [field_name, column] : table.columns) {
+      binary::PutCString(stream, field_name);
+      binary::PutUint<uint64_t>(stream, column.null_count);
+      binary::PutUint<uint64_t>(stream, column.distinct_count);
+      binary::PutUint<uint32_t>(stream,
+                                static_cast<uint32_t>(column.bounds.size()));
+      for (const auto bound : column.bounds) {
+        binary::PutFloatingPoint(stream, bound);
+      }
+    }
   }
 }
 
-void Dump(const Database& db, const std::filesystem::path& path) {
-  std::ofstream schema_stream(path / ".schema", std::ios::binary);
-  DumpSchemas(db.schemas(), schema_stream);
+// How a segment file of version 3 or later keeps the row images: in its
+// records, or in the pages of a page file next to it.
+enum class SegmentRows : uint8_t { Inline = 0, Paged = 1 };
 
-  std::ofstream constraints_stream(path / ".constraints", std::ios::binary);
-  DumpConstraints(db.constraints_const(), constraints_stream);
+// Every slot of the segment in order: whether it holds a row and if so the
+// row id, and with the column layout the row image. Loading the segments in
+// order restores the slots as they were, which is what lets a clean segment
+// keep its file. A slot is one record of the block file, and rows are copied
+// straight into its buffer. The rows of a row-layout table are in its pages
+// already, which go to the page file as they are.
+void DumpSegment(const storage::TableStorage& storage, size_t segment,
+                 const std::filesystem::path& file,
+                 const std::filesystem::path& page_file) {
+  storage::BlockWriter writer(file);
+  const size_t begin = segment * storage::TableStorage::kSegmentSlots;
+  const size_t end = std::min(begin + storage::TableStorage::kSegmentSlots,
+                              storage.slot_count());
+  const bool paged = storage.layout() == storage::Layout::Row;
+  writer.PutUint<uint8_t>(static_cast<uint8_t>(
+      paged ? SegmentRows::Paged : SegmentRows::Inline));
+  const size_t image_size = paged ? 0 : storage.row_size();
+  for (size_t slot = begin; slot < end; ++slot) {
+    if (!storage.IsLive(slot)) {
+      writer.PutUint<uint8_t>(0);
+      continue;
+    }
+    char* record = writer.Append(1 + sizeof(uint64_t) + image_size);
+    record[0] = 1;
+    binary::EncodeUint<uint64_t>(record + 1, storage.RowIdAt(slot));
+    if (!paged) {
+      storage.ReadRow(slot, record + 1 + sizeof(uint64_t));
+    }
+  }
+  if (paged) {
+    // a segment is a whole number of pages, only the last one of the table
+    // may be partly used
+    std::vector<const char*> pages;
+    for (size_t page = begin / storage.slots_per_page();
+         page * storage.slots_per_page() < end; ++page) {
+      pages.push_back(storage.page(page));
+    }
+    storage::WritePageFile(page_file, pages, storage.page_size());
+  }
+  writer.Finish();
+}
+
+// writes a catalog file of a snapshot and flushes it to disk
+template <typename F>
+void DumpFile(const std::filesystem::path& file, F&& dump) {
+  std::ostringstream stream;
+  dump(stream);
+  storage::WriteSnapshotFile(file, stream.view());
+}
+
+void Dump(Database& db, const std::filesystem::path& path) {
+  if (db.failed()) {
+    throw std::runtime_error(
+        "a change could not be logged, the database must be loaded again");
+  }
+  const auto* previous = db.manifest(path);
+  const auto current = storage::ReadManifest(path);
+  const uint64_t generation =
+      (current.has_value() ? current->generation : 0) + 1;
+  storage::Manifest manifest{.generation = generation, .tables = {}};
+  const auto catalog_file = [&](const std::string& name) {
+    return path / storage::CatalogFileName(name, generation);
+  };
+
+  DumpFile(catalog_file(".schema"),
+           [&](std::ostream& stream) { DumpSchemas(db.schemas(), stream); });
+  DumpFile(catalog_file(".constraints"), [&](std::ostream& stream) {
+    DumpConstraints(db.constraints_const(), stream);
+  });
+  DumpFile(catalog_file(".indices"),
+           [&](std::ostream& stream) { DumpIndices(db.indices(), stream); });
+  DumpFile(catalog_file(".layouts"),
+           [&](std::ostream& stream) { DumpLayouts(db, stream); });
+  DumpFile(catalog_file(".stats"),
+           [&](std::ostream& stream) { DumpStats(db.stats(), stream); });
 
   for (const auto& table_name : db.table_names()) {
-    std::ofstream table_stream(path / (table_name + ".dat"), std::ios::binary);
-    const auto row_size = db.schemas().at(table_name).size();
-    DumpTable(db.table_storage_const(table_name), table_stream);
+    const std::vector<uint64_t>* written = nullptr;
+    if (previous != nullptr) {
+      const auto it = previous->tables.find(table_name);
+      written = it == previous->tables.end() ? nullptr : &it->second;
+    }
+    auto& segments = manifest.tables[table_name];
+    // a table that was never loaded is as the snapshot has it
+    if (written != nullptr && !db.IsLoaded(table_name)) {
+      segments = *written;
+      continue;
+    }
+    const auto& storage = db.table_storage_const(table_name);
+    for (size_t segment = 0; segment < storage.segment_count(); ++segment) {
+      if (written != nullptr && segment < written->size() &&
+          !storage.IsSegmentDirty(segment)) {
+        segments.push_back((*written)[segment]);
+        continue;
+      }
+      DumpSegment(
+          storage, segment,
+          path / storage::SegmentFileName(table_name, segment, generation),
+          path / storage::PageFileName(table_name, segment, generation));
+      segments.push_back(generation);
+    }
+  }
+  storage::WriteManifest(path, manifest);
+
+  // the snapshot holds every logged change now; a log left by another
+  // database would replay stale changes on top of it
+  const auto wal_path = path / ".wal";
+  auto* wal = db.wal();
+  if (wal != nullptr && std::filesystem::exists(wal_path) &&
+      std::filesystem::equivalent(wal->path(), wal_path)) {
+    wal->Truncate();
+  } else {
+    std::filesystem::remove(wal_path);
+  }
+
+  storage::RemoveUnusedFiles(path, manifest);
+  for (const auto& table_name : db.table_names()) {
+    if (db.IsLoaded(table_name)) {
+      db.table_storage(table_name).MarkClean();
+    }
+  }
+  db.set_manifest(path, std::move(manifest));
+}
+
+std::pair<std::string, core::Schema> LoadSchema(std::istream& stream) {
+  auto table_name = binary::GetCString(stream);
+  const uint32_t fields_count = binary::GetUint<uint32_t>(stream);
+  core::Schema schema;
+  for (uint32_t i = 0; i < fields_count; ++i) {
+    const auto field_name = binary::GetCString(stream);
+    const auto may_be_null =
+        static_cast<bool>(binary::GetUint<uint8_t>(stream));
+    const auto is_unique = static_cast<bool>(binary::GetUint<uint8_t>(stream));
+    const auto field_type =
+        static_cast<core::Field::FieldType>(binary::GetUint<uint8_t>(stream));
+    const uint32_t field_size = binary::GetUint<uint32_t>(stream);
+    schema.AddField(field_name, core::Field{field_type, field_size},
+                    may_be_null, is_unique);
   }
+  return {std::move(table_name), std::move(schema)};
 }
 
 std::map<std::string, core::Schema> LoadSchemas(std::istream& stream) {
   std::map<std::string, core::Schema> map;
   while (stream.peek(), !(stream.eof() || stream.fail())) {
-    const auto table_name = binary::GetCString(stream);
-    const uint32_t fields_count = binary::GetUint<uint32_t>(stream);
-    core::Schema schema;
-    for (uint32_t i = 0; i < fields_count; ++i) {
-      const auto field_name = binary::GetCString(stream);
-      const auto may_be_null =
-          static_cast<bool>(binary::GetUint<uint8_t>(stream));
-      const auto is_unique =
-          static_cast<bool>(binary::GetUint<uint8_t>(stream));
-      const auto field_type =
-          static_cast<core::Field::FieldType>(binary::GetUint<uint8_t>(stream));
-      const uint32_t field_size = binary::GetUint<uint32_t>(stream);
-      schema.AddField(field_name, core::Field{field_type, field_size},
-                      may_be_null, is_unique);
-    }
-    map.emplace(table_name, std::move(schema));
+    map.emplace(LoadSchema(stream));
   }
   return map;
 }
 
+core::Constraint LoadReferencesConstraint(std::istream& stream) {
+  const auto slave_table = binary::GetCString(stream);
+  const auto slave_field = binary::GetCString(stream);
+  const auto master_table = binary::GetCString(stream);
+  const auto master_field = binary::GetCString(stream);
+  return core::ReferencesConstraint{
+      .master_table = master_table,
+      .master_field = master_field,
+      .slave_table = slave_table,
+      .slave_field = slave_field,
+      .on_delete = core::ReferencesConstraint::OnAction::NoAction,
+      .on_update = core::ReferencesConstraint::OnAction::NoAction,
+  };
+}
+
 std::vector<core::Constraint> LoadConstraint(std::istream& stream) {
   std::vector<core::Constraint> ret;
 
   while (stream.peek(), !(stream.eof() || stream.fail())) {
-    const auto slave_table = binary::GetCString(stream);
-    const auto slave_field = binary::GetCString(stream);
-    const auto master_table = binary::GetCString(stream);
-    const auto master_field = binary::GetCString(stream);
-    ret.emplace_back(core::ReferencesConstraint{
-        .master_table = master_table,
-        .master_field = master_field,
-        .slave_table = slave_table,
-        .slave_field = slave_field,
-        .on_delete = core::ReferencesConstraint::OnAction::NoAction,
-        .on_update = core::ReferencesConstraint::OnAction::NoAction,
-    });
+    ret.emplace_back(LoadReferencesConstraint(stream));
+  }
+
+  return ret;
+}
+
+std::map<std::string, IndexDefinition> LoadIndices(std::istream& stream) {
+  std::map<std::string, IndexDefinition> ret;
+  while (stream.peek(), !(stream.eof() || stream.fail())) {
+    const auto index_name = binary::GetCString(stream);
+    const auto table_name = binary::GetCString(stream);
+    const auto field_name = binary::GetCString(stream);
+    ret.emplace(index_name, IndexDefinition{.table_name = table_name,
+                                            .field_name = field_name});
+  }
+  return ret;
+}
+
+std::map<std::string, storage::Layout> LoadLayouts(std::istream& stream) {
+  std::map<std::string, storage::Layout> ret;
+  while (stream.peek(), !(stream.eof() || stream.fail())) {
+    const auto table_name = binary::GetCString(stream);
+    const auto layout =
+        static_cast<storage::Layout>(binary::GetUint<uint8_t>(stream));
+    ret.emplace(table_name, layout);
   }
+  return ret;
+}
 
+std::map<std::string, core::TableStats> LoadStats(std::istream& stream) {
+  std::map<std::string, core::TableStats> ret;
+  while (stream.peek(), !(stream.eof() || stream.fail())) {
+    const auto table_name = binary::GetCString(stream);
+    core::TableStats table{.row_count = binary::GetUint<uint64_t>(stream),
+                           .columns = {}};
+    const auto columns_count = binary::GetUint<uint32_t>(stream);
+    for (uint32_t i = 0; i < columns_count; ++i) {
+      const auto field_name = binary::GetCString(stream);
+      core::ColumnStats column{
+          .null_count = binary::GetUint<uint64_t>(stream),
+          .distinct_count = binary::GetUint<uint64_t>(stream),
+          .bounds = {}};
+      const auto bounds_count = binary::GetUint<uint32_t>(stream);
+      for (uint32_t j = 0; j < bounds_count; ++j) {
+        column.bounds.push_back(binary::GetFloatingPoint<double>(stream));
+      }
+      table.columns.emplace(field_name, std::move(column));
+    }
+    ret.emplace(table_name, std::move(table));
+  }
   return ret;
 }
 
-storage::TableStorage LoadTable(std::istream& stream, const size_t row_size) {
-  storage::TableStorage storage;
-  auto& internal_storage = storage.storage();
+storage::TableStorage LoadTable(std::istream& stream,
+                                const core::Schema& schema,
+                                storage::Layout layout) {
+  storage::TableStorage storage{schema, layout};
+  std::vector<char> row(storage.row_size());
   while (stream.peek(), !(stream.eof() || stream.fail())) {
     const size_t rowid = binary::GetUint<size_t>(stream);
-    auto ptr = binary::GetBytes(stream, row_size);
-    internal_storage.emplace(rowid,
-                             storage::ByteBuffer{row_size, std::move(ptr)});
+    stream.read(row.data(), static_cast<long>(row.size()));
+    storage.WriteRow(storage.Insert(rowid), row.data());
   }
   return storage;
 }
 
-Database Load(const std::filesystem::path& path) {
-  storage::DBStorage db_storage;
-  std::ifstream schema_stream(path / ".schema", std::ios::binary);
-  auto schemas = LoadSchemas(schema_stream);
-  std::ifstream constraints_stream(path / ".constraints", std::ios::binary);
-  auto constraints = LoadConstraint(constraints_stream);
+// the kinds of changes in a log frame
+enum class ChangeType : uint8_t {
+  PutRow,
+  DeleteRow,
+  CreateTable,
+  DropTable,
+  CreateIndex,
+  DropIndex
+};
+
+ChangeBatch::ChangeBatch(Database& db) : db_{db}, empty_{true} {
+  if (db_.failed()) {
+    throw std::runtime_error(
+        "a change could not be logged, the database must be loaded again");
+  }
+}
+
+void ChangeBatch::PutRow(const std::string& table_name, size_t row_id) {
+  if (db_.wal() == nullptr) {
+    return;
+  }
+  const auto& storage = db_.table_storage_const(table_name);
+  row_.resize(storage.row_size());
+  storage.ReadRow(storage.SlotOf(row_id), row_.data());
+  binary::PutUint(stream_, static_cast<uint8_t>(ChangeType::PutRow));
+  binary::PutCString(stream_, table_name);
+  binary::PutUint<size_t>(stream_, row_id);
+  binary::PutUint<uint32_t>(stream_, static_cast<uint32_t>(row_.size()));
+  binary::PutBytes(stream_, row_.data(), row_.size());
+  empty_ = false;
+}
+
+void ChangeBatch::DeleteRow(const std::string& table_name, size_t row_id) {
+  if (db_.wal() == nullptr) {
+    return;
+  }
+  binary::PutUint(stream_, static_cast<uint8_t>(ChangeType::DeleteRow));
+  binary::PutCString(stream_, table_name);
+  binary::PutUint<size_t>(stream_, row_id);
+  empty_ = false;
+}
+
+void ChangeBatch::CreateTable(const std::string& table_name) {
+  if (db_.wal() == nullptr) {
+    return;
+  }
+  binary::PutUint(stream_, static_cast<uint8_t>(ChangeType::CreateTable));
+  binary::PutUint(
+      stream_,
+      static_cast<uint8_t>(db_.table_storage_const(table_name).layout()));
+  DumpSchema(table_name, db_.schemas().at(table_name), stream_);
+  std::vector<core::Constraint> constraints;
+  std::ranges::copy_if(
+      db_.constraints_const(), std::back_inserter(constraints),
+      [&](const core::Constraint& constraint) {
+        const auto* c = std::get_if<core::ReferencesConstraint>(&constraint);
+        return c != nullptr && c->slave_table == table_name;
+      });
+  binary::PutUint<uint32_t>(stream_,
+                            static_cast<uint32_t>(constraints.size()));
+  for (const auto& constraint : constraints) {
+    DumpConstraint(constraint, stream_);
+  }
+  empty_ = false;
+}
+
+void ChangeBatch::DropTable(const std::string& table_name) {
+  if (db_.wal() == nullptr) {
+    return;
+  }
+  binary::PutUint(stream_, static_cast<uint8_t>(ChangeType::DropTable));
+  binary::PutCString(stream_, table_name);
+  empty_ = false;
+}
+
+void ChangeBatch::CreateIndex(const std::string& index_name) {
+  if (db_.wal() == nullptr) {
+    return;
+  }
+  const auto& index = db_.indices().at(index_name);
+  binary::PutUint(stream_, static_cast<uint8_t>(ChangeType::CreateIndex));
+  binary::PutCString(stream_, index_name);
+  binary::PutCString(stream_, index.table_name);
+  binary::PutCString(stream_, index.field_name);
+  empty_ = false;
+}
+
+void ChangeBatch::DropIndex(const std::string& index_name) {
+  if (db_.wal() == nullptr) {
+    return;
+  }
+  binary::PutUint(stream_, static_cast<uint8_t>(ChangeType::DropIndex));
+  binary::PutCString(stream_, index_name);
+  empty_ = false;
+}
+
+void ChangeBatch::Commit() {
+  if (!empty_) {
+    try {
+      db_.wal()->Append(stream_.view());
+    } catch (...) {
+      db_.set_failed();
+      throw;
+    }
+    stream_.str({});
+    empty_ = true;
+  }
+}
+
+// Applies the changes of one log frame. A crash between writing a snapshot
+// and emptying the log leaves changes the snapshot already holds, so
+// replaying one twice changes nothing.
+void ReplayChanges(Database& db, const std::string& frame) {
+  std::istringstream stream(frame);
+  std::vector<char> row;
+  while (stream.peek(), !(stream.eof() || stream.fail())) {
+    switch (static_cast<ChangeType>(binary::GetUint<uint8_t>(stream))) {
+      case ChangeType::PutRow: {
+        const auto table_name = binary::GetCString(stream);
+        const auto row_id = binary::GetUint<size_t>(stream);
+        row.resize(binary::GetUint<uint32_t>(stream));
+        stream.read(row.data(), static_cast<long>(row.size()));
+        // the table may be one the snapshot no longer has, or a newer one
+        // under the same name; the log drops it again later then
+        if (db.Exists(table_name) &&
+            db.table_storage(table_name).row_size() == row.size()) {
+          db.GetTableScan(table_name)->WriteRow(row_id, row.data());
+        }
+        break;
+      }
+      case ChangeType::DeleteRow: {
+        const auto table_name = binary::GetCString(stream);
+        const auto row_id = binary::GetUint<size_t>(stream);
+        if (!db.Exists(table_name)) {
+          break;
+        }
+        auto table = db.GetTableScan(table_name);
+        if (table->MoveToRowId(row_id)) {
+          table->Delete();
+        }
+        break;
+      }
+      case ChangeType::CreateTable: {
+        const auto layout =
+            static_cast<storage::Layout>(binary::GetUint<uint8_t>(stream));
+        const auto [table_name, schema] = LoadSchema(stream);
+        const auto count = binary::GetUint<uint32_t>(stream);
+        const bool exists = db.Exists(table_name);
+        db.AddTable(table_name, schema, layout);
+        for (uint32_t i = 0; i < count; ++i) {
+          auto constraint = LoadReferencesConstraint(stream);
+          if (!exists) {
+            db.constraints().push_back(std::move(constraint));
+          }
+        }
+        break;
+      }
+      case ChangeType::DropTable:
+        db.RemoveTable(binary::GetCString(stream));
+        break;
+      case ChangeType::CreateIndex: {
+        const auto index_name = binary::GetCString(stream);
+        const auto table_name = binary::GetCString(stream);
+        const auto field_name = binary::GetCString(stream);
+        if (!db.indices().contains(index_name) && db.Exists(table_name)) {
+          db.AddIndex(index_name, IndexDefinition{.table_name = table_name,
+                                                  .field_name = field_name});
+        }
+        break;
+      }
+      case ChangeType::DropIndex:
+        db.RemoveIndex(binary::GetCString(stream));
+        break;
+      default:
+        throw std::runtime_error("the log is corrupted");
+    }
+  }
+}
+
+// segments written before the block format, slot by slot from a stream
+void LoadSegment(std::istream& stream, storage::TableStorage& storage) {
+  std::vector<char> row(storage.row_size());
+  while (stream.peek(), !(stream.eof() || stream.fail())) {
+    if (binary::GetUint<uint8_t>(stream) == 0) {
+      storage.InsertTombstone();
+      continue;
+    }
+    const size_t rowid = binary::GetUint<size_t>(stream);
+    stream.read(row.data(), static_cast<long>(row.size()));
+    storage.WriteRow(storage.Insert(rowid), row.data());
+  }
+}
+
+// Inline rows are written to the table from the block they were read into.
+// Pages are added as the slots reach them, read or mapped.
+void LoadSegment(const std::filesystem::path& file,
+                 const std::filesystem::path& page_file,
+                 storage::TableStorage& storage, bool map) {
+  if (!storage::BlockReader::HasHeader(file)) {
+    std::ifstream stream(file, std::ios::binary);
+    LoadSegment(stream, storage);
+    return;
+  }
+  storage::BlockReader reader(file);
+  std::optional<storage::PageFile> pages;
+  if (reader.version() >= 3 &&
+      reader.GetUint<uint8_t>() ==
+          static_cast<uint8_t>(SegmentRows::Paged)) {
+    pages.emplace(page_file, storage.page_size(), map);
+  }
+  size_t page = 0;
+  while (!reader.AtEnd()) {
+    if (pages.has_value() &&
+        storage.slot_count() % storage.slots_per_page() == 0) {
+      if (page == pages->page_count()) {
+        throw std::runtime_error(page_file.string() + " is truncated");
+      }
+      storage.AppendPage(pages->page(page++));
+    }
+    if (reader.GetUint<uint8_t>() == 0) {
+      storage.InsertTombstone();
+      continue;
+    }
+    const auto row_id = reader.GetUint<uint64_t>();
+    if (pages.has_value()) {
+      storage.Insert(row_id);
+      continue;
+    }
+    storage.WriteRow(storage.Insert(row_id), reader.Read(storage.row_size()));
+  }
+}
+
+Database Load(const std::filesystem::path& path,
+              const LoadOptions& options) {
+  // snapshots made before manifests have catalog files without generations
+  // and a single data file per table
+  const auto manifest = storage::ReadManifest(path);
+  const auto catalog_file = [&](const std::string& name) {
+    return path / (manifest.has_value()
+                       ? storage::CatalogFileName(name, manifest->generation)
+                       : name);
+  };
+
+  auto schemas =
+      LoadSchemas(*storage::OpenSnapshotFile(catalog_file(".schema")));
+  auto constraints =
+      LoadConstraint(*storage::OpenSnapshotFile(catalog_file(".constraints")));
+  // dumps made before column storage have no layouts file
+  const auto layouts =
+      LoadLayouts(*storage::OpenSnapshotFile(catalog_file(".layouts")));
+
+  // the loaders only hold copies, they may run after `Load` returns
+  std::map<std::string, Database::TableLoader> loaders;
+  for (const auto& [table_name, schema] : schemas) {
+    const auto it = layouts.find(table_name);
+    const auto layout =
+        it == layouts.end() ? storage::Layout::Row : it->second;
+    if (!manifest.has_value()) {
+      loaders[table_name] = {
+          .layout = layout,
+          .load = [file = path / (table_name + ".dat"), schema, layout] {
+            std::ifstream stream(file, std::ios::binary);
+            return LoadTable(stream, schema, layout);
+          }};
+      continue;
+    }
+    const auto segments = manifest->tables.find(table_name);
+    loaders[table_name] = {
+        .layout = layout,
+        .load = [path, table_name, schema, layout,
+                 generations = segments == manifest->tables.end()
+                                   ? std::vector<uint64_t>{}
+                                   : segments->second,
+                 map = options.map_files] {
+          storage::TableStorage table{schema, layout};
+          for (size_t segment = 0; segment < generations.size(); ++segment) {
+            const auto generation = generations[segment];
+            LoadSegment(path / storage::SegmentFileName(table_name, segment,
+                                                        generation),
+                        path / storage::PageFileName(table_name, segment,
+                                                     generation),
+                        table, map);
+          }
+          table.MarkClean();
+          return table;
+        }};
+  }
+  Database db{schemas, constraints, loaders};
+
+  // ordered indices are not stored, only their definitions; they are rebuilt
+  // from the rows as the tables are loaded
+  const auto indices =
+      LoadIndices(*storage::OpenSnapshotFile(catalog_file(".indices")));
+  for (const auto& [index_name, index] : indices) {
+    db.AddIndex(index_name, index);
+  }
+  // dumps made before ANALYZE existed have no statistics file
+  auto stats = LoadStats(*storage::OpenSnapshotFile(catalog_file(".stats")));
+  for (auto& [table_name, table_stats] : stats) {
+    db.SetStats(table_name, std::move(table_stats));
+  }
+  if (!options.lazy) {
+    db.LoadTables();
+  }
+  if (manifest.has_value()) {
+    db.set_manifest(path, manifest.value());
+  }
 
-  for (const auto& [table_name, _] : schemas) {
-    std::ifstream table_stream(path / (table_name + ".dat"), std::ios::binary);
-    const auto row_size = schemas.at(table_name).size();
-    auto table = LoadTable(table_stream, row_size);
-    db_storage.Add(table_name, table);
+  const auto wal_path = path / ".wal";
+  for (const auto& frame : storage::WriteAheadLog::Recover(wal_path)) {
+    ReplayChanges(db, frame);
   }
-  Database db{db_storage, schemas, constraints};
+  db.set_wal(std::make_unique<storage::WriteAheadLog>(wal_path));
   return db;
 }
 
@@ -2,49 +2,170 @@
 
 #include <map>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <sstream>
 
 #include <deadfood/storage/db_storage.hh>
 #include <deadfood/core/schema.hh>
 #include <deadfood/core/constraint.hh>
+#include <deadfood/core/table_stats.hh>
 #include <deadfood/scan/table_scan.hh>
+#include <deadfood/storage/manifest.hh>
+#include <deadfood/storage/wal.hh>
 #include <set>
 
 namespace deadfood {
 
+struct IndexDefinition {
+  std::string table_name;
+  std::string field_name;
+};
+
 class Database {
  public:
+  // reads the rows of a table of a snapshot, for tables whose storage is
+  // made when first needed
+  struct TableLoader {
+    storage::Layout layout;
+    std::function<storage::TableStorage()> load;
+  };
+
   Database() = default;
 
-  Database(storage::DBStorage& storage,
-           std::map<std::string, core::Schema>& schemas,
-           std::vector<core::Constraint>& constraints);
+  // The storage of every table is made by its loader, when the table is
+  // first used or by `LoadTables`. A loaded table gets the hash indices of
+  // its unique columns and the ordered indices defined on it by then.
+  Database(std::map<std::string, core::Schema>& schemas,
+           std::vector<core::Constraint>& constraints,
+           std::map<std::string, TableLoader>& loaders);
 
   std::vector<core::Constraint>& constraints();
   const std::vector<core::Constraint>& constraints_const() const;
 
+  // these load the table if it was not yet; loading is not thread-safe
   storage::TableStorage& table_storage(const std::string& table_name);
   const storage::TableStorage& table_storage_const(
       const std::string& table_name) const;
+  [[nodiscard]] storage::Layout layout(const std::string& table_name) const;
+  // whether the storage of the table has been made; a table that did not
+  // come with a loader always is
+  [[nodiscard]] bool IsLoaded(const std::string& table_name) const;
+  // runs the loaders of all tables not loaded yet, in parallel on the shared
+  // thread pool
+  void LoadTables();
   const std::set<std::string>& table_names() const;
   const std::map<std::string, core::Schema>& schemas() const;
   [[nodiscard]] bool Exists(const std::string& table_name) const;
 
-  void AddTable(const std::string& table_name, const core::Schema& schema);
+  void AddTable(const std::string& table_name, const core::Schema& schema,
+                storage::Layout layout = storage::Layout::Row);
   void RemoveTable(const std::string& table_name);
 
-  std::unique_ptr<scan::IScan> GetTableScan(const std::string& table_name);
-  std::unique_ptr<scan::IScan> GetTableScan(
+  // ordered indices created with CREATE INDEX, keyed by index name
+  const std::map<std::string, IndexDefinition>& indices() const;
+  void AddIndex(const std::string& index_name, const IndexDefinition& index);
+  void RemoveIndex(const std::string& index_name);
+
+  // statistics collected by ANALYZE, keyed by table name; they are not kept
+  // up to date by later writes
+  const std::map<std::string, core::TableStats>& stats() const;
+  void SetStats(const std::string& table_name, core::TableStats stats);
+
+  std::unique_ptr<scan::TableScan> GetTableScan(const std::string& table_name);
+  std::unique_ptr<scan::TableScan> GetTableScan(
       const std::string& table_name, const std::string& rename_table);
 
+  // the log statements record their changes in, null for a database that
+  // lives in memory only
+  [[nodiscard]] storage::WriteAheadLog* wal() const;
+  void set_wal(std::unique_ptr<storage::WriteAheadLog> wal);
+  // Set once a statement changed the database but its changes could not be
+  // logged. The memory then holds changes the log does not, so the database
+  // refuses later statements that write and checkpoints; loading it again
+  // recovers what the log holds.
+  [[nodiscard]] bool failed() const;
+  void set_failed();
+
+  // the manifest of the snapshot in `path`, if it is the one the database
+  // was last loaded from or dumped to: the segments of the tables that are
+  // not dirty are as that snapshot has them
+  [[nodiscard]] const storage::Manifest* manifest(
+      const std::filesystem::path& path) const;
+  void set_manifest(const std::filesystem::path& path,
+                    storage::Manifest manifest);
+
  private:
-  storage::DBStorage storage_;
+  storage::TableStorage& LoadedStorage(const std::string& table_name) const;
+  [[nodiscard]] storage::TableStorage ReadTable(
+      const std::string& table_name, const TableLoader& loader) const;
+
+  // tables are loaded by const accessors too
+  mutable storage::DBStorage storage_;
+  mutable std::map<std::string, TableLoader> loaders_;
   std::set<std::string> table_names_;
   std::map<std::string, core::Schema> schemas_;
   std::vector<core::Constraint> constraints_;
+  std::map<std::string, IndexDefinition> indices_;
+  std::map<std::string, core::TableStats> stats_;
+  std::unique_ptr<storage::WriteAheadLog> wal_;
+  bool failed_ = false;
+  std::filesystem::path snapshot_path_;
+  std::optional<storage::Manifest> manifest_;
 };
 
-void Dump(const Database& db, const std::filesystem::path& path);
+// The logical changes made by one statement, recorded as it makes them and
+// appended to the log of the database as one frame by `Commit`, so that a
+// statement is replayed whole or not at all. Rows are logged as their row
+// images once changed. Without a log nothing is recorded. Statements make a
+// batch before they change anything, and making one fails once the database
+// failed to log a change.
+class ChangeBatch {
+ public:
+  explicit ChangeBatch(Database& db);
+
+  // the row with the id was inserted or updated
+  void PutRow(const std::string& table_name, size_t row_id);
+  void DeleteRow(const std::string& table_name, size_t row_id);
+  // the table was created along with its foreign keys
+  void CreateTable(const std::string& table_name);
+  void DropTable(const std::string& table_name);
+  void CreateIndex(const std::string& index_name);
+  void DropIndex(const std::string& index_name);
+
+  // returns once the changes are durable; if they cannot be logged the
+  // database is marked failed
+  void Commit();
+
+ private:
+  Database& db_;
+  std::ostringstream stream_;
+  std::vector<char> row_;
+  bool empty_;
+};
+
+// Writes a snapshot of the database to `path`. It is a checkpoint: once the
+// snapshot is on disk the log in `path` is emptied. If the database was
+// loaded from or last dumped to `path`, only the segments that changed since
+// are written.
+void Dump(Database& db, const std::filesystem::path& path);
+
+struct LoadOptions {
+  // map the page files of row-layout tables instead of reading them: their
+  // rows are paged in from the page cache as they are touched, and a page is
+  // copied only once it is written to. Building the unique and ordered
+  // indices still reads the columns they are on.
+  bool map_files = false;
+  // register the tables without reading them: a table is read when a
+  // statement first uses it, instead of all of them in parallel at once
+  bool lazy = false;
+};
 
-Database Load(const std::filesystem::path& path);
+// Reads the snapshot in `path` and replays the log there on top of it. The
+// tables are read in parallel, or one by one as they are first used. The
+// database keeps appending to that log.
+Database Load(const std::filesystem::path& path,
+              const LoadOptions& options = {});
 
 }  // namespace deadfood
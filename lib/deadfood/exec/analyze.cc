@@ -0,0 +1,28 @@
+#include "analyze.hh"
+
+#include <stdexcept>
+
+namespace deadfood::exec {
+
+void AnalyzeTable(Database& db, const std::string& table_name) {
+  db.SetStats(table_name,
+              core::CollectTableStats(db.table_storage(table_name),
+                                      db.schemas().at(table_name)));
+}
+
+void ExecuteAnalyzeQuery(Database& db,
+                         const std::optional<std::string>& table_name) {
+  if (!table_name.has_value()) {
+    for (const auto& name : db.table_names()) {
+      AnalyzeTable(db, name);
+    }
+    return;
+  }
+  if (!db.Exists(table_name.value())) {
+    throw std::runtime_error("table `" + table_name.value() +
+                             "` does not exist");
+  }
+  AnalyzeTable(db, table_name.value());
+}
+
+}  // namespace deadfood::exec
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include <deadfood/database.hh>
+
+namespace deadfood::exec {
+
+// collects the statistics of `table_name`, or of every table
+void ExecuteAnalyzeQuery(Database& db,
+                         const std::optional<std::string>& table_name);
+
+}  // namespace deadfood::exec
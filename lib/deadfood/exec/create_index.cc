@@ -0,0 +1,35 @@
+#include "create_index.hh"
+
+#include <stdexcept>
+
+namespace deadfood::exec {
+
+void ExecuteCreateIndexQuery(Database& db,
+                             const query::CreateIndexQuery& query) {
+  if (db.indices().contains(query.index_name)) {
+    throw std::runtime_error("index `" + query.index_name +
+                             "` already exists");
+  }
+  if (!db.Exists(query.table_name)) {
+    throw std::runtime_error("table does not exist");
+  }
+  if (!db.schemas().at(query.table_name).Exists(query.field_name)) {
+    throw std::runtime_error("field `" + query.field_name +
+                             "` does not exist");
+  }
+  for (const auto& [_, index] : db.indices()) {
+    if (index.table_name == query.table_name &&
+        index.field_name == query.field_name) {
+      throw std::runtime_error("field `" + query.field_name +
+                               "` is already indexed");
+    }
+  }
+  ChangeBatch changes{db};
+  db.AddIndex(query.index_name,
+              IndexDefinition{.table_name = query.table_name,
+                              .field_name = query.field_name});
+  changes.CreateIndex(query.index_name);
+  changes.Commit();
+}
+
+}  // namespace deadfood::exec
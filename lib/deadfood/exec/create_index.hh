@@ -0,0 +1,11 @@
+#pragma once
+
+#include <deadfood/database.hh>
+#include <deadfood/query/create_index_query.hh>
+
+namespace deadfood::exec {
+
+void ExecuteCreateIndexQuery(Database& db,
+                             const query::CreateIndexQuery& query);
+
+}  // namespace deadfood::exec
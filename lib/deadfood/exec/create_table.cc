@@ -18,10 +18,13 @@ void ExecuteCreateTableQuery(
     schema.AddField(field_name, field, q.MayBeNull(field_name),
                     q.IsUnique(field_name));
   }
-  db.AddTable(q.table_name(), schema);
+  ChangeBatch changes{db};
+  db.AddTable(q.table_name(), schema, q.layout());
   for (const auto& c : constraints) {
     db.constraints().emplace_back(c);
   }
+  changes.CreateTable(q.table_name());
+  changes.Commit();
 }
 
 }  // namespace deadfood::exec
\ No newline at end of file
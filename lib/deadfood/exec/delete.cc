@@ -1,35 +1,91 @@
 #include "delete.hh"
 
+#include <functional>
+
 #include <deadfood/expr/expr_convert.hh>
 #include <deadfood/expr/scan_selector/simple_scan_selector.hh>
 #include <deadfood/scan/select_scan.hh>
 #include <deadfood/expr/bool_expr.hh>
 
 #include <deadfood/exec/dml_util.hh>
+#include <deadfood/exec/dql_util.hh>
 
 namespace deadfood::exec {
 
+// Checks in one go that no row references the values the deleted rows hold
+// in the master columns of foreign keys forbidding deletes.
+void CheckForeignKeys(Database& db, const std::string& table_name,
+                      const std::vector<size_t>& row_ids) {
+  for (const auto& constraint : db.constraints()) {
+    const auto* c = std::get_if<core::ReferencesConstraint>(&constraint);
+    if (c == nullptr || c->master_table != table_name ||
+        c->on_delete != core::ReferencesConstraint::OnAction::NoAction) {
+      continue;
+    }
+    auto scan = db.GetTableScan(table_name);
+    util::ValueSet values;
+    for (const auto row_id : row_ids) {
+      if (scan->MoveToRowId(row_id)) {
+        values.insert(scan->GetField(c->master_field));
+      }
+    }
+    if (!util::FindMatchingValues(db, c->slave_table, c->slave_field, values)
+             .empty()) {
+      throw std::runtime_error("foreign key constraint violated");
+    }
+  }
+}
+
+// Collects the ids of the matching rows in one pass, checks the foreign keys
+// for all of them, then tombstones them. The table is compacted once enough
+// of it is dead.
 void ExecuteDeleteQuery(Database& db, const query::DeleteQuery& query) {
   if (!db.Exists(query.table_name)) {
     throw std::runtime_error("table does not exist");
   }
-  auto scan = db.GetTableScan(query.table_name);
-  if (query.predicate.has_value()) {
+  std::vector<size_t> row_ids;
+  auto table = db.GetTableScan(query.table_name);
+  if (!query.predicate.has_value()) {
+    table->BeforeFirst();
+    while (table->Next()) {
+      row_ids.push_back(table->row_id());
+    }
+  } else {
+    std::unique_ptr<scan::IScan> scan;
+    std::function<size_t()> row_id;
+    if (auto index_scan = util::GetIndexScan(db, query.table_name,
+                                             query.table_name,
+                                             query.predicate.value())) {
+      row_id = [rows = index_scan.get()] { return rows->row_id(); };
+      scan = std::move(index_scan);
+    } else {
+      auto table_scan = db.GetTableScan(query.table_name);
+      row_id = [rows = table_scan.get()] { return rows->row_id(); };
+      scan = std::move(table_scan);
+    }
     expr::ExprTreeConverter conv{
         std::make_unique<expr::SimpleScanSelector>(scan.get())};
     scan = std::make_unique<scan::SelectScan>(
         std::move(scan),
         expr::BoolExpr(conv.ConvertExprTreeToIExpr(query.predicate.value())));
+    while (scan->Next()) {
+      row_ids.push_back(row_id());
+    }
   }
 
-  while (scan->Next()) {
-    util::CheckForeignKeyConstraintForRow(db, scan.get(), query.table_name,
-                                          util::Action::Delete);
+  CheckForeignKeys(db, query.table_name, row_ids);
+  ChangeBatch changes{db};
+  for (const auto row_id : row_ids) {
+    if (table->MoveToRowId(row_id)) {
+      table->Delete();
+      changes.DeleteRow(query.table_name, row_id);
+    }
   }
-  scan->BeforeFirst();
-  while (scan->Next()) {
-    scan->Delete();
+  changes.Commit();
+  auto& storage = db.table_storage(query.table_name);
+  if (storage.NeedsCompaction()) {
+    storage.Compact();
   }
 }
 
-}  // namespace deadfood::exec
\ No newline at end of file
+}  // namespace deadfood::exec
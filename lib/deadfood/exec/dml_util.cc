@@ -70,84 +70,30 @@ core::FieldVariant NormalizeFieldVariant(
       value);
 }
 
-void CheckUniquenessConstraint(Database& db, const std::string& table_name,
-                               const std::string& field_name,
-                               const core::FieldVariant& value) {
-  if (CountRowsWithMatchingField(db, table_name, field_name, value, 1) > 0) {
-    throw std::runtime_error("unique constraint violated");
+ValueSet FindMatchingValues(Database& db, const std::string& table_name,
+                            const std::string& field_name,
+                            const ValueSet& values) {
+  ValueSet ret;
+  if (values.empty()) {
+    return ret;
   }
-}
-
-bool MatchesAction(const core::ReferencesConstraint& constraint,
-                   const Action& action) {
-  switch (action) {
-    case Action::Update:
-      return constraint.on_update ==
-             core::ReferencesConstraint::OnAction::NoAction;
-    case Action::Delete:
-      return constraint.on_delete ==
-             core::ReferencesConstraint::OnAction::NoAction;
-  }
-}
-
-void CheckForeignKeyConstraint(Database& db, const std::string& table_name,
-                               const std::string& field_name,
-                               const core::FieldVariant& value,
-                               const Action& action) {
-  for (const auto& constraint : db.constraints()) {
-    if (auto c = std::get_if<core::ReferencesConstraint>(&constraint)) {
-      if (c->master_table != table_name || c->master_field != field_name) {
-        continue;
-      }
-
-      if (!MatchesAction(*c, action)) {
-        continue;
-      }
-      if (CountRowsWithMatchingField(db, c->slave_table, c->slave_field, value,
-                                     1) > 0) {
-        throw std::runtime_error("foreign key constraint violated");
+  if (const auto* index = db.table_storage(table_name).hash_index(field_name)) {
+    for (const auto& value : values) {
+      if (index->Count(value, 1) > 0) {
+        ret.insert(value);
       }
     }
+    return ret;
   }
-}
-
-void CheckForeignKeyConstraintForRow(Database& db, scan::IScan* scan,
-                                     const std::string& table_name,
-                                     const Action& action) {
-  const auto schema = db.schemas().at(table_name);
-  for (const auto& constraint : db.constraints()) {
-    if (auto c = std::get_if<core::ReferencesConstraint>(&constraint)) {
-      if (c->master_table != table_name || !schema.Exists(c->master_field)) {
-        continue;
-      }
-      if (!MatchesAction(*c, action)) {
-        continue;
-      }
-      if (CountRowsWithMatchingField(db, c->slave_table, c->slave_field,
-                                     scan->GetField(c->master_field), 1) > 0) {
-        throw std::runtime_error("foreign key constraint violated");
-      }
-    }
-  }
-}
-
-void CheckForeignKeyConstraintInInsertQuery(Database& db,
-                                            const std::string& table_name,
-                                            const std::string& field_name,
-                                            const core::FieldVariant& value) {
-  const auto& schema = db.schemas().at(table_name);
-  for (const auto& constraint : db.constraints()) {
-    if (auto c = std::get_if<core::ReferencesConstraint>(&constraint)) {
-      if (c->slave_table != table_name || c->slave_field != field_name ||
-          !schema.Exists(c->slave_field)) {
-        continue;
-      }
-      if (CountRowsWithMatchingField(db, c->master_table, c->master_field,
-                                     value, 1) == 0) {
-        throw std::runtime_error("foreign key constraint violated");
-      }
+  auto scan = db.GetTableScan(table_name);
+  scan->BeforeFirst();
+  while (scan->Next() && ret.size() < values.size()) {
+    auto value = scan->GetField(field_name);
+    if (values.contains(value)) {
+      ret.insert(std::move(value));
     }
   }
+  return ret;
 }
 
 }  // namespace deadfood::exec::util
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <unordered_set>
+
 #include <deadfood/core/field.hh>
+#include <deadfood/core/field_key.hh>
 #include <deadfood/database.hh>
 
 namespace deadfood::exec::util {
@@ -11,24 +14,13 @@ void ValidateType(bool may_be_null, const core::Field& field_info,
 core::FieldVariant NormalizeFieldVariant(
     const core::Field::FieldType& field_type, const core::FieldVariant& value);
 
-void CheckUniquenessConstraint(Database& db, const std::string& table_name,
-                               const std::string& field_name,
-                               const core::FieldVariant& value);
-
-enum class Action { Update, Delete };
-
-void CheckForeignKeyConstraint(Database& db, const std::string& table_name,
-                               const std::string& field_name,
-                               const core::FieldVariant& value,
-                               const Action& action);
-
-void CheckForeignKeyConstraintForRow(Database& db, scan::IScan* scan,
-                                     const std::string& table_name,
-                                     const Action& action);
+using ValueSet = std::unordered_set<core::FieldVariant, core::FieldKeyHash,
+                                    core::FieldKeyEqual>;
 
-void CheckForeignKeyConstraintInInsertQuery(Database& db,
-                                            const std::string& table_name,
-                                            const std::string& field_name,
-                                            const core::FieldVariant& value);
+// Returns those of `values` that `field_name` holds in some row of the table,
+// probing its hash index for each of them or scanning the table once.
+ValueSet FindMatchingValues(Database& db, const std::string& table_name,
+                            const std::string& field_name,
+                            const ValueSet& values);
 
 }  // namespace deadfood::exec::util
\ No newline at end of file
@@ -1,11 +1,19 @@
 #include "dql_util.hh"
 
+#include <limits>
+
 #include <deadfood/expr/iexpr.hh>
 #include <deadfood/expr/cmp_expr.hh>
 #include <deadfood/expr/const_expr.hh>
 #include <deadfood/expr/field_expr.hh>
 
 #include <deadfood/scan/select_scan.hh>
+#include <deadfood/scan/index_scan.hh>
+
+#include <deadfood/core/field_key.hh>
+#include <deadfood/util/is_number_t.hh>
+
+#include <deadfood/util/parse.hh>
 
 namespace deadfood::exec::util {
 
@@ -13,7 +21,11 @@ size_t CountRowsWithMatchingField(Database& db, const std::string& table_name,
                                   const std::string& field_name,
                                   const core::FieldVariant& value,
                                   const size_t limit) {
-  auto scan = db.GetTableScan(table_name);
+  if (const auto* index = db.table_storage(table_name).hash_index(field_name)) {
+    return index->Count(value, limit);
+  }
+
+  std::unique_ptr<scan::IScan> scan = db.GetTableScan(table_name);
 
   std::unique_ptr<expr::IExpr> predicate = std::make_unique<expr::CmpExpr>(
       expr::CmpOp::Eq, std::make_unique<expr::ConstExpr>(value),
@@ -34,4 +46,393 @@ size_t CountRowsWithMatchingField(Database& db, const std::string& table_name,
   return counter;
 }
 
+// `field_name op value`, with the column always on the left-hand side
+struct ColumnComparison {
+  std::string field_name;
+  expr::GenBinOp op;
+  core::FieldVariant value;
+};
+
+std::optional<core::FieldVariant> GetConstant(const expr::FactorTree& tree) {
+  const auto* constant = std::get_if<expr::Constant>(&tree.factor);
+  if (tree.not_applied || constant == nullptr) {
+    return std::nullopt;
+  }
+  return std::visit(
+      [&](auto&& arg) -> std::optional<core::FieldVariant> {
+        using T = std::decay_t<decltype(arg)>;
+        if (!tree.neg_applied) {
+          return arg;
+        }
+        if constexpr (std::is_same_v<T, int> || std::is_same_v<T, double>) {
+          return -arg;
+        }
+        return std::nullopt;
+      },
+      *constant);
+}
+
+std::optional<std::string> GetColumn(const expr::FactorTree& tree,
+                                     const std::string& alias,
+                                     const core::Schema& schema) {
+  const auto* id = std::get_if<expr::ExprId>(&tree.factor);
+  if (tree.not_applied || tree.neg_applied || id == nullptr) {
+    return std::nullopt;
+  }
+  const auto [tbl, field] = deadfood::parse::util::GetFullFieldName(id->id);
+  if ((tbl.has_value() && tbl.value() != alias) || !schema.Exists(field)) {
+    return std::nullopt;
+  }
+  return field;
+}
+
+expr::GenBinOp MirrorComparison(expr::GenBinOp op) {
+  switch (op) {
+    case expr::GenBinOp::LT:
+      return expr::GenBinOp::GT;
+    case expr::GenBinOp::LE:
+      return expr::GenBinOp::GE;
+    case expr::GenBinOp::GT:
+      return expr::GenBinOp::LT;
+    case expr::GenBinOp::GE:
+      return expr::GenBinOp::LE;
+    default:
+      return op;
+  }
+}
+
+bool IsIndexableComparison(expr::GenBinOp op) {
+  return op == expr::GenBinOp::Eq || op == expr::GenBinOp::LT ||
+         op == expr::GenBinOp::LE || op == expr::GenBinOp::GT ||
+         op == expr::GenBinOp::GE;
+}
+
+// `tree` as a comparison of a column of `alias` with a constant
+std::optional<ColumnComparison> GetColumnComparison(
+    const expr::ExprTree& tree, const std::string& alias,
+    const core::Schema& schema) {
+  if (!IsIndexableComparison(tree.op) || tree.factors.size() != 2) {
+    return std::nullopt;
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    const auto column = GetColumn(tree.factors[i], alias, schema);
+    const auto constant = GetConstant(tree.factors[1 - i]);
+    if (column.has_value() && constant.has_value()) {
+      return ColumnComparison{
+          .field_name = column.value(),
+          .op = i == 0 ? tree.op : MirrorComparison(tree.op),
+          .value = *constant};
+    }
+  }
+  return std::nullopt;
+}
+
+void CollectColumnComparisons(const expr::FactorTree& tree,
+                              const std::string& alias,
+                              const core::Schema& schema,
+                              std::vector<ColumnComparison>& comparisons) {
+  const auto* expr_tree = std::get_if<expr::ExprTree>(&tree.factor);
+  if (tree.not_applied || tree.neg_applied || expr_tree == nullptr) {
+    return;
+  }
+  if (expr_tree->op == expr::GenBinOp::And) {
+    for (const auto& factor : expr_tree->factors) {
+      CollectColumnComparisons(factor, alias, schema, comparisons);
+    }
+    return;
+  }
+  if (auto comparison = GetColumnComparison(*expr_tree, alias, schema)) {
+    comparisons.push_back(std::move(comparison.value()));
+  }
+}
+
+// textbook guesses for predicates nothing is known about
+constexpr double kEqualSelectivity = 0.1;
+constexpr double kRangeSelectivity = 1.0 / 3;
+constexpr double kOtherSelectivity = 0.5;
+// an index lookup expected to fetch more than this share of a table is
+// slower than scanning it, every fetched row being a random access
+constexpr double kMaxIndexSelectivity = 0.2;
+
+bool IsNumber(const core::FieldVariant& value) {
+  return std::visit(
+      [](auto&& arg) {
+        return deadfood::util::IsNumberT<std::decay_t<decltype(arg)>>::value;
+      },
+      value);
+}
+
+// share of the rows of a table whose value in a column is not NULL
+double NonNullFraction(const core::TableStats& table,
+                       const core::ColumnStats& column) {
+  if (table.row_count == 0) {
+    return 0;
+  }
+  return 1 - static_cast<double>(column.null_count) /
+                 static_cast<double>(table.row_count);
+}
+
+const core::ColumnStats* FindColumnStats(const core::TableStats* table,
+                                         const std::string& field_name) {
+  if (table == nullptr) {
+    return nullptr;
+  }
+  const auto it = table->columns.find(field_name);
+  return it == table->columns.end() ? nullptr : &it->second;
+}
+
+double ComparisonSelectivity(const core::TableStats* table,
+                             const ColumnComparison& comparison) {
+  const auto* column = FindColumnStats(table, comparison.field_name);
+  if (comparison.op == expr::GenBinOp::Eq) {
+    if (column == nullptr) {
+      return kEqualSelectivity;
+    }
+    if (std::holds_alternative<core::null_t>(comparison.value)) {
+      return 1 - NonNullFraction(*table, *column);
+    }
+    return NonNullFraction(*table, *column) /
+           static_cast<double>(std::max<size_t>(column->distinct_count, 1));
+  }
+  if (column == nullptr || column->bounds.empty() ||
+      !IsNumber(comparison.value)) {
+    return kRangeSelectivity;
+  }
+  const double value = core::ToDouble(comparison.value);
+  double fraction = 0;
+  switch (comparison.op) {
+    case expr::GenBinOp::LT:
+      fraction = column->FractionBelow(value, false);
+      break;
+    case expr::GenBinOp::LE:
+      fraction = column->FractionBelow(value, true);
+      break;
+    case expr::GenBinOp::GT:
+      fraction = 1 - column->FractionBelow(value, true);
+      break;
+    default:
+      fraction = 1 - column->FractionBelow(value, false);
+      break;
+  }
+  return NonNullFraction(*table, *column) * fraction;
+}
+
+// Range lookups are only done for numeric constants: string ordering in
+// `CmpExpr` is not lexicographic, and comparing a number with NULL never
+// holds, so an open side is closed with an infinity to skip NULL keys.
+struct NumericRange {
+  std::optional<storage::BTreeIndex::Bound> lower;
+  std::optional<storage::BTreeIndex::Bound> upper;
+};
+
+void NarrowRange(NumericRange& range, const ColumnComparison& comparison) {
+  const core::FieldKeyLess less;
+  const storage::BTreeIndex::Bound bound{
+      .key = comparison.value,
+      .inclusive = comparison.op == expr::GenBinOp::LE ||
+                   comparison.op == expr::GenBinOp::GE};
+  if (comparison.op == expr::GenBinOp::GT ||
+      comparison.op == expr::GenBinOp::GE) {
+    if (!range.lower.has_value() || less(range.lower->key, bound.key) ||
+        (!less(bound.key, range.lower->key) && !bound.inclusive)) {
+      range.lower = bound;
+    }
+  } else {
+    if (!range.upper.has_value() || less(bound.key, range.upper->key) ||
+        (!less(range.upper->key, bound.key) && !bound.inclusive)) {
+      range.upper = bound;
+    }
+  }
+}
+
+std::vector<size_t> LookupRange(const storage::BTreeIndex& index,
+                                NumericRange range) {
+  constexpr double kInf = std::numeric_limits<double>::infinity();
+  if (!range.lower.has_value()) {
+    range.lower = storage::BTreeIndex::Bound{.key = -kInf, .inclusive = true};
+  }
+  if (!range.upper.has_value()) {
+    range.upper = storage::BTreeIndex::Bound{.key = kInf, .inclusive = true};
+  }
+  return index.Range(range.lower, range.upper);
+}
+
+// share of the non-NULL values of a column inside `range`
+double RangeFraction(const core::ColumnStats& column,
+                     const NumericRange& range) {
+  double fraction = 1;
+  if (range.upper.has_value()) {
+    fraction = column.FractionBelow(core::ToDouble(range.upper->key),
+                                    range.upper->inclusive);
+  }
+  if (range.lower.has_value()) {
+    fraction -= column.FractionBelow(core::ToDouble(range.lower->key),
+                                     !range.lower->inclusive);
+  }
+  return std::max(fraction, 0.0);
+}
+
+const core::TableStats* FindTableStats(const Database& db,
+                                       const std::string& table_name) {
+  const auto it = db.stats().find(table_name);
+  return it == db.stats().end() ? nullptr : &it->second;
+}
+
+// An index leaves out the rows that a table scan would fail on: comparing a
+// number with NULL throws, so a column holding NULL is not looked up.
+bool IndexedColumnHoldsNull(const storage::TableStorage& storage,
+                            const std::string& field_name) {
+  if (const auto* index = storage.hash_index(field_name)) {
+    return index->Count(core::null_t{}, 1) > 0;
+  }
+  if (const auto* index = storage.btree_index(field_name)) {
+    return index->Contains(core::null_t{});
+  }
+  return false;
+}
+
+// Likewise, a table scan fails to compare a string with a number, while an
+// index only finds no such key; the constant has to be of the column's kind.
+bool ConstantFitsColumn(const core::Schema& schema,
+                        const ColumnComparison& comparison) {
+  const bool is_varchar = schema.field_info(comparison.field_name).type() ==
+                          core::Field::FieldType::Varchar;
+  if (is_varchar) {
+    return std::holds_alternative<std::string>(comparison.value);
+  }
+  return IsNumber(comparison.value);
+}
+
+std::optional<std::vector<size_t>> LookupRowIds(
+    const storage::TableStorage& storage,
+    const std::vector<ColumnComparison>& comparisons,
+    const core::TableStats* stats) {
+  // without statistics an index is always assumed to pay off
+  const auto pays = [&](double selectivity) {
+    return stats == nullptr || selectivity <= kMaxIndexSelectivity;
+  };
+
+  // a point lookup beats a range, and a hash index beats an ordered one
+  for (const auto& comparison : comparisons) {
+    if (comparison.op != expr::GenBinOp::Eq ||
+        !pays(ComparisonSelectivity(stats, comparison))) {
+      continue;
+    }
+    if (const auto* index = storage.hash_index(comparison.field_name)) {
+      return index->Find(comparison.value);
+    }
+  }
+  for (const auto& comparison : comparisons) {
+    if (comparison.op != expr::GenBinOp::Eq ||
+        !pays(ComparisonSelectivity(stats, comparison))) {
+      continue;
+    }
+    if (const auto* index = storage.btree_index(comparison.field_name)) {
+      return index->Find(comparison.value);
+    }
+  }
+
+  for (const auto& comparison : comparisons) {
+    const auto* index = storage.btree_index(comparison.field_name);
+    if (index == nullptr || comparison.op == expr::GenBinOp::Eq ||
+        !IsNumber(comparison.value)) {
+      continue;
+    }
+    NumericRange range;
+    for (const auto& other : comparisons) {
+      if (other.field_name == comparison.field_name &&
+          other.op != expr::GenBinOp::Eq && IsNumber(other.value)) {
+        NarrowRange(range, other);
+      }
+    }
+    const auto* column = FindColumnStats(stats, comparison.field_name);
+    if (column != nullptr && !column->bounds.empty() &&
+        !pays(NonNullFraction(*stats, *column) *
+              RangeFraction(*column, range))) {
+      continue;
+    }
+    return LookupRange(*index, range);
+  }
+  return std::nullopt;
+}
+
+std::unique_ptr<scan::IndexScan> GetIndexScan(
+    Database& db, const std::string& table_name, const std::string& alias,
+    const expr::FactorTree& predicate) {
+  const auto& schema = db.schemas().at(table_name);
+  std::vector<ColumnComparison> comparisons;
+  CollectColumnComparisons(predicate, alias, schema, comparisons);
+
+  const auto& storage = db.table_storage(table_name);
+  std::erase_if(comparisons, [&](const ColumnComparison& comparison) {
+    return !ConstantFitsColumn(schema, comparison) ||
+           IndexedColumnHoldsNull(storage, comparison.field_name);
+  });
+
+  auto row_ids =
+      LookupRowIds(storage, comparisons, FindTableStats(db, table_name));
+  if (!row_ids.has_value()) {
+    return nullptr;
+  }
+  return std::make_unique<scan::IndexScan>(db.GetTableScan(table_name, alias),
+                                           std::move(row_ids.value()));
+}
+
+double EstimateRows(const Database& db, const std::string& table_name) {
+  if (const auto* stats = FindTableStats(db, table_name)) {
+    return static_cast<double>(stats->row_count);
+  }
+  return static_cast<double>(db.table_storage_const(table_name).size());
+}
+
+double EstimateDistinct(const Database& db, const std::string& table_name,
+                        const std::string& field_name) {
+  if (const auto* column =
+          FindColumnStats(FindTableStats(db, table_name), field_name)) {
+    return static_cast<double>(column->distinct_count);
+  }
+  // as if every value was different, which is what join keys usually are
+  return EstimateRows(db, table_name);
+}
+
+double PredicateSelectivity(const core::TableStats* stats,
+                            const std::string& alias,
+                            const core::Schema& schema,
+                            const expr::FactorTree& tree) {
+  const auto* expr_tree = std::get_if<expr::ExprTree>(&tree.factor);
+  if (tree.neg_applied || expr_tree == nullptr) {
+    return kOtherSelectivity;
+  }
+  double selectivity = kOtherSelectivity;
+  if (expr_tree->op == expr::GenBinOp::And) {
+    selectivity = 1;
+    for (const auto& factor : expr_tree->factors) {
+      selectivity *= PredicateSelectivity(stats, alias, schema, factor);
+    }
+  } else if (expr_tree->op == expr::GenBinOp::Or) {
+    double none = 1;
+    for (const auto& factor : expr_tree->factors) {
+      none *= 1 - PredicateSelectivity(stats, alias, schema, factor);
+    }
+    selectivity = 1 - none;
+  } else if (expr_tree->op == expr::GenBinOp::NotEq) {
+    const expr::ExprTree equal{.op = expr::GenBinOp::Eq,
+                               .factors = expr_tree->factors};
+    if (auto comparison = GetColumnComparison(equal, alias, schema)) {
+      selectivity = 1 - ComparisonSelectivity(stats, comparison.value());
+    }
+  } else if (auto comparison =
+                 GetColumnComparison(*expr_tree, alias, schema)) {
+    selectivity = ComparisonSelectivity(stats, comparison.value());
+  }
+  return tree.not_applied ? 1 - selectivity : selectivity;
+}
+
+double EstimateSelectivity(const Database& db, const std::string& table_name,
+                           const std::string& alias,
+                           const expr::FactorTree& predicate) {
+  return PredicateSelectivity(FindTableStats(db, table_name), alias,
+                              db.schemas().at(table_name), predicate);
+}
+
 }  // namespace deadfood::exec::util
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <deadfood/database.hh>
+#include <deadfood/expr/expr_tree.hh>
+#include <deadfood/scan/index_scan.hh>
 
 namespace deadfood::exec::util {
 
@@ -8,4 +10,27 @@ size_t CountRowsWithMatchingField(Database& db, const std::string& table_name,
                                   const std::string& field_name,
                                   const core::FieldVariant& value,
                                   size_t limit = 0);
-}
\ No newline at end of file
+
+// Looks for conjuncts of `predicate` that compare an indexed column of
+// `table_name` (visible as `alias`) with a constant, by equality or by range.
+// Returns a scan over the candidate rows only, or nullptr if no index applies
+// or, for an analyzed table, if the lookup is expected to return too large a
+// share of the rows to beat a full scan. The rows must still be filtered with
+// the whole predicate.
+std::unique_ptr<scan::IndexScan> GetIndexScan(
+    Database& db, const std::string& table_name, const std::string& alias,
+    const expr::FactorTree& predicate);
+
+// Planning estimates. They come from the statistics ANALYZE stored for
+// `table_name`; tables that were never analyzed get their live row count and
+// fixed guesses.
+double EstimateRows(const Database& db, const std::string& table_name);
+double EstimateDistinct(const Database& db, const std::string& table_name,
+                        const std::string& field_name);
+// fraction of the rows of `table_name`, visible as `alias`, for which
+// `predicate` holds
+double EstimateSelectivity(const Database& db, const std::string& table_name,
+                           const std::string& alias,
+                           const expr::FactorTree& predicate);
+
+}  // namespace deadfood::exec::util
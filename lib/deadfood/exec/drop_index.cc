@@ -0,0 +1,17 @@
+#include "drop_index.hh"
+
+#include <stdexcept>
+
+namespace deadfood::exec {
+
+void ExecuteDropIndexQuery(Database& db, const std::string& index_name) {
+  if (!db.indices().contains(index_name)) {
+    throw std::runtime_error("index does not exist");
+  }
+  ChangeBatch changes{db};
+  db.RemoveIndex(index_name);
+  changes.DropIndex(index_name);
+  changes.Commit();
+}
+
+}  // namespace deadfood::exec
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <deadfood/database.hh>
+#include <string>
+
+namespace deadfood::exec {
+
+void ExecuteDropIndexQuery(Database& db, const std::string& index_name);
+
+}  // namespace deadfood::exec
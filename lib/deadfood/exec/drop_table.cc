@@ -57,7 +57,10 @@ void ExecuteDropTableQuery(Database& db, const std::string& table_name) {
       }
     }
   }
+  ChangeBatch changes{db};
   db.RemoveTable(table_name);
+  changes.DropTable(table_name);
+  changes.Commit();
 }
 
 }  // namespace deadfood::exec
\ No newline at end of file
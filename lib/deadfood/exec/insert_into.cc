@@ -37,29 +37,108 @@ void CheckRowsSize(const query::InsertQuery& query, size_t size) {
   }
 }
 
+// the value of a literal, possibly negated; nullopt for anything that needs
+// evaluating
+std::optional<core::FieldVariant> GetLiteral(const expr::FactorTree& tree) {
+  const auto* constant = std::get_if<expr::Constant>(&tree.factor);
+  if (constant == nullptr || tree.not_applied) {
+    return std::nullopt;
+  }
+  return std::visit(
+      [&](auto&& arg) -> std::optional<core::FieldVariant> {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, int> || std::is_same_v<T, double>) {
+          return tree.neg_applied ? 0 - arg : arg;
+        } else if (tree.neg_applied) {
+          return std::nullopt;
+        } else {
+          return arg;
+        }
+      },
+      *constant);
+}
+
 std::vector<std::vector<core::FieldVariant>> RetrieveValues(
     const core::Schema& schema, const std::vector<std::string>& fields,
     const query::InsertQuery& query) {
   expr::ExprTreeConverter converter{std::make_unique<expr::NoScanSelector>()};
   std::vector<std::vector<core::FieldVariant>> actual_values;
+  actual_values.reserve(query.values.size());
 
   for (const auto& row : query.values) {
     std::vector<core::FieldVariant> actual_values_row;
+    actual_values_row.reserve(row.size());
     for (size_t i = 0; i < row.size(); ++i) {
-      auto e = converter.ConvertExprTreeToIExpr(row[i]);
-      auto val = e->Eval();
+      // plain literals, the bulk of any VALUES list, are not converted
+      auto val = GetLiteral(row[i]);
+      if (!val.has_value()) {
+        val = converter.ConvertExprTreeToIExpr(row[i])->Eval();
+      }
       util::ValidateType(schema.MayBeNull(fields[i]),
-                         schema.field_info(fields[i]), val);
+                         schema.field_info(fields[i]), val.value());
 
       const auto field_type = schema.field_info(fields[i]).type();
       actual_values_row.emplace_back(
-          util::NormalizeFieldVariant(field_type, val));
+          util::NormalizeFieldVariant(field_type, val.value()));
     }
     actual_values.emplace_back(std::move(actual_values_row));
   }
   return actual_values;
 }
 
+// Checks the unique columns of all rows at once: the values of a column go
+// into one hash set, which catches repeats within the rows, and are then
+// looked up in the table together.
+void CheckUniqueness(
+    Database& db, const std::string& table_name,
+    const std::vector<std::string>& fields,
+    const std::vector<std::vector<core::FieldVariant>>& rows) {
+  const auto& schema = db.schemas().at(table_name);
+  for (size_t i = 0; i < fields.size(); ++i) {
+    if (!schema.IsUnique(fields[i])) {
+      continue;
+    }
+    util::ValueSet values;
+    values.reserve(rows.size());
+    for (const auto& row : rows) {
+      if (!values.insert(row[i]).second) {
+        throw std::runtime_error("unique key constraint violated");
+      }
+    }
+    if (!util::FindMatchingValues(db, table_name, fields[i], values)
+             .empty()) {
+      throw std::runtime_error("unique constraint violated");
+    }
+  }
+}
+
+// Checks the foreign keys of all rows at once, as a semi-join of their
+// distinct values with the master table.
+void CheckForeignKeys(
+    Database& db, const std::string& table_name,
+    const std::vector<std::string>& fields,
+    const std::vector<std::vector<core::FieldVariant>>& rows) {
+  for (const auto& constraint : db.constraints()) {
+    const auto* c = std::get_if<core::ReferencesConstraint>(&constraint);
+    if (c == nullptr || c->slave_table != table_name) {
+      continue;
+    }
+    const auto it = std::ranges::find(fields, c->slave_field);
+    if (it == fields.end()) {
+      continue;
+    }
+    const auto i = static_cast<size_t>(it - fields.begin());
+    util::ValueSet values;
+    for (const auto& row : rows) {
+      values.insert(row[i]);
+    }
+    if (util::FindMatchingValues(db, c->master_table, c->master_field, values)
+            .size() != values.size()) {
+      throw std::runtime_error("foreign key constraint violated");
+    }
+  }
+}
+
 void ExecuteInsertQuery(Database& db, const query::InsertQuery& query) {
   if (!db.Exists(query.table_name)) {
     throw std::runtime_error("table does not exist");
@@ -70,34 +149,18 @@ void ExecuteInsertQuery(Database& db, const query::InsertQuery& query) {
   std::vector<std::string> fields{query.fields.value_or(schema.fields())};
   CheckRowsSize(query, fields.size());
 
-  auto actual_values = RetrieveValues(schema, fields, query);
-
-  std::map<std::string, std::set<core::FieldVariant>> already_in_table;
-
-  for (const auto& row : actual_values) {
-    for (size_t i = 0; i < row.size(); ++i) {
-      if (schema.IsUnique(fields[i])) {
-        util::CheckUniquenessConstraint(db, query.table_name, fields[i],
-                                        row[i]);
-        if (already_in_table[fields[i]].contains(row[i])) {
-          throw std::runtime_error("unique key constraint violated");
-        }
-        already_in_table[fields[i]].emplace(row[i]);
-      }
-      util::CheckForeignKeyConstraintInInsertQuery(db, query.table_name,
-                                                   fields[i], row[i]);
-    }
-  }
-  already_in_table.clear();
+  const auto actual_values = RetrieveValues(schema, fields, query);
+  CheckUniqueness(db, query.table_name, fields, actual_values);
+  CheckForeignKeys(db, query.table_name, fields, actual_values);
 
+  ChangeBatch changes{db};
+  db.table_storage(query.table_name).Reserve(actual_values.size());
   auto scan = db.GetTableScan(query.table_name);
-  scan->BeforeFirst();
   for (const auto& row : actual_values) {
-    scan->Insert();
-    for (size_t i = 0; i < row.size(); ++i) {
-      scan->SetField(fields[i], row[i]);
-    }
+    scan->InsertRow(fields, row);
+    changes.PutRow(query.table_name, scan->row_id());
   }
+  changes.Commit();
 }
 
-}  // namespace deadfood::exec
\ No newline at end of file
+}  // namespace deadfood::exec
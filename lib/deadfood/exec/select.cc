@@ -1,5 +1,8 @@
 #include "select.hh"
 
+#include <algorithm>
+#include <ranges>
+
 #include <deadfood/scan/iscan.hh>
 #include <deadfood/scan/product_scan.hh>
 #include <deadfood/expr/bool_expr.hh>
@@ -7,10 +10,19 @@
 #include <deadfood/expr/cmp_expr.hh>
 #include <deadfood/expr/field_expr.hh>
 #include <deadfood/scan/left_join_scan.hh>
+#include <deadfood/scan/hash_join_scan.hh>
+#include <deadfood/scan/hash_aggregate_scan.hh>
 #include <deadfood/expr/expr_convert.hh>
 #include <deadfood/expr/scan_selector/simple_scan_selector.hh>
 #include <deadfood/scan/extend_scan.hh>
+#include <deadfood/scan/parallel_scan.hh>
+#include <deadfood/scan/radix_join_scan.hh>
+#include <deadfood/scan/sort_scan.hh>
+#include <deadfood/scan/limit_scan.hh>
+#include <deadfood/scan/distinct_scan.hh>
+#include <deadfood/scan/set_operation_scan.hh>
 #include <deadfood/exec/select/find_table_by_field.hh>
+#include <deadfood/exec/dql_util.hh>
 #include <deadfood/expr/const_expr.hh>
 
 #include <deadfood/util/str.hh>
@@ -21,7 +33,7 @@ void CheckIfFieldExists(const Database& db,
                         const std::map<std::string, size_t>& variables,
                         const std::map<std::string, std::string>& aliases,
                         const std::string& value) {
-  if (auto s = util::SplitOnDot(value)) {
+  if (auto s = deadfood::util::SplitOnDot(value)) {
     const auto& [table_name, field_name] = s.value();
     if (db.table_names().contains(table_name)) {
       if (!db.schemas().at(table_name).Exists(field_name)) {
@@ -44,6 +56,25 @@ void CheckIfFieldExists(const Database& db,
   }
 }
 
+bool ContainsAggregate(const expr::FactorTree& tree) {
+  if (std::holds_alternative<expr::ExprAggregate>(tree.factor)) {
+    return true;
+  }
+  const auto* expr = std::get_if<expr::ExprTree>(&tree.factor);
+  return expr != nullptr && std::ranges::any_of(expr->factors,
+                                                [](const auto& factor) {
+                                                  return ContainsAggregate(
+                                                      factor);
+                                                });
+}
+
+void CheckNoAggregate(const expr::FactorTree& tree, const std::string& where) {
+  if (ContainsAggregate(tree)) {
+    throw std::runtime_error("aggregate functions are not allowed in " +
+                             where);
+  }
+}
+
 struct Y {
   const Database& db;
   const std::map<std::string, size_t>& variables;
@@ -60,6 +91,13 @@ struct Y {
   }
 
   void operator()(const expr::Constant& expr) const {}
+
+  void operator()(const expr::ExprAggregate& expr) const {
+    for (const auto& arg : expr.args) {
+      CheckNoAggregate(arg, "aggregate arguments");
+      std::visit(*this, arg.factor);
+    }
+  }
 };
 
 struct X {
@@ -83,6 +121,7 @@ struct X {
     for (const auto& join : query.joins) {
       operator()(query::FromTable{.table_name = join.table_name,
                                   .renamed = join.alias});
+      CheckNoAggregate(join.predicate, "JOIN");
       std::visit(Y{db, variables, aliases}, join.predicate.factor);
 
       for (const auto& field_name : db.schemas().at(join.table_name).fields()) {
@@ -135,8 +174,28 @@ struct X {
     }
 
     if (query.predicate.has_value()) {
+      CheckNoAggregate(query.predicate.value(), "WHERE");
       std::visit(Y{db, variables, aliases}, query.predicate.value().factor);
     }
+
+    // GROUP BY and HAVING see the columns and the names of the selectors
+    auto grouping_variables = select_from_variables;
+    grouping_variables.insert(variables.begin(), variables.end());
+    for (const auto& key : query.group_by) {
+      CheckNoAggregate(key, "GROUP BY");
+      std::visit(Y{db, grouping_variables, aliases}, key.factor);
+    }
+    if (query.having.has_value()) {
+      std::visit(Y{db, grouping_variables, aliases},
+                 query.having.value().factor);
+    }
+    for (const auto& key : query.order_by) {
+      std::visit(Y{db, grouping_variables, aliases}, key.expr.factor);
+    }
+
+    for (const auto& operation : query.set_operations) {
+      X{.db = db, .variables = {}, .aliases = {}}(operation.query);
+    }
   }
 
   void operator()(const query::FromTable& query) {
@@ -164,7 +223,7 @@ std::unique_ptr<scan::IScan> GetScanFromSelectQuery(
 std::unique_ptr<scan::IScan> GetScanFromSource(Database& db,
                                                const query::SelectFrom& from) {
   return std::visit(
-      [&](auto&& arg) {
+      [&](auto&& arg) -> std::unique_ptr<scan::IScan> {
         using T = std::decay_t<decltype(arg)>;
         if constexpr (std::is_same_v<T, query::SelectQuery>) {
           return GetScanFromSelectQuery(db, arg);
@@ -182,50 +241,524 @@ std::unique_ptr<scan::IScan> GetScanFromSource(Database& db,
       from);
 }
 
-std::unique_ptr<scan::IScan> GetScanFromSelectQuery(
-    Database& db, const query::SelectQuery& query) {
-  std::unique_ptr<scan::IScan> scan;
-  if (!query.sources.empty()) {
-    scan = GetScanFromSource(db, query.sources[0]);
-    for (size_t i = 1; i < query.sources.size(); ++i) {
-      std::unique_ptr<scan::IScan> tmp = std::make_unique<scan::ProductScan>(std::move(scan),
-          GetScanFromSource(db, query.sources[i]));
-      scan = std::move(tmp);
+// Finds a conjunct `x = y` of a join predicate such that one side is a field
+// of `lhs` only and the other a field of `rhs` only, of the same kind when
+// both are table columns. Returns the names as (lhs field, rhs field).
+std::optional<std::pair<std::string, std::string>> FindEquiJoinFields(
+    const expr::FactorTree& predicate, const scan::IScan& lhs,
+    const scan::IScan& rhs) {
+  const auto* tree = std::get_if<expr::ExprTree>(&predicate.factor);
+  if (predicate.not_applied || predicate.neg_applied || tree == nullptr) {
+    return std::nullopt;
+  }
+  if (tree->op == expr::GenBinOp::And) {
+    for (const auto& factor : tree->factors) {
+      if (auto fields = FindEquiJoinFields(factor, lhs, rhs)) {
+        return fields;
+      }
     }
+    return std::nullopt;
+  }
+  if (tree->op != expr::GenBinOp::Eq || tree->factors.size() != 2) {
+    return std::nullopt;
   }
+  std::vector<std::string> ids;
+  for (const auto& factor : tree->factors) {
+    const auto* id = std::get_if<expr::ExprId>(&factor.factor);
+    if (factor.not_applied || factor.neg_applied || id == nullptr) {
+      return std::nullopt;
+    }
+    ids.emplace_back(id->id);
+  }
+  const auto only_in = [](const std::string& field, const scan::IScan& in,
+                          const scan::IScan& not_in) {
+    return in.HasField(field) && !not_in.HasField(field);
+  };
+  std::optional<std::pair<std::string, std::string>> fields;
+  if (only_in(ids[0], lhs, rhs) && only_in(ids[1], rhs, lhs)) {
+    fields = std::make_pair(ids[0], ids[1]);
+  } else if (only_in(ids[1], lhs, rhs) && only_in(ids[0], rhs, lhs)) {
+    fields = std::make_pair(ids[1], ids[0]);
+  } else {
+    return std::nullopt;
+  }
+  // comparing a string with a number fails, while hashing them finds no
+  // match; such a join is left to the nested loop, which reports the error
+  const auto lhs_binding = lhs.BindField(fields->first);
+  const auto rhs_binding = rhs.BindField(fields->second);
+  const auto is_varchar = [](const scan::FieldBinding& binding) {
+    return binding.field.type() == core::Field::FieldType::Varchar;
+  };
+  if (lhs_binding.has_value() && rhs_binding.has_value() &&
+      is_varchar(lhs_binding.value()) != is_varchar(rhs_binding.value())) {
+    return std::nullopt;
+  }
+  return fields;
+}
 
+// How a hash join of `lhs` (everything left of the JOIN) with the joined
+// table `rhs` is set up. The hash table is built on `rhs`, or on `lhs` when it
+// is a smaller base table; on a tie it goes to the side whose unmatched rows
+// are not preserved.
+struct HashJoinSides {
+  bool build_on_lhs;
+  scan::HashJoinScan::Mode mode;
+};
+
+HashJoinSides PickHashJoinSides(const scan::TableScan* lhs_table,
+                                const scan::TableScan& rhs,
+                                query::JoinType type) {
+  using Mode = scan::HashJoinScan::Mode;
+  bool build_on_lhs = false;
+  if (lhs_table != nullptr) {
+    const size_t lhs_rows = lhs_table->row_count();
+    const size_t rhs_rows = rhs.row_count();
+    build_on_lhs = lhs_rows < rhs_rows ||
+                   (lhs_rows == rhs_rows && type == query::JoinType::Right);
+  }
+  if (build_on_lhs) {
+    return {.build_on_lhs = true,
+            .mode = type == query::JoinType::Inner  ? Mode::Inner
+                    : type == query::JoinType::Left ? Mode::PreserveBuild
+                                                    : Mode::PreserveProbe};
+  }
+  return {.build_on_lhs = false,
+          .mode = type == query::JoinType::Inner  ? Mode::Inner
+                  : type == query::JoinType::Left ? Mode::PreserveProbe
+                                                  : Mode::PreserveBuild};
+}
+
+std::unique_ptr<scan::HashJoinScan> GetHashJoinScan(
+    std::unique_ptr<scan::IScan> lhs, std::unique_ptr<scan::TableScan> rhs,
+    query::JoinType type, const std::string& lhs_field,
+    const std::string& rhs_field) {
+  auto* lhs_table = dynamic_cast<scan::TableScan*>(lhs.get());
+  const auto sides = PickHashJoinSides(lhs_table, *rhs, type);
+  if (sides.build_on_lhs) {
+    lhs.release();
+    return std::make_unique<scan::HashJoinScan>(
+        std::move(rhs), std::unique_ptr<scan::TableScan>(lhs_table), rhs_field,
+        lhs_field, sides.mode);
+  }
+  return std::make_unique<scan::HashJoinScan>(std::move(lhs), std::move(rhs),
+                                              lhs_field, rhs_field, sides.mode);
+}
+
+// tables with fewer rows are not worth handing to the thread pool
+constexpr size_t kMinParallelRows = 4 * scan::ParallelScan::kMorselSlots;
+
+bool WorthParallel(size_t rows) {
+  return rows >= kMinParallelRows &&
+         deadfood::util::ThreadPool::Shared().size() > 1;
+}
+
+// Joins two tables with a RadixJoinScan on the shared thread pool.
+std::unique_ptr<scan::RadixJoinScan> GetRadixJoinScan(
+    std::unique_ptr<scan::TableScan> lhs, std::unique_ptr<scan::TableScan> rhs,
+    query::JoinType type, const std::string& lhs_field,
+    const std::string& rhs_field) {
+  const auto sides = PickHashJoinSides(lhs.get(), *rhs, type);
+  auto& pool = deadfood::util::ThreadPool::Shared();
+  if (sides.build_on_lhs) {
+    return std::make_unique<scan::RadixJoinScan>(
+        std::move(rhs), std::move(lhs), rhs_field, lhs_field, sides.mode, pool);
+  }
+  return std::make_unique<scan::RadixJoinScan>(
+      std::move(lhs), std::move(rhs), lhs_field, rhs_field, sides.mode, pool);
+}
+
+std::unique_ptr<scan::IScan> GetJoinScan(
+    std::unique_ptr<scan::IScan> scan, std::unique_ptr<scan::TableScan> joined,
+    const query::Join& join) {
+  const auto fields = FindEquiJoinFields(join.predicate, *scan, *joined);
+  auto* table = dynamic_cast<scan::TableScan*>(scan.get());
+  if (fields.has_value() && table != nullptr &&
+      WorthParallel(table->row_count() + joined->row_count())) {
+    scan.release();
+    auto tmp = GetRadixJoinScan(std::unique_ptr<scan::TableScan>(table),
+                                std::move(joined), join.type, fields->first,
+                                fields->second);
+    expr::ExprTreeConverter converter{
+        std::make_unique<expr::SimpleScanSelector>(tmp.get())};
+    tmp->set_predicate(converter.ConvertExprTreeToIExpr(join.predicate));
+    return tmp;
+  }
+  if (fields.has_value()) {
+    auto tmp = GetHashJoinScan(std::move(scan), std::move(joined), join.type,
+                               fields->first, fields->second);
+    expr::ExprTreeConverter converter{
+        std::make_unique<expr::SimpleScanSelector>(tmp.get())};
+    tmp->set_predicate(converter.ConvertExprTreeToIExpr(join.predicate));
+    return tmp;
+  }
+  if (join.type == query::JoinType::Inner) {
+    std::unique_ptr<scan::IScan> tmp = std::make_unique<scan::ProductScan>(
+        std::move(joined), std::move(scan));
+    expr::ExprTreeConverter converter{
+        std::make_unique<expr::SimpleScanSelector>(tmp.get())};
+    return std::make_unique<scan::SelectScan>(
+        std::move(tmp),
+        expr::BoolExpr(converter.ConvertExprTreeToIExpr(join.predicate)));
+  }
+  if (join.type == query::JoinType::Left) {
+    std::unique_ptr<scan::LeftJoinScan> tmp =
+        std::make_unique<scan::LeftJoinScan>(
+            std::move(scan), std::move(joined),
+            std::make_unique<expr::ConstExpr>(true));
+    expr::ExprTreeConverter converter{
+        std::make_unique<expr::SimpleScanSelector>(tmp.get())};
+    tmp->set_predicate(converter.ConvertExprTreeToIExpr(join.predicate));
+    return tmp;
+  }
+  if (join.type == query::JoinType::Right) {
+    std::unique_ptr<scan::LeftJoinScan> tmp =
+        std::make_unique<scan::LeftJoinScan>(
+            std::move(joined), std::move(scan),
+            std::make_unique<expr::ConstExpr>(true));
+    expr::ExprTreeConverter converter{
+        std::make_unique<expr::SimpleScanSelector>(tmp.get())};
+    tmp->set_predicate(converter.ConvertExprTreeToIExpr(join.predicate));
+    return tmp;
+  }
+  throw std::runtime_error("unhandled join type");
+}
+
+// A conjunct of the WHERE clause together with the fields it reads.
+struct Conjunct {
+  const expr::FactorTree* tree;
+  std::vector<std::string> fields;
+  bool applied;
+};
+
+void CollectFieldIds(const expr::FactorTree& tree,
+                     std::vector<std::string>& ids) {
+  if (const auto* id = std::get_if<expr::ExprId>(&tree.factor)) {
+    ids.emplace_back(id->id);
+  } else if (const auto* expr = std::get_if<expr::ExprTree>(&tree.factor)) {
+    for (const auto& factor : expr->factors) {
+      CollectFieldIds(factor, ids);
+    }
+  }
+}
+
+void SplitConjuncts(const expr::FactorTree& tree,
+                    std::vector<Conjunct>& conjuncts) {
+  const auto* expr = std::get_if<expr::ExprTree>(&tree.factor);
+  if (!tree.not_applied && !tree.neg_applied && expr != nullptr &&
+      expr->op == expr::GenBinOp::And) {
+    for (const auto& factor : expr->factors) {
+      SplitConjuncts(factor, conjuncts);
+    }
+    return;
+  }
+  auto& conjunct = conjuncts.emplace_back(
+      Conjunct{.tree = &tree, .fields = {}, .applied = false});
+  CollectFieldIds(tree, conjunct.fields);
+}
+
+expr::FactorTree AndOf(const std::vector<const expr::FactorTree*>& trees) {
+  if (trees.size() == 1) {
+    return *trees[0];
+  }
+  expr::ExprTree conjunction{.op = expr::GenBinOp::And, .factors = {}};
+  for (const auto* tree : trees) {
+    conjunction.factors.push_back(*tree);
+  }
+  return expr::FactorTree{
+      .neg_applied = false, .not_applied = false, .factor = conjunction};
+}
+
+// True if every field of `conjunct` comes from `scan` and from none of
+// `others`, so it can be checked on the rows of `scan` alone.
+bool ResolvesOnlyIn(const Conjunct& conjunct, const scan::IScan& scan,
+                    const std::vector<const scan::IScan*>& others) {
+  if (conjunct.fields.empty()) {
+    return false;
+  }
+  return std::ranges::all_of(conjunct.fields, [&](const std::string& field) {
+    return scan.HasField(field) &&
+           std::ranges::none_of(others, [&](const scan::IScan* other) {
+             return other != &scan && other->HasField(field);
+           });
+  });
+}
+
+bool ReadsAnyOf(const Conjunct& conjunct,
+                const std::vector<const scan::IScan*>& scans) {
+  return std::ranges::any_of(conjunct.fields, [&](const std::string& field) {
+    return std::ranges::any_of(scans, [&](const scan::IScan* scan) {
+      return scan->HasField(field);
+    });
+  });
+}
+
+std::unique_ptr<scan::IScan> Filter(
+    std::unique_ptr<scan::IScan> scan,
+    const std::vector<const expr::FactorTree*>& conjuncts) {
+  if (conjuncts.empty()) {
+    return scan;
+  }
+  expr::ExprTreeConverter converter{
+      std::make_unique<expr::SimpleScanSelector>(scan.get())};
+  auto predicate = converter.ConvertExprTreeToIExpr(AndOf(conjuncts));
+  return std::make_unique<scan::SelectScan>(
+      std::move(scan), expr::BoolExpr(std::move(predicate)));
+}
+
+// Filters a FROM source, through an index if one of its columns has one.
+std::unique_ptr<scan::IScan> FilterSource(
+    Database& db, const query::SelectFrom& from,
+    std::unique_ptr<scan::IScan> scan,
+    const std::vector<const expr::FactorTree*>& conjuncts) {
+  const auto* table = std::get_if<query::FromTable>(&from);
+  if (table != nullptr && !conjuncts.empty()) {
+    if (auto index_scan = util::GetIndexScan(
+            db, table->table_name, table->renamed.value_or(table->table_name),
+            AndOf(conjuncts))) {
+      scan = std::move(index_scan);
+    }
+  }
+  return Filter(std::move(scan), conjuncts);
+}
+
+// Applies the pending conjuncts whose fields are all provided by `scan` and
+// not by any input that is joined later.
+std::unique_ptr<scan::IScan> ApplyReadyConjuncts(
+    std::unique_ptr<scan::IScan> scan, std::vector<Conjunct>& conjuncts,
+    const std::vector<const scan::IScan*>& later_inputs) {
+  std::vector<const expr::FactorTree*> ready;
+  for (auto& conjunct : conjuncts) {
+    if (!conjunct.applied && ResolvesOnlyIn(conjunct, *scan, later_inputs)) {
+      ready.push_back(conjunct.tree);
+      conjunct.applied = true;
+    }
+  }
+  return Filter(std::move(scan), ready);
+}
+
+// assumed size of a subquery in FROM, which is not known before running it
+constexpr double kSubqueryRows = 1000;
+
+// Estimated number of rows `from` yields once `local` conjuncts filter it.
+double EstimateSourceRows(const Database& db, const query::SelectFrom& from,
+                          const std::vector<const expr::FactorTree*>& local) {
+  const auto* table = std::get_if<query::FromTable>(&from);
+  if (table == nullptr) {
+    return kSubqueryRows;
+  }
+  double rows = util::EstimateRows(db, table->table_name);
+  for (const auto* conjunct : local) {
+    rows *= util::EstimateSelectivity(
+        db, table->table_name, table->renamed.value_or(table->table_name),
+        *conjunct);
+  }
+  return rows;
+}
+
+// Estimated number of distinct values of `field` of the FROM source `from`.
+std::optional<double> EstimateSourceDistinct(const Database& db,
+                                             const query::SelectFrom& from,
+                                             const std::string& field) {
+  const auto* table = std::get_if<query::FromTable>(&from);
+  if (table == nullptr) {
+    return std::nullopt;
+  }
+  const auto split = deadfood::util::SplitOnDot(field);
+  return util::EstimateDistinct(db, table->table_name,
+                                split.has_value() ? split->second : field);
+}
+
+// Orders the FROM sources greedily: the smallest estimated source first, then
+// each time the source that keeps the estimated intermediate result smallest.
+// Joining on an equality divides the product by the distinct count of the key.
+std::vector<size_t> OrderSources(
+    const Database& db, const query::SelectQuery& query,
+    const std::vector<std::unique_ptr<scan::IScan>>& sources,
+    const std::vector<std::vector<const expr::FactorTree*>>& local,
+    const std::vector<Conjunct>& conjuncts) {
+  std::vector<double> rows;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    rows.push_back(EstimateSourceRows(db, query.sources[i], local[i]));
+  }
+  std::vector<size_t> order;
+  std::vector<size_t> remaining(sources.size());
+  for (size_t i = 0; i < remaining.size(); ++i) {
+    remaining[i] = i;
+  }
+  const auto smallest = std::ranges::min_element(
+      remaining, {}, [&](size_t i) { return rows[i]; });
+  double combined_rows = rows[*smallest];
+  order.push_back(*smallest);
+  remaining.erase(smallest);
+
+  while (!remaining.empty()) {
+    auto best = remaining.begin();
+    double best_rows = 0;
+    for (auto it = remaining.begin(); it != remaining.end(); ++it) {
+      double joined_rows = combined_rows * rows[*it];
+      for (const auto& conjunct : conjuncts) {
+        if (conjunct.applied) {
+          continue;
+        }
+        for (const size_t i : order) {
+          const auto key_fields =
+              FindEquiJoinFields(*conjunct.tree, *sources[i], *sources[*it]);
+          if (!key_fields.has_value()) {
+            continue;
+          }
+          const double distinct = std::max(
+              {EstimateSourceDistinct(db, query.sources[i], key_fields->first)
+                   .value_or(1),
+               EstimateSourceDistinct(db, query.sources[*it],
+                                      key_fields->second)
+                   .value_or(1),
+               1.0});
+          joined_rows =
+              std::min(joined_rows, combined_rows * rows[*it] / distinct);
+        }
+      }
+      if (it == remaining.begin() || joined_rows < best_rows) {
+        best = it;
+        best_rows = joined_rows;
+      }
+    }
+    combined_rows = best_rows;
+    order.push_back(*best);
+    remaining.erase(best);
+  }
+  return order;
+}
+
+// Combines the FROM sources, in the order picked by OrderSources, and then the
+// joins of `query`, which keep their written order. Each conjunct of its WHERE
+// clause is checked as early as the fields it reads allow:
+//   - conjuncts on a single FROM table filter it below the product;
+//   - an equality between a FROM table and the sources before it turns the
+//     product into a hash join;
+//   - anything else is checked right after the input providing its last
+//     field is joined.
+// Rows a RIGHT join null-extends must reach it unfiltered, so conjuncts are
+// not applied before the last RIGHT join. Conjuncts reading fields that only
+// exist on the final rows are returned in `residual`.
+std::unique_ptr<scan::IScan> GetJoinedScan(
+    Database& db, const query::SelectQuery& query,
+    std::vector<const expr::FactorTree*>& residual) {
+  std::vector<Conjunct> conjuncts;
+  if (query.predicate.has_value()) {
+    SplitConjuncts(query.predicate.value(), conjuncts);
+  }
+
+  std::vector<std::unique_ptr<scan::IScan>> sources;
+  for (const auto& source : query.sources) {
+    sources.push_back(GetScanFromSource(db, source));
+  }
+  std::vector<std::unique_ptr<scan::TableScan>> joined;
   for (const auto& join : query.joins) {
-    if (join.type == query::JoinType::Inner) {
+    joined.push_back(db.GetTableScan(join.table_name, join.alias));
+  }
+  // inputs that are not part of the combined scan yet
+  std::vector<const scan::IScan*> pending;
+  for (const auto& source : sources) {
+    pending.push_back(source.get());
+  }
+  for (const auto& table : joined) {
+    pending.push_back(table.get());
+  }
+  size_t right_joins_left = static_cast<size_t>(
+      std::ranges::count_if(query.joins, [](const query::Join& join) {
+        return join.type == query::JoinType::Right;
+      }));
+
+  std::vector<std::vector<const expr::FactorTree*>> local(sources.size());
+  if (right_joins_left == 0) {
+    for (auto& conjunct : conjuncts) {
+      for (size_t i = 0; i < sources.size(); ++i) {
+        if (ResolvesOnlyIn(conjunct, *sources[i], pending)) {
+          local[i].push_back(conjunct.tree);
+          conjunct.applied = true;
+          break;
+        }
+      }
+    }
+  }
+
+  const auto order = OrderSources(db, query, sources, local, conjuncts);
+  std::erase(pending, sources[order[0]].get());
+  auto scan = FilterSource(db, query.sources[order[0]],
+                           std::move(sources[order[0]]), local[order[0]]);
+  for (const size_t i : std::views::drop(order, 1)) {
+    std::erase(pending, sources[i].get());
+    auto* table = dynamic_cast<scan::TableScan*>(sources[i].get());
+    Conjunct* key = nullptr;
+    std::optional<std::pair<std::string, std::string>> key_fields;
+    for (auto& conjunct : conjuncts) {
+      if (table == nullptr || right_joins_left > 0) {
+        break;
+      }
+      if (conjunct.applied || ReadsAnyOf(conjunct, pending)) {
+        continue;
+      }
+      key_fields = FindEquiJoinFields(*conjunct.tree, *scan, *table);
+      if (key_fields.has_value()) {
+        key = &conjunct;
+        break;
+      }
+    }
+    if (key == nullptr) {
       std::unique_ptr<scan::IScan> tmp = std::make_unique<scan::ProductScan>(
-          db.GetTableScan(join.table_name, join.alias), std::move(scan));
-      expr::ExprTreeConverter converter{
-          std::make_unique<expr::SimpleScanSelector>(tmp.get())};
-      scan = std::make_unique<scan::SelectScan>(
-          std::move(tmp),
-          expr::BoolExpr(converter.ConvertExprTreeToIExpr(join.predicate)));
-    } else if (join.type == query::JoinType::Left) {
-      std::unique_ptr<scan::LeftJoinScan> tmp =
-          std::make_unique<scan::LeftJoinScan>(
-              std::move(scan), db.GetTableScan(join.table_name, join.alias),
-              std::make_unique<expr::ConstExpr>(true));
-      expr::ExprTreeConverter converter{
-          std::make_unique<expr::SimpleScanSelector>(tmp.get())};
-      tmp->set_predicate(converter.ConvertExprTreeToIExpr(join.predicate));
+          std::move(scan), FilterSource(db, query.sources[i],
+                                        std::move(sources[i]), local[i]));
       scan = std::move(tmp);
-    } else if (join.type == query::JoinType::Right) {
-      std::unique_ptr<scan::LeftJoinScan> tmp =
-          std::make_unique<scan::LeftJoinScan>(
-              db.GetTableScan(join.table_name, join.alias), std::move(scan),
-              std::make_unique<expr::ConstExpr>(true));
+    } else {
+      std::unique_ptr<expr::IExpr> build_filter;
+      if (!local[i].empty()) {
+        expr::ExprTreeConverter converter{
+            std::make_unique<expr::SimpleScanSelector>(table)};
+        build_filter = converter.ConvertExprTreeToIExpr(AndOf(local[i]));
+      }
+      sources[i].release();
+      auto tmp = std::make_unique<scan::HashJoinScan>(
+          std::move(scan), std::unique_ptr<scan::TableScan>(table),
+          key_fields->first, key_fields->second,
+          scan::HashJoinScan::Mode::Inner);
+      if (build_filter != nullptr) {
+        tmp->set_build_filter(std::move(build_filter));
+      }
       expr::ExprTreeConverter converter{
           std::make_unique<expr::SimpleScanSelector>(tmp.get())};
-      tmp->set_predicate(converter.ConvertExprTreeToIExpr(join.predicate));
+      tmp->set_predicate(converter.ConvertExprTreeToIExpr(*key->tree));
+      key->applied = true;
       scan = std::move(tmp);
-    } else {
-      throw std::runtime_error("unhandled join type");
+    }
+    if (right_joins_left == 0) {
+      scan = ApplyReadyConjuncts(std::move(scan), conjuncts, pending);
+    }
+  }
+
+  for (size_t i = 0; i < query.joins.size(); ++i) {
+    pending.erase(pending.begin());
+    if (query.joins[i].type == query::JoinType::Right) {
+      --right_joins_left;
+    }
+    scan = GetJoinScan(std::move(scan), std::move(joined[i]), query.joins[i]);
+    if (right_joins_left == 0) {
+      scan = ApplyReadyConjuncts(std::move(scan), conjuncts, pending);
+    }
+  }
+
+  for (const auto& conjunct : conjuncts) {
+    if (!conjunct.applied) {
+      residual.push_back(conjunct.tree);
     }
   }
+  return scan;
+}
 
+// Adds the computed fields of `query` on top of `scan`, then checks the
+// `residual` WHERE conjuncts, which may read them.
+std::unique_ptr<scan::IScan> AddSelectors(
+    std::unique_ptr<scan::IScan> scan, const query::SelectQuery& query,
+    const std::vector<const expr::FactorTree*>& residual) {
   for (const auto& selector : query.selectors) {
     if (auto s = std::get_if<query::FieldSelector>(&selector)) {
       expr::ExprTreeConverter converter{
@@ -235,18 +768,350 @@ std::unique_ptr<scan::IScan> GetScanFromSelectQuery(
           s->field_name);
     }
   }
+  return Filter(std::move(scan), residual);
+}
 
-  if (query.predicate.has_value()) {
-    expr::ExprTreeConverter converter{
+// Scans a single table and computes the selectors and WHERE clause of `query`
+// on it in parallel, one pipeline per worker of the shared thread pool.
+std::unique_ptr<scan::IScan> GetParallelScan(
+    Database& db, const query::SelectQuery& query,
+    const query::FromTable& table,
+    const std::vector<const expr::FactorTree*>& residual) {
+  const auto& schema = db.schemas().at(table.table_name);
+  // the computed fields shadow the columns, the last one all others
+  std::vector<std::string> fields;
+  for (const auto& selector : std::views::reverse(query.selectors)) {
+    if (auto s = std::get_if<query::FieldSelector>(&selector)) {
+      fields.push_back(s->field_name);
+    }
+  }
+  fields.insert(fields.end(), schema.fields().begin(), schema.fields().end());
+  return std::make_unique<scan::ParallelScan>(
+      db.table_storage(table.table_name), schema,
+      table.renamed.value_or(table.table_name),
+      [&](std::unique_ptr<scan::TableScan> scan) {
+        return AddSelectors(std::move(scan), query, residual);
+      },
+      std::move(fields), deadfood::util::ThreadPool::Shared());
+}
+
+bool IsAggregateQuery(const query::SelectQuery& query) {
+  if (!query.group_by.empty() || query.having.has_value()) {
+    return true;
+  }
+  const auto aggregates = [](const query::Selector& selector) {
+    const auto* s = std::get_if<query::FieldSelector>(&selector);
+    return s != nullptr && ContainsAggregate(s->expr);
+  };
+  const auto orders_by_aggregate = [](const query::OrderKey& key) {
+    return ContainsAggregate(key.expr);
+  };
+  return std::ranges::any_of(query.selectors, aggregates) ||
+         std::ranges::any_of(query.order_by, orders_by_aggregate);
+}
+
+bool SameTree(const expr::FactorTree& lhs, const expr::FactorTree& rhs);
+
+bool SameTrees(const std::vector<expr::FactorTree>& lhs,
+               const std::vector<expr::FactorTree>& rhs) {
+  return std::ranges::equal(lhs, rhs, SameTree);
+}
+
+bool SameTree(const expr::FactorTree& lhs, const expr::FactorTree& rhs) {
+  if (lhs.neg_applied != rhs.neg_applied ||
+      lhs.not_applied != rhs.not_applied ||
+      lhs.factor.index() != rhs.factor.index()) {
+    return false;
+  }
+  return std::visit(
+      [&](auto&& arg) {
+        using T = std::decay_t<decltype(arg)>;
+        const auto& other = std::get<T>(rhs.factor);
+        if constexpr (std::is_same_v<T, expr::ExprTree>) {
+          return arg.op == other.op && SameTrees(arg.factors, other.factors);
+        } else if constexpr (std::is_same_v<T, expr::ExprId>) {
+          return arg.id == other.id;
+        } else if constexpr (std::is_same_v<T, expr::Constant>) {
+          return arg == other;
+        } else {
+          return arg.fn == other.fn && SameTrees(arg.args, other.args);
+        }
+      },
+      lhs.factor);
+}
+
+// The fields a HashAggregateScan computes for a query: its group keys and
+// the aggregate calls of the select list and HAVING.
+struct Aggregation {
+  std::vector<std::pair<const expr::FactorTree*, std::string>> keys;
+  std::vector<std::pair<expr::ExprAggregate, std::string>> aggregates;
+
+  // Returns `tree` reading the fields of the aggregation in place of the
+  // aggregate calls and the grouped expressions.
+  expr::FactorTree Rewrite(const expr::FactorTree& tree) {
+    for (const auto& [key, name] : keys) {
+      if (SameTree(tree, *key)) {
+        return expr::FactorTree{.neg_applied = false,
+                                .not_applied = false,
+                                .factor = expr::ExprId{.id = name}};
+      }
+    }
+    auto ret = tree;
+    if (auto* aggregate = std::get_if<expr::ExprAggregate>(&ret.factor)) {
+      auto name = "$agg" + std::to_string(aggregates.size());
+      aggregates.emplace_back(std::move(*aggregate), name);
+      ret.factor = expr::ExprId{.id = std::move(name)};
+    } else if (auto* expr = std::get_if<expr::ExprTree>(&ret.factor)) {
+      for (auto& factor : expr->factors) {
+        factor = Rewrite(factor);
+      }
+    }
+    return ret;
+  }
+};
+
+void CheckGrouped(const expr::FactorTree& tree, const scan::IScan& scan) {
+  std::vector<std::string> ids;
+  CollectFieldIds(tree, ids);
+  for (const auto& id : ids) {
+    if (!scan.HasField(id)) {
+      throw std::runtime_error("`" + id +
+                               "` must appear in GROUP BY or be used in an "
+                               "aggregate function");
+    }
+  }
+}
+
+// Groups the rows of `scan` by the GROUP BY clause of `query`, after the
+// `residual` WHERE conjuncts have filtered them, then computes the selectors
+// and checks HAVING on the groups. The `order_keys` are rewritten to be
+// computed on the groups as well.
+std::unique_ptr<scan::IScan> AddAggregation(
+    std::unique_ptr<scan::IScan> scan, const query::SelectQuery& query,
+    const std::vector<const expr::FactorTree*>& residual,
+    std::vector<expr::FactorTree>& order_keys) {
+  if (scan == nullptr) {
+    throw std::runtime_error("aggregate functions need a FROM clause");
+  }
+  // computed fields without aggregates can be grouped by and filtered on
+  for (const auto& selector : query.selectors) {
+    if (std::holds_alternative<query::SelectAllSelector>(selector)) {
+      throw std::runtime_error("`*` cannot be selected from groups");
+    }
+    const auto* s = std::get_if<query::FieldSelector>(&selector);
+    if (s != nullptr && !ContainsAggregate(s->expr)) {
+      expr::ExprTreeConverter converter{
+          std::make_unique<expr::SimpleScanSelector>(scan.get())};
+      scan = std::make_unique<scan::ExtendScan>(
+          std::move(scan), converter.ConvertExprTreeToIExpr(s->expr),
+          s->field_name);
+    }
+  }
+  scan = Filter(std::move(scan), residual);
+
+  Aggregation aggregation;
+  for (const auto& key : query.group_by) {
+    const auto* id = std::get_if<expr::ExprId>(&key.factor);
+    aggregation.keys.emplace_back(
+        &key, id != nullptr && !key.neg_applied && !key.not_applied
+                  ? id->id
+                  : "$group" + std::to_string(aggregation.keys.size()));
+  }
+  std::vector<std::pair<expr::FactorTree, std::string>> selectors;
+  for (const auto& selector : query.selectors) {
+    const auto* s = std::get_if<query::FieldSelector>(&selector);
+    if (s != nullptr) {
+      selectors.emplace_back(aggregation.Rewrite(s->expr), s->field_name);
+    }
+  }
+  std::optional<expr::FactorTree> having;
+  if (query.having.has_value()) {
+    having = aggregation.Rewrite(query.having.value());
+  }
+  for (auto& key : order_keys) {
+    key = aggregation.Rewrite(key);
+  }
+
+  expr::ExprTreeConverter converter{
+      std::make_unique<expr::SimpleScanSelector>(scan.get())};
+  std::vector<scan::HashAggregateScan::Key> keys;
+  for (const auto& [key, name] : aggregation.keys) {
+    keys.push_back({.name = name,
+                    .expr = converter.ConvertExprTreeToIExpr(*key)});
+  }
+  std::vector<scan::HashAggregateScan::Aggregate> aggregates;
+  for (const auto& [aggregate, name] : aggregation.aggregates) {
+    aggregates.push_back(
+        {.name = name,
+         .fn = aggregate.fn,
+         .arg = aggregate.args.empty()
+                    ? nullptr
+                    : converter.ConvertExprTreeToIExpr(aggregate.args[0])});
+  }
+  scan = std::make_unique<scan::HashAggregateScan>(
+      std::move(scan), std::move(keys), std::move(aggregates));
+
+  for (const auto& selector : query.selectors) {
+    if (const auto* name = std::get_if<std::string>(&selector)) {
+      CheckGrouped(expr::FactorTree{.neg_applied = false,
+                                    .not_applied = false,
+                                    .factor = expr::ExprId{.id = *name}},
+                   *scan);
+    }
+  }
+  for (const auto& [tree, name] : selectors) {
+    // a grouped computed field is already there
+    if (std::ranges::any_of(aggregation.keys, [&](const auto& key) {
+          return key.second == name;
+        })) {
+      continue;
+    }
+    CheckGrouped(tree, *scan);
+    expr::ExprTreeConverter tree_converter{
         std::make_unique<expr::SimpleScanSelector>(scan.get())};
-    scan = std::make_unique<scan::SelectScan>(
-        std::move(scan), expr::BoolExpr(converter.ConvertExprTreeToIExpr(
-                             query.predicate.value())));
+    scan = std::make_unique<scan::ExtendScan>(
+        std::move(scan), tree_converter.ConvertExprTreeToIExpr(tree), name);
+  }
+  for (const auto& key : order_keys) {
+    CheckGrouped(key, *scan);
+  }
+  if (having.has_value()) {
+    CheckGrouped(having.value(), *scan);
+    return Filter(std::move(scan), {&having.value()});
+  }
+  return scan;
+}
+
+std::vector<std::string> GetSelectedFields(Database& db,
+                                           const query::SelectQuery& query);
+
+// Sorts the rows of `scan` by `order_keys`, the keys of the ORDER BY clause
+// of `query`. Under a LIMIT only the rows that can make it are kept.
+std::unique_ptr<scan::IScan> GetSortScan(
+    Database& db, std::unique_ptr<scan::IScan> scan,
+    const query::SelectQuery& query,
+    const std::vector<expr::FactorTree>& order_keys) {
+  expr::ExprTreeConverter converter{
+      std::make_unique<expr::SimpleScanSelector>(scan.get())};
+  std::vector<scan::SortScan::Key> keys;
+  for (size_t i = 0; i < order_keys.size(); ++i) {
+    keys.push_back({.expr = converter.ConvertExprTreeToIExpr(order_keys[i]),
+                    .descending = query.order_by[i].descending});
+  }
+  std::optional<size_t> top;
+  if (query.limit.has_value()) {
+    top = query.limit.value() + query.offset.value_or(0);
   }
+  return std::make_unique<scan::SortScan>(std::move(scan), std::move(keys),
+                                          GetSelectedFields(db, query), top);
+}
 
+// Sorts the rows of `scan` by the ORDER BY clause of `query`, whose keys are
+// `order_keys`, then applies its LIMIT and OFFSET.
+std::unique_ptr<scan::IScan> AddOrdering(
+    Database& db, std::unique_ptr<scan::IScan> scan,
+    const query::SelectQuery& query,
+    const std::vector<expr::FactorTree>& order_keys) {
+  const size_t offset = query.offset.value_or(0);
+  if (!order_keys.empty()) {
+    scan = GetSortScan(db, std::move(scan), query, order_keys);
+  }
+  if (query.limit.has_value() || offset != 0) {
+    scan = std::make_unique<scan::LimitScan>(std::move(scan), query.limit,
+                                             offset);
+  }
   return scan;
 }
 
+// Drops the repeated rows of `scan` if `query` is a SELECT DISTINCT.
+std::unique_ptr<scan::IScan> AddDistinct(Database& db,
+                                         std::unique_ptr<scan::IScan> scan,
+                                         const query::SelectQuery& query) {
+  if (!query.distinct) {
+    return scan;
+  }
+  return std::make_unique<scan::DistinctScan>(std::move(scan),
+                                              GetSelectedFields(db, query));
+}
+
+// Builds the rows of a single SELECT, before its ORDER BY, LIMIT and OFFSET.
+// The `order_keys` are rewritten to read the rows of an aggregation.
+std::unique_ptr<scan::IScan> GetSelectCoreScan(
+    Database& db, const query::SelectQuery& query,
+    std::vector<expr::FactorTree>& order_keys) {
+  const bool aggregate = IsAggregateQuery(query);
+  std::unique_ptr<scan::IScan> scan;
+  // the WHERE conjuncts still to be checked on the final rows
+  std::vector<const expr::FactorTree*> residual;
+  if (query.sources.size() > 1 || !query.joins.empty()) {
+    scan = GetJoinedScan(db, query, residual);
+  } else if (!query.sources.empty()) {
+    const auto* single_table = std::get_if<query::FromTable>(&query.sources[0]);
+    if (single_table != nullptr && query.predicate.has_value()) {
+      scan = util::GetIndexScan(
+          db, single_table->table_name,
+          single_table->renamed.value_or(single_table->table_name),
+          query.predicate.value());
+    }
+    if (query.predicate.has_value()) {
+      residual.push_back(&query.predicate.value());
+    }
+    // a LIMIT without ORDER BY stops early, the workers would read ahead
+    const bool stops_early = query.limit.has_value() && query.order_by.empty();
+    if (!aggregate && !stops_early && scan == nullptr &&
+        single_table != nullptr &&
+        db.table_names().contains(single_table->table_name) &&
+        WorthParallel(db.table_storage(single_table->table_name).size())) {
+      return AddDistinct(
+          db, GetParallelScan(db, query, *single_table, residual), query);
+    }
+    if (scan == nullptr) {
+      scan = GetScanFromSource(db, query.sources[0]);
+    }
+  }
+  if (aggregate) {
+    scan = AddAggregation(std::move(scan), query, residual, order_keys);
+  } else {
+    scan = AddSelectors(std::move(scan), query, residual);
+  }
+  return AddDistinct(db, std::move(scan), query);
+}
+
+std::unique_ptr<scan::IScan> GetScanFromSelectQuery(
+    Database& db, const query::SelectQuery& query) {
+  std::vector<expr::FactorTree> order_keys;
+  for (const auto& key : query.order_by) {
+    order_keys.push_back(key.expr);
+  }
+  if (query.set_operations.empty()) {
+    auto scan = GetSelectCoreScan(db, query, order_keys);
+    return AddOrdering(db, std::move(scan), query, order_keys);
+  }
+
+  // the ORDER BY of a compound query sorts its result, not the first query
+  std::vector<expr::FactorTree> core_order_keys;
+  auto scan = GetSelectCoreScan(db, query, core_order_keys);
+  const auto fields = GetSelectedFields(db, query);
+  for (const auto& operation : query.set_operations) {
+    core_order_keys.clear();
+    auto rhs = GetSelectCoreScan(db, operation.query, core_order_keys);
+    scan = std::make_unique<scan::SetOperationScan>(
+        std::move(scan), fields, std::move(rhs),
+        GetSelectedFields(db, operation.query), operation.op, operation.all);
+  }
+  for (const auto& key : order_keys) {
+    std::vector<std::string> ids;
+    CollectFieldIds(key, ids);
+    for (const auto& id : ids) {
+      if (!scan->HasField(id)) {
+        throw std::runtime_error("`" + id +
+                                 "` is not a field of the compound query");
+      }
+    }
+  }
+  return AddOrdering(db, std::move(scan), query, order_keys);
+}
+
 struct ObtainAllFieldsVisitor {
   Database& db;
 
@@ -291,13 +1156,17 @@ struct ObtainAllFieldsVisitor {
   }
 };
 
+std::vector<std::string> GetSelectedFields(Database& db,
+                                           const query::SelectQuery& query) {
+  return ObtainAllFieldsVisitor{db}(query);
+}
+
 std::pair<std::unique_ptr<scan::IScan>, std::vector<std::string>>
 ExecuteSelectQuery(Database& db, const query::SelectQuery& query) {
   X{.db = db}(query);
   auto scan = GetScanFromSelectQuery(db, query);
 
-  ObtainAllFieldsVisitor vis{db};
-  std::vector<std::string> fields = vis(query);
+  std::vector<std::string> fields = GetSelectedFields(db, query);
   scan->BeforeFirst();
   return {std::move(scan), fields};
 }
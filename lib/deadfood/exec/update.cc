@@ -1,13 +1,30 @@
 #include "update.hh"
 
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+
 #include <deadfood/expr/expr_convert.hh>
 #include <deadfood/expr/scan_selector/simple_scan_selector.hh>
 #include <deadfood/scan/select_scan.hh>
 
 #include <deadfood/exec/dml_util.hh>
+#include <deadfood/exec/dql_util.hh>
 
 namespace deadfood::exec {
 
+// The new values of one SET column, one per matching row, stored with the
+// type of the column.
+struct ColumnDelta {
+  std::string field_name;
+  std::unique_ptr<expr::IExpr> expr;
+  scan::ColumnVector values;
+  // whether some foreign key that forbids updates references the column
+  bool referenced;
+  // values the matching rows stop holding, if `referenced`
+  util::ValueSet old_values;
+};
+
 void ValidateFieldNames(const core::Schema& schema,
                         const query::UpdateQuery& query) {
   for (const auto& [field_name, _] : query.sets) {
@@ -17,6 +34,107 @@ void ValidateFieldNames(const core::Schema& schema,
   }
 }
 
+void ResetTypedColumn(scan::ColumnVector& column,
+                      core::Field::FieldType type) {
+  switch (type) {
+    case core::Field::FieldType::Bool:
+      column.ResetTyped<uint8_t>(0);
+      break;
+    case core::Field::FieldType::Int:
+      column.ResetTyped<int>(0);
+      break;
+    case core::Field::FieldType::Float:
+      column.ResetTyped<float>(0);
+      break;
+    case core::Field::FieldType::Double:
+      column.ResetTyped<double>(0);
+      break;
+    case core::Field::FieldType::Varchar:
+      column.ResetTyped<std::string>(0);
+      break;
+  }
+}
+
+bool IsReferencedOnUpdate(const Database& db, const std::string& table_name,
+                          const std::string& field_name) {
+  return std::ranges::any_of(
+      db.constraints_const(), [&](const core::Constraint& constraint) {
+        const auto* c = std::get_if<core::ReferencesConstraint>(&constraint);
+        return c != nullptr && c->master_table == table_name &&
+               c->master_field == field_name &&
+               c->on_update == core::ReferencesConstraint::OnAction::NoAction;
+      });
+}
+
+// Checks that the new values of a unique column are distinct and held by no
+// row the statement leaves alone.
+void CheckUniqueness(Database& db, const std::string& table_name,
+                     const ColumnDelta& delta,
+                     const std::unordered_set<size_t>& updated_rows) {
+  util::ValueSet values;
+  values.reserve(delta.values.size());
+  for (size_t i = 0; i < delta.values.size(); ++i) {
+    if (!values.insert(delta.values.Get(i)).second) {
+      throw std::runtime_error("unique constraint violated");
+    }
+  }
+  const auto kept = [&](size_t row_id) {
+    return !updated_rows.contains(row_id);
+  };
+  if (const auto* index =
+          db.table_storage(table_name).hash_index(delta.field_name)) {
+    for (const auto& value : values) {
+      if (std::ranges::any_of(index->Find(value), kept)) {
+        throw std::runtime_error("unique constraint violated");
+      }
+    }
+    return;
+  }
+  auto scan = db.GetTableScan(table_name);
+  scan->BeforeFirst();
+  while (scan->Next()) {
+    if (kept(scan->row_id()) &&
+        values.contains(scan->GetField(delta.field_name))) {
+      throw std::runtime_error("unique constraint violated");
+    }
+  }
+}
+
+// Checks the foreign keys involving the updated columns: the values rows of
+// this table stop holding must not be referenced, and the new values of a
+// referencing column must exist in the master table.
+void CheckForeignKeys(Database& db, const std::string& table_name,
+                      const ColumnDelta& delta) {
+  for (const auto& constraint : db.constraints()) {
+    const auto* c = std::get_if<core::ReferencesConstraint>(&constraint);
+    if (c == nullptr) {
+      continue;
+    }
+    if (c->master_table == table_name &&
+        c->master_field == delta.field_name &&
+        c->on_update == core::ReferencesConstraint::OnAction::NoAction &&
+        !util::FindMatchingValues(db, c->slave_table, c->slave_field,
+                                  delta.old_values)
+             .empty()) {
+      throw std::runtime_error("foreign key constraint violated");
+    }
+    if (c->slave_table == table_name && c->slave_field == delta.field_name) {
+      util::ValueSet values;
+      for (size_t i = 0; i < delta.values.size(); ++i) {
+        values.insert(delta.values.Get(i));
+      }
+      if (util::FindMatchingValues(db, c->master_table, c->master_field,
+                                   values)
+              .size() != values.size()) {
+        throw std::runtime_error("foreign key constraint violated");
+      }
+    }
+  }
+}
+
+// Finds the matching rows in one pass, keeping only their ids and the new
+// values of the SET columns. The constraints are checked on the whole delta,
+// and only then are the rows changed in place.
 void ExecuteUpdateQuery(Database& db, const query::UpdateQuery& query) {
   if (!db.Exists(query.table_name)) {
     throw std::runtime_error("table does not exist");
@@ -24,7 +142,21 @@ void ExecuteUpdateQuery(Database& db, const query::UpdateQuery& query) {
   const auto& schema = db.schemas().at(query.table_name);
   ValidateFieldNames(schema, query);
 
-  auto scan = db.GetTableScan(query.table_name);
+  std::unique_ptr<scan::IScan> scan;
+  std::function<size_t()> row_id;
+  std::unique_ptr<scan::IndexScan> index_scan;
+  if (query.predicate.has_value()) {
+    index_scan = util::GetIndexScan(db, query.table_name, query.table_name,
+                                    query.predicate.value());
+  }
+  if (index_scan != nullptr) {
+    row_id = [rows = index_scan.get()] { return rows->row_id(); };
+    scan = std::move(index_scan);
+  } else {
+    auto table_scan = db.GetTableScan(query.table_name);
+    row_id = [rows = table_scan.get()] { return rows->row_id(); };
+    scan = std::move(table_scan);
+  }
   if (query.predicate.has_value()) {
     expr::ExprTreeConverter conv{
         std::make_unique<expr::SimpleScanSelector>(scan.get())};
@@ -34,39 +166,58 @@ void ExecuteUpdateQuery(Database& db, const query::UpdateQuery& query) {
   }
   expr::ExprTreeConverter conv{
       std::make_unique<expr::SimpleScanSelector>(scan.get())};
-  std::map<std::string, std::unique_ptr<expr::IExpr>> expression_map;
-
+  std::vector<ColumnDelta> deltas;
   for (const auto& [field_name, expr_tree] : query.sets) {
-    expression_map.emplace(field_name, conv.ConvertExprTreeToIExpr(expr_tree));
+    auto& delta = deltas.emplace_back(ColumnDelta{
+        .field_name = field_name,
+        .expr = conv.ConvertExprTreeToIExpr(expr_tree),
+        .values = {},
+        .referenced = IsReferencedOnUpdate(db, query.table_name, field_name),
+        .old_values = {}});
+    ResetTypedColumn(delta.values, schema.field_info(field_name).type());
   }
 
-  std::vector<std::map<std::string, core::FieldVariant>> updated_values;
+  std::vector<size_t> row_ids;
+  const core::FieldKeyEqual equal;
   while (scan->Next()) {
-    std::map<std::string, core::FieldVariant> row;
-    for (const auto& [field_name, expr] : expression_map) {
-      auto value = expr->Eval();
-      const auto field_info = schema.field_info(field_name);
-      util::ValidateType(schema.MayBeNull(field_name), field_info, value);
-      if (schema.IsUnique(field_name)) {
-        util::CheckUniquenessConstraint(db, query.table_name, field_name,
-                                        value);
+    row_ids.push_back(row_id());
+    for (auto& delta : deltas) {
+      auto value = delta.expr->Eval();
+      const auto field_info = schema.field_info(delta.field_name);
+      util::ValidateType(schema.MayBeNull(delta.field_name), field_info,
+                         value);
+      value = util::NormalizeFieldVariant(field_info.type(), value);
+      if (delta.referenced) {
+        auto old_value = scan->GetField(delta.field_name);
+        if (!equal(old_value, value)) {
+          delta.old_values.insert(std::move(old_value));
+        }
       }
-      util::CheckForeignKeyConstraint(db, query.table_name, field_name,
-                                      scan->GetField(field_name),
-                                      util::Action::Update);
-      row.emplace(field_name,
-                  util::NormalizeFieldVariant(field_info.type(), value));
+      delta.values.Append(value);
     }
-    updated_values.emplace_back(std::move(row));
   }
-  scan->BeforeFirst();
-  auto it = updated_values.begin();
-  while (scan->Next()) {
-    for (const auto& [field_name, value] : *it) {
-      scan->SetField(field_name, value);
+
+  const std::unordered_set<size_t> updated_rows(row_ids.begin(),
+                                                row_ids.end());
+  for (const auto& delta : deltas) {
+    if (schema.IsUnique(delta.field_name)) {
+      CheckUniqueness(db, query.table_name, delta, updated_rows);
+    }
+    CheckForeignKeys(db, query.table_name, delta);
+  }
+
+  auto table = db.GetTableScan(query.table_name);
+  ChangeBatch changes{db};
+  for (size_t i = 0; i < row_ids.size(); ++i) {
+    if (!table->MoveToRowId(row_ids[i])) {
+      continue;
+    }
+    for (const auto& delta : deltas) {
+      table->SetField(delta.field_name, delta.values.Get(i));
     }
-    ++it;
+    changes.PutRow(query.table_name, row_ids[i]);
   }
+  changes.Commit();
 }
 
-}  // namespace deadfood::exec
\ No newline at end of file
+}  // namespace deadfood::exec
@@ -0,0 +1,22 @@
+#include "vacuum.hh"
+
+#include <stdexcept>
+
+namespace deadfood::exec {
+
+void ExecuteVacuumQuery(Database& db,
+                        const std::optional<std::string>& table_name) {
+  if (!table_name.has_value()) {
+    for (const auto& name : db.table_names()) {
+      db.table_storage(name).Compact();
+    }
+    return;
+  }
+  if (!db.Exists(table_name.value())) {
+    throw std::runtime_error("table `" + table_name.value() +
+                             "` does not exist");
+  }
+  db.table_storage(table_name.value()).Compact();
+}
+
+}  // namespace deadfood::exec
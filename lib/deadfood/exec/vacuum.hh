@@ -0,0 +1,14 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include <deadfood/database.hh>
+
+namespace deadfood::exec {
+
+// reclaims the slots of the deleted rows of `table_name`, or of every table
+void ExecuteVacuumQuery(Database& db,
+                        const std::optional<std::string>& table_name);
+
+}  // namespace deadfood::exec
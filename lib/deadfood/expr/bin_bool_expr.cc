@@ -6,17 +6,16 @@ BinBoolExpr::BinBoolExpr(BinBoolOp op, std::unique_ptr<IExpr> lhs,
                          std::unique_ptr<IExpr> rhs)
     : op_{op}, lhs_{BoolExpr(std::move(lhs))}, rhs_{BoolExpr(std::move(rhs))} {}
 
-core::FieldVariant BinBoolExpr::Eval() {
-  const auto left_eval = lhs_.Eval();
-  const auto right_eval = rhs_.Eval();
-
+core::FieldVariant CombineValues(BinBoolOp op,
+                                 const core::FieldVariant& left_eval,
+                                 const core::FieldVariant& right_eval) {
   if (std::holds_alternative<core::null_t>(left_eval) &&
       std::holds_alternative<core::null_t>(right_eval)) {
     return core::null_t{};
   }
 
   if (std::holds_alternative<core::null_t>(left_eval)) {
-    switch (op_) {
+    switch (op) {
       case BinBoolOp::Xor:
       case BinBoolOp::And:
         return core::null_t{};
@@ -26,7 +25,7 @@ core::FieldVariant BinBoolExpr::Eval() {
   }
 
   if (std::holds_alternative<core::null_t>(right_eval)) {
-    switch (op_) {
+    switch (op) {
       case BinBoolOp::Xor:
       case BinBoolOp::And:
         return core::null_t{};
@@ -37,7 +36,7 @@ core::FieldVariant BinBoolExpr::Eval() {
 
   const auto left = std::get<bool>(left_eval);
   const auto right = std::get<bool>(right_eval);
-  switch (op_) {
+  switch (op) {
     case BinBoolOp::And:
       return left && right;
     case BinBoolOp::Or:
@@ -47,4 +46,53 @@ core::FieldVariant BinBoolExpr::Eval() {
   }
 }
 
+
+core::FieldVariant BinBoolExpr::Eval() {
+  const auto left_eval = lhs_.Eval();
+  const auto right_eval = rhs_.Eval();
+  return CombineValues(op_, left_eval, right_eval);
+}
+
+bool BinBoolExpr::SupportsBatch() const {
+  return lhs_.SupportsBatch() && rhs_.SupportsBatch();
+}
+
+const scan::ColumnVector& BinBoolExpr::EvalBatch(
+    const scan::ColumnBatch& batch, scan::ColumnVector& scratch) {
+  const auto& lhs = lhs_.EvalBatch(batch, lhs_scratch_);
+  const auto& rhs = rhs_.EvalBatch(batch, rhs_scratch_);
+  scratch.ResetTyped<uint8_t>(batch.size());
+  const auto& selection = batch.selection();
+
+  if (!lhs.HasNulls() && !rhs.HasNulls()) {
+    const auto& left = *lhs.typed<uint8_t>();
+    const auto& right = *rhs.typed<uint8_t>();
+    auto& out = *scratch.typed<uint8_t>();
+    for (const auto row : selection) {
+      switch (op_) {
+        case BinBoolOp::And:
+          out[row] = static_cast<uint8_t>(left[row] & right[row]);
+          break;
+        case BinBoolOp::Or:
+          out[row] = static_cast<uint8_t>(left[row] | right[row]);
+          break;
+        case BinBoolOp::Xor:
+          out[row] = static_cast<uint8_t>(left[row] ^ right[row]);
+          break;
+      }
+    }
+    return scratch;
+  }
+
+  for (const auto row : selection) {
+    scratch.Set(row, CombineValues(op_, lhs.Get(row), rhs.Get(row)));
+  }
+  return scratch;
+}
+
+void BinBoolExpr::CollectFieldNames(std::vector<std::string>& names) const {
+  lhs_.CollectFieldNames(names);
+  rhs_.CollectFieldNames(names);
+}
+
 }  // namespace deadfood::expr
\ No newline at end of file
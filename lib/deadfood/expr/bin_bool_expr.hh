@@ -13,11 +13,17 @@ class BinBoolExpr : public IExpr {
               std::unique_ptr<IExpr> rhs);
 
   core::FieldVariant Eval() override;
+  [[nodiscard]] bool SupportsBatch() const override;
+  const scan::ColumnVector& EvalBatch(const scan::ColumnBatch& batch,
+                                      scan::ColumnVector& scratch) override;
+  void CollectFieldNames(std::vector<std::string>& names) const override;
 
  private:
   BinBoolOp op_;
   BoolExpr lhs_;
   BoolExpr rhs_;
+  scan::ColumnVector lhs_scratch_;
+  scan::ColumnVector rhs_scratch_;
 };
 
 }  // namespace deadfood::expr
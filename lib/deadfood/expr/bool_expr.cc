@@ -1,12 +1,14 @@
 #include "bool_expr.hh"
 
+#include <deadfood/expr/typed_expr.hh>
+
 namespace deadfood::expr {
 
 BoolExpr::BoolExpr(std::unique_ptr<IExpr> internal)
-    : internal_{std::move(internal)} {}
+    : internal_{std::move(internal)},
+      compiled_{dynamic_cast<CompiledExpr*>(internal_.get())} {}
 
-core::FieldVariant BoolExpr::Eval() {
-  const auto val = internal_->Eval();
+core::FieldVariant ToBool(const core::FieldVariant& val) {
   return std::visit(
       [](auto&& arg) -> core::FieldVariant {
         using T = std::decay_t<decltype(arg)>;
@@ -23,4 +25,35 @@ core::FieldVariant BoolExpr::Eval() {
       val);
 }
 
+
+core::FieldVariant BoolExpr::Eval() { return ToBool(internal_->Eval()); }
+
+bool BoolExpr::IsTrue() {
+  if (compiled_ != nullptr) {
+    return compiled_->IsTrue();
+  }
+  const auto value = Eval();
+  return !std::holds_alternative<core::null_t>(value) && std::get<bool>(value);
+}
+
+bool BoolExpr::SupportsBatch() const { return internal_->SupportsBatch(); }
+
+const scan::ColumnVector& BoolExpr::EvalBatch(const scan::ColumnBatch& batch,
+                                              scan::ColumnVector& scratch) {
+  const auto& internal = internal_->EvalBatch(batch, internal_scratch_);
+  // the result is always a typed boolean column, which it may already be
+  if (internal.typed<uint8_t>() != nullptr) {
+    return internal;
+  }
+  scratch.ResetTyped<uint8_t>(batch.size());
+  for (const auto row : batch.selection()) {
+    scratch.Set(row, ToBool(internal.Get(row)));
+  }
+  return scratch;
+}
+
+void BoolExpr::CollectFieldNames(std::vector<std::string>& names) const {
+  internal_->CollectFieldNames(names);
+}
+
 }  // namespace deadfood::expr
\ No newline at end of file
@@ -4,14 +4,25 @@
 
 namespace deadfood::expr {
 
+class CompiledExpr;
+
 class BoolExpr : public IExpr {
  public:
   explicit BoolExpr(std::unique_ptr<IExpr> internal);
 
   core::FieldVariant Eval() override;
+  // true if the value is true, NULL counts as false; skips boxing the value
+  // when the internal expression is compiled
+  bool IsTrue();
+  [[nodiscard]] bool SupportsBatch() const override;
+  const scan::ColumnVector& EvalBatch(const scan::ColumnBatch& batch,
+                                      scan::ColumnVector& scratch) override;
+  void CollectFieldNames(std::vector<std::string>& names) const override;
 
  private:
   std::unique_ptr<IExpr> internal_;
+  CompiledExpr* compiled_;
+  scan::ColumnVector internal_scratch_;
 };
 
 }  // namespace deadfood::expr
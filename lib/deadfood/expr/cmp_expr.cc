@@ -1,5 +1,10 @@
 #include "cmp_expr.hh"
 
+#include <limits>
+
+#include <deadfood/expr/cmp_kernels.hh>
+#include <deadfood/expr/const_expr.hh>
+
 namespace deadfood::expr {
 
 CmpExpr::CmpExpr(CmpOp op, std::unique_ptr<IExpr> lhs,
@@ -66,20 +71,18 @@ bool CompareVarcharLe(const std::string& left, const std::string& right) {
   return true;
 }
 
-core::FieldVariant CmpExpr::Eval() {
-  const auto lhs = lhs_->Eval();
-  const auto rhs = rhs_->Eval();
-
+bool CompareValues(CmpOp op, const core::FieldVariant& lhs,
+                   const core::FieldVariant& rhs) {
   return std::visit(
       [&](auto&& left) {
         using T = std::decay_t<decltype(left)>;
         if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, int> ||
                       std::is_same_v<T, float> || std::is_same_v<T, double>) {
-          return CompareTrivial(left, op_, rhs);
+          return CompareTrivial(left, op, rhs);
         } else if constexpr (std::is_same_v<T, std::string>) {
           if (std::holds_alternative<std::string>(rhs)) {
             const auto right = std::get<std::string>(rhs);
-            switch (op_) {
+            switch (op) {
               case CmpOp::Eq:
                 return CompareVarcharEq(left, right);
               case CmpOp::Le:
@@ -95,4 +98,170 @@ core::FieldVariant CmpExpr::Eval() {
       lhs);
 }
 
+core::FieldVariant CmpExpr::Eval() {
+  const auto lhs = lhs_->Eval();
+  const auto rhs = rhs_->Eval();
+  return CompareValues(op_, lhs, rhs);
+}
+
+bool CmpExpr::SupportsBatch() const {
+  return lhs_->SupportsBatch() && rhs_->SupportsBatch();
+}
+
+// Converts a numeric constant to the element type of a column if that does
+// not change its value, so comparing in `T` gives what the scalar path
+// computes in the wider of both types.
+template <typename T>
+std::optional<T> ExactConstant(const core::FieldVariant& value) {
+  return std::visit(
+      [](auto&& arg) -> std::optional<T> {
+        using A = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<A, std::string> ||
+                      std::is_same_v<A, core::null_t>) {
+          return std::nullopt;
+        } else {
+          const auto wide = static_cast<double>(arg);
+          if constexpr (std::is_same_v<T, uint8_t>) {
+            if (wide != 0 && wide != 1) {
+              return std::nullopt;
+            }
+          } else if (!(wide >= static_cast<double>(
+                                   std::numeric_limits<T>::lowest()) &&
+                       wide <= static_cast<double>(
+                                   std::numeric_limits<T>::max()))) {
+            return std::nullopt;
+          }
+          const auto narrow = static_cast<T>(arg);
+          if (static_cast<double>(narrow) != wide) {
+            return std::nullopt;
+          }
+          return narrow;
+        }
+      },
+      value);
+}
+
+// Compares a typed column with a constant. The column may hold NULLs, which
+// compare false against any non-NULL constant.
+template <typename T>
+bool CompareColumnWithConstant(KernelCmp cmp, const scan::ColumnVector& column,
+                               const core::FieldVariant& constant, size_t size,
+                               std::vector<uint8_t>& out) {
+  const auto* values = column.typed<T>();
+  if (values == nullptr) {
+    return false;
+  }
+  const auto scalar = ExactConstant<T>(constant);
+  if (!scalar.has_value()) {
+    return false;
+  }
+  CompareArrayScalar(cmp, values->data(), scalar.value(), size, out.data());
+  return true;
+}
+
+template <typename T>
+bool CompareColumns(KernelCmp cmp, const scan::ColumnVector& lhs,
+                    const scan::ColumnVector& rhs, size_t size,
+                    std::vector<uint8_t>& out) {
+  const auto* left = lhs.typed<T>();
+  const auto* right = rhs.typed<T>();
+  if (left == nullptr || right == nullptr) {
+    return false;
+  }
+  CompareArrays(cmp, left->data(), right->data(), size, out.data());
+  return true;
+}
+
+bool CmpExpr::CompareWithKernels(const scan::ColumnVector& lhs,
+                                 const scan::ColumnVector& rhs, size_t size,
+                                 std::vector<uint8_t>& out) const {
+  const auto* lhs_const = dynamic_cast<const ConstExpr*>(lhs_.get());
+  const auto* rhs_const = dynamic_cast<const ConstExpr*>(rhs_.get());
+  if (lhs_const != nullptr && rhs_const != nullptr) {
+    return false;
+  }
+
+  if (lhs_const == nullptr && rhs_const == nullptr) {
+    if (lhs.HasNulls() || rhs.HasNulls()) {
+      return false;
+    }
+    const auto cmp = op_ == CmpOp::Eq ? KernelCmp::Eq : KernelCmp::Lt;
+    return CompareColumns<int>(cmp, lhs, rhs, size, out) ||
+           CompareColumns<float>(cmp, lhs, rhs, size, out) ||
+           CompareColumns<double>(cmp, lhs, rhs, size, out) ||
+           CompareColumns<uint8_t>(cmp, lhs, rhs, size, out);
+  }
+
+  // `c < column` is evaluated as `column > c`
+  const auto& constant =
+      lhs_const != nullptr ? lhs_const->value() : rhs_const->value();
+  const auto& column = lhs_const != nullptr ? rhs : lhs;
+  // NULL on the right of a number throws in the scalar path
+  if (std::holds_alternative<core::null_t>(constant) ||
+      (lhs_const != nullptr && column.HasNulls())) {
+    return false;
+  }
+  const auto cmp = op_ == CmpOp::Eq       ? KernelCmp::Eq
+                   : lhs_const != nullptr ? KernelCmp::Gt
+                                          : KernelCmp::Lt;
+  if (!CompareColumnWithConstant<int>(cmp, column, constant, size, out) &&
+      !CompareColumnWithConstant<float>(cmp, column, constant, size, out) &&
+      !CompareColumnWithConstant<double>(cmp, column, constant, size, out) &&
+      !CompareColumnWithConstant<uint8_t>(cmp, column, constant, size, out)) {
+    return false;
+  }
+  // a NULL compares false with any number
+  if (column.HasNulls()) {
+    const auto& nulls = column.nulls();
+    for (size_t row = 0; row < size; ++row) {
+      out[row] = static_cast<uint8_t>(out[row] & ~nulls[row]);
+    }
+  }
+  return true;
+}
+
+const scan::ColumnVector& CmpExpr::EvalBatch(const scan::ColumnBatch& batch,
+                                             scan::ColumnVector& scratch) {
+  const auto& lhs = lhs_->EvalBatch(batch, lhs_scratch_);
+  const auto& rhs = rhs_->EvalBatch(batch, rhs_scratch_);
+  scratch.ResetTyped<uint8_t>(batch.size());
+  auto& out = *scratch.typed<uint8_t>();
+  if (CompareWithKernels(lhs, rhs, batch.size(), out)) {
+    return scratch;
+  }
+  const auto& selection = batch.selection();
+
+  // numbers without NULLs are compared in a tight loop
+  const bool done = scan::VisitNumericColumn(lhs, [&](const auto& left) {
+    return scan::VisitNumericColumn(rhs, [&](const auto& right) {
+      using T = decltype(left[0] + right[0]);
+      if (op_ == CmpOp::Eq) {
+        for (const auto row : selection) {
+          out[row] =
+              static_cast<T>(left[row]) == static_cast<T>(right[row]);
+        }
+      } else {
+        for (const auto row : selection) {
+          out[row] =
+              static_cast<T>(left[row]) < static_cast<T>(right[row]);
+        }
+      }
+      return true;
+    });
+  });
+  if (done) {
+    return scratch;
+  }
+
+  for (const auto row : selection) {
+    out[row] = CompareValues(op_, lhs.Get(row), rhs.Get(row));
+  }
+  return scratch;
+}
+
+void CmpExpr::CollectFieldNames(std::vector<std::string>& names) const {
+  lhs_->CollectFieldNames(names);
+  rhs_->CollectFieldNames(names);
+}
+
 }  // namespace deadfood::expr
\ No newline at end of file
@@ -14,11 +14,22 @@ class CmpExpr : public IExpr {
   CmpExpr& operator=(CmpExpr&& other) noexcept;
 
   core::FieldVariant Eval() override;
+  [[nodiscard]] bool SupportsBatch() const override;
+  const scan::ColumnVector& EvalBatch(const scan::ColumnBatch& batch,
+                                      scan::ColumnVector& scratch) override;
+  void CollectFieldNames(std::vector<std::string>& names) const override;
 
  private:
+  // compares with the SIMD kernels if the operand types allow it
+  bool CompareWithKernels(const scan::ColumnVector& lhs,
+                          const scan::ColumnVector& rhs, size_t size,
+                          std::vector<uint8_t>& out) const;
+
   CmpOp op_;
   std::unique_ptr<IExpr> lhs_;
   std::unique_ptr<IExpr> rhs_;
+  scan::ColumnVector lhs_scratch_;
+  scan::ColumnVector rhs_scratch_;
 };
 
 }  // namespace deadfood::expr
@@ -0,0 +1,239 @@
+#include "cmp_kernels.hh"
+
+#include <array>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DEADFOOD_AVX2_KERNELS 1
+#endif
+
+namespace deadfood::expr {
+
+// `rhs(i)` yields the right operand of row i, either an array element or the
+// same scalar for every row
+template <typename T, typename Rhs>
+void CompareLoop(KernelCmp cmp, const T* lhs, Rhs rhs, size_t from, size_t n,
+                 uint8_t* out) {
+  switch (cmp) {
+    case KernelCmp::Eq:
+      for (size_t i = from; i < n; ++i) {
+        out[i] = lhs[i] == rhs(i);
+      }
+      break;
+    case KernelCmp::Lt:
+      for (size_t i = from; i < n; ++i) {
+        out[i] = lhs[i] < rhs(i);
+      }
+      break;
+    case KernelCmp::Gt:
+      for (size_t i = from; i < n; ++i) {
+        out[i] = lhs[i] > rhs(i);
+      }
+      break;
+  }
+}
+
+#ifdef DEADFOOD_AVX2_KERNELS
+
+// kByteMasks[m] holds bit i of m in byte i, i.e. 8 result bytes at once
+constexpr std::array<uint64_t, 256> MakeByteMasks() {
+  std::array<uint64_t, 256> ret{};
+  for (size_t mask = 0; mask < ret.size(); ++mask) {
+    for (size_t bit = 0; bit < 8; ++bit) {
+      ret[mask] |= ((mask >> bit) & 1) << (8 * bit);
+    }
+  }
+  return ret;
+}
+
+constexpr auto kByteMasks = MakeByteMasks();
+
+void StoreMask(int mask, size_t lanes, uint8_t* out) {
+  std::memcpy(out, &kByteMasks[static_cast<size_t>(mask)], lanes);
+}
+
+template <KernelCmp kCmp>
+__attribute__((target("avx2"))) size_t CompareAvx2(
+    const int* lhs, const int* rhs, int scalar, size_t n, uint8_t* out) {
+  const __m256i broadcast = _mm256_set1_epi32(scalar);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i l =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    const __m256i r =
+        rhs == nullptr
+            ? broadcast
+            : _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+    __m256i m;
+    if constexpr (kCmp == KernelCmp::Eq) {
+      m = _mm256_cmpeq_epi32(l, r);
+    } else if constexpr (kCmp == KernelCmp::Lt) {
+      m = _mm256_cmpgt_epi32(r, l);
+    } else {
+      m = _mm256_cmpgt_epi32(l, r);
+    }
+    StoreMask(_mm256_movemask_ps(_mm256_castsi256_ps(m)), 8, out + i);
+  }
+  return i;
+}
+
+template <KernelCmp kCmp>
+__attribute__((target("avx2"))) size_t CompareAvx2(
+    const float* lhs, const float* rhs, float scalar, size_t n, uint8_t* out) {
+  const __m256 broadcast = _mm256_set1_ps(scalar);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256 l = _mm256_loadu_ps(lhs + i);
+    const __m256 r = rhs == nullptr ? broadcast : _mm256_loadu_ps(rhs + i);
+    __m256 m;
+    // ordered predicates: NaN compares false, as in the scalar loop
+    if constexpr (kCmp == KernelCmp::Eq) {
+      m = _mm256_cmp_ps(l, r, _CMP_EQ_OQ);
+    } else if constexpr (kCmp == KernelCmp::Lt) {
+      m = _mm256_cmp_ps(l, r, _CMP_LT_OQ);
+    } else {
+      m = _mm256_cmp_ps(l, r, _CMP_GT_OQ);
+    }
+    StoreMask(_mm256_movemask_ps(m), 8, out + i);
+  }
+  return i;
+}
+
+template <KernelCmp kCmp>
+__attribute__((target("avx2"))) size_t CompareAvx2(
+    const double* lhs, const double* rhs, double scalar, size_t n,
+    uint8_t* out) {
+  const __m256d broadcast = _mm256_set1_pd(scalar);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256d l = _mm256_loadu_pd(lhs + i);
+    const __m256d r = rhs == nullptr ? broadcast : _mm256_loadu_pd(rhs + i);
+    __m256d m;
+    if constexpr (kCmp == KernelCmp::Eq) {
+      m = _mm256_cmp_pd(l, r, _CMP_EQ_OQ);
+    } else if constexpr (kCmp == KernelCmp::Lt) {
+      m = _mm256_cmp_pd(l, r, _CMP_LT_OQ);
+    } else {
+      m = _mm256_cmp_pd(l, r, _CMP_GT_OQ);
+    }
+    StoreMask(_mm256_movemask_pd(m), 4, out + i);
+  }
+  return i;
+}
+
+// bools are 0/1 bytes, so the byte compares already produce the output
+template <KernelCmp kCmp>
+__attribute__((target("avx2"))) size_t CompareAvx2(
+    const uint8_t* lhs, const uint8_t* rhs, uint8_t scalar, size_t n,
+    uint8_t* out) {
+  const __m256i broadcast = _mm256_set1_epi8(static_cast<char>(scalar));
+  const __m256i ones = _mm256_set1_epi8(1);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i l =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+    const __m256i r =
+        rhs == nullptr
+            ? broadcast
+            : _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+    __m256i m;
+    if constexpr (kCmp == KernelCmp::Eq) {
+      m = _mm256_cmpeq_epi8(l, r);
+    } else if constexpr (kCmp == KernelCmp::Lt) {
+      m = _mm256_andnot_si256(l, r);
+    } else {
+      m = _mm256_andnot_si256(r, l);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                        _mm256_and_si256(m, ones));
+  }
+  return i;
+}
+
+bool DetectAvx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+bool SimdKernelsEnabled() {
+#ifdef DEADFOOD_AVX2_KERNELS
+  static const bool enabled = DetectAvx2();
+  return enabled;
+#else
+  return false;
+#endif
+}
+
+// Runs the widest kernel the CPU supports over as much of the input as it
+// covers and finishes the rest with the scalar loop. A null `rhs` means
+// comparing with `scalar`.
+template <typename T>
+void Compare(KernelCmp cmp, const T* lhs, const T* rhs, T scalar, size_t n,
+             uint8_t* out) {
+  size_t from = 0;
+#ifdef DEADFOOD_AVX2_KERNELS
+  if (SimdKernelsEnabled()) {
+    switch (cmp) {
+      case KernelCmp::Eq:
+        from = CompareAvx2<KernelCmp::Eq>(lhs, rhs, scalar, n, out);
+        break;
+      case KernelCmp::Lt:
+        from = CompareAvx2<KernelCmp::Lt>(lhs, rhs, scalar, n, out);
+        break;
+      case KernelCmp::Gt:
+        from = CompareAvx2<KernelCmp::Gt>(lhs, rhs, scalar, n, out);
+        break;
+    }
+  }
+#endif
+  if (rhs == nullptr) {
+    CompareLoop(cmp, lhs, [&](size_t) { return scalar; }, from, n, out);
+  } else {
+    CompareLoop(cmp, lhs, [&](size_t i) { return rhs[i]; }, from, n, out);
+  }
+}
+
+void CompareArrays(KernelCmp cmp, const int* lhs, const int* rhs, size_t n,
+                   uint8_t* out) {
+  Compare(cmp, lhs, rhs, 0, n, out);
+}
+
+void CompareArrays(KernelCmp cmp, const float* lhs, const float* rhs, size_t n,
+                   uint8_t* out) {
+  Compare(cmp, lhs, rhs, 0.0f, n, out);
+}
+
+void CompareArrays(KernelCmp cmp, const double* lhs, const double* rhs,
+                   size_t n, uint8_t* out) {
+  Compare(cmp, lhs, rhs, 0.0, n, out);
+}
+
+void CompareArrays(KernelCmp cmp, const uint8_t* lhs, const uint8_t* rhs,
+                   size_t n, uint8_t* out) {
+  Compare(cmp, lhs, rhs, uint8_t{0}, n, out);
+}
+
+void CompareArrayScalar(KernelCmp cmp, const int* lhs, int rhs, size_t n,
+                        uint8_t* out) {
+  Compare<int>(cmp, lhs, nullptr, rhs, n, out);
+}
+
+void CompareArrayScalar(KernelCmp cmp, const float* lhs, float rhs, size_t n,
+                        uint8_t* out) {
+  Compare<float>(cmp, lhs, nullptr, rhs, n, out);
+}
+
+void CompareArrayScalar(KernelCmp cmp, const double* lhs, double rhs, size_t n,
+                        uint8_t* out) {
+  Compare<double>(cmp, lhs, nullptr, rhs, n, out);
+}
+
+void CompareArrayScalar(KernelCmp cmp, const uint8_t* lhs, uint8_t rhs,
+                        size_t n, uint8_t* out) {
+  Compare<uint8_t>(cmp, lhs, nullptr, rhs, n, out);
+}
+
+}  // namespace deadfood::expr
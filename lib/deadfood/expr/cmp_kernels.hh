@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace deadfood::expr {
+
+enum class KernelCmp { Eq, Lt, Gt };
+
+// Comparison kernels over contiguous arrays: `out[i]` becomes 1 if
+// `lhs[i] <cmp> rhs[i]` (or `rhs` for the scalar variants) holds and 0
+// otherwise, for every i < n. `bool` columns are passed as 0/1 bytes. The
+// implementation is picked once at runtime from what the CPU supports; the
+// scalar loops are used everywhere else.
+void CompareArrays(KernelCmp cmp, const int* lhs, const int* rhs, size_t n,
+                   uint8_t* out);
+void CompareArrays(KernelCmp cmp, const float* lhs, const float* rhs, size_t n,
+                   uint8_t* out);
+void CompareArrays(KernelCmp cmp, const double* lhs, const double* rhs,
+                   size_t n, uint8_t* out);
+void CompareArrays(KernelCmp cmp, const uint8_t* lhs, const uint8_t* rhs,
+                   size_t n, uint8_t* out);
+
+void CompareArrayScalar(KernelCmp cmp, const int* lhs, int rhs, size_t n,
+                        uint8_t* out);
+void CompareArrayScalar(KernelCmp cmp, const float* lhs, float rhs, size_t n,
+                        uint8_t* out);
+void CompareArrayScalar(KernelCmp cmp, const double* lhs, double rhs, size_t n,
+                        uint8_t* out);
+void CompareArrayScalar(KernelCmp cmp, const uint8_t* lhs, uint8_t rhs,
+                        size_t n, uint8_t* out);
+
+// true if the AVX2 kernels are in use on this machine
+bool SimdKernelsEnabled();
+
+}  // namespace deadfood::expr
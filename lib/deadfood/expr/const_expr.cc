@@ -4,6 +4,18 @@ namespace deadfood::expr {
 
 ConstExpr::ConstExpr(const core::FieldVariant& value) : value_{value} {}
 
+const core::FieldVariant& ConstExpr::value() const { return value_; }
+
 deadfood::core::FieldVariant ConstExpr::Eval() { return value_; }
 
+bool ConstExpr::SupportsBatch() const { return true; }
+
+const scan::ColumnVector& ConstExpr::EvalBatch(const scan::ColumnBatch& batch,
+                                               scan::ColumnVector& scratch) {
+  scratch.Fill(batch.size(), value_);
+  return scratch;
+}
+
+void ConstExpr::CollectFieldNames(std::vector<std::string>&) const {}
+
 }  // namespace deadfood::expr
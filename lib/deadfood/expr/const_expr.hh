@@ -8,7 +8,13 @@ class ConstExpr : public IExpr {
  public:
   explicit ConstExpr(const core::FieldVariant& value);
 
+  [[nodiscard]] const core::FieldVariant& value() const;
+
   core::FieldVariant Eval() override;
+  [[nodiscard]] bool SupportsBatch() const override;
+  const scan::ColumnVector& EvalBatch(const scan::ColumnBatch& batch,
+                                      scan::ColumnVector& scratch) override;
+  void CollectFieldNames(std::vector<std::string>& names) const override;
 
  private:
   core::FieldVariant value_;
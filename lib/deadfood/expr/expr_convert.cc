@@ -7,6 +7,7 @@
 #include <deadfood/expr/const_expr.hh>
 #include <deadfood/expr/bin_bool_expr.hh>
 #include <deadfood/expr/math_expr.hh>
+#include <deadfood/expr/typed_expr.hh>
 
 namespace deadfood::expr {
 
@@ -64,7 +65,7 @@ struct ExprTreeConverterVisitor {
         RaiseIfNotBinFactors(expr.factors);
         {
           auto conv = [&](size_t idx) {
-            return expr_tree_converter.ConvertExprTreeToIExpr(
+            return expr_tree_converter.ConvertInterpreted(
                 expr.factors[idx]);
           };
           const size_t left_idx = expr.op == GenBinOp::LE ? 0 : 1;
@@ -81,8 +82,8 @@ struct ExprTreeConverterVisitor {
         RaiseIfNotBinFactors(expr.factors);
         {
           auto ret = std::make_unique<IsExpr>(
-              expr_tree_converter.ConvertExprTreeToIExpr(expr.factors[0]),
-              expr_tree_converter.ConvertExprTreeToIExpr(expr.factors[1]));
+              expr_tree_converter.ConvertInterpreted(expr.factors[0]),
+              expr_tree_converter.ConvertInterpreted(expr.factors[1]));
           if (expr.op == GenBinOp::IsNot) {
             return std::make_unique<NotExpr>(std::move(ret));
           }
@@ -100,18 +101,24 @@ struct ExprTreeConverterVisitor {
         [&](auto&& arg) -> core::FieldVariant { return arg; }, constant);
     return std::make_unique<ConstExpr>(std::move(var));
   }
+  std::unique_ptr<IExpr> operator()(const ExprAggregate& /*aggregate*/) {
+    // the select planner replaces aggregates with the fields of the
+    // aggregation, anything left is misplaced
+    throw std::runtime_error(
+        "aggregate functions are only allowed in the select list and HAVING");
+  }
 
  private:
   std::unique_ptr<IExpr> GetBinBoolExpr(const std::vector<FactorTree>& factors,
                                         BinBoolOp op) {
     std::unique_ptr<IExpr> ret = std::make_unique<BinBoolExpr>(
-        op, expr_tree_converter.ConvertExprTreeToIExpr(factors[0]),
-        expr_tree_converter.ConvertExprTreeToIExpr(factors[1]));
+        op, expr_tree_converter.ConvertInterpreted(factors[0]),
+        expr_tree_converter.ConvertInterpreted(factors[1]));
 
     for (size_t i = 2; i < factors.size(); ++i) {
       std::unique_ptr<IExpr> tmp = std::make_unique<BinBoolExpr>(
           op, std::move(ret),
-          expr_tree_converter.ConvertExprTreeToIExpr(factors[i]));
+          expr_tree_converter.ConvertInterpreted(factors[i]));
       ret = std::move(tmp);
     }
     return ret;
@@ -119,12 +126,12 @@ struct ExprTreeConverterVisitor {
   std::unique_ptr<IExpr> GetMathExpr(const std::vector<FactorTree>& factors,
                                      MathExprOp op) {
     std::unique_ptr<IExpr> ret = std::make_unique<MathExpr>(
-        op, expr_tree_converter.ConvertExprTreeToIExpr(factors[0]),
-        expr_tree_converter.ConvertExprTreeToIExpr(factors[1]));
+        op, expr_tree_converter.ConvertInterpreted(factors[0]),
+        expr_tree_converter.ConvertInterpreted(factors[1]));
     for (size_t i = 2; i < factors.size(); ++i) {
       std::unique_ptr<IExpr> tmp = std::make_unique<MathExpr>(
           op, std::move(ret),
-          expr_tree_converter.ConvertExprTreeToIExpr(factors[i]));
+          expr_tree_converter.ConvertInterpreted(factors[i]));
       ret = std::move(tmp);
     }
     return ret;
@@ -134,13 +141,29 @@ struct ExprTreeConverterVisitor {
       const std::vector<FactorTree>& factors, CmpOp op, size_t lhs_idx,
       size_t rhs_idx) {
     return std::make_unique<CmpExpr>(
-        op, expr_tree_converter.ConvertExprTreeToIExpr(factors[lhs_idx]),
-        expr_tree_converter.ConvertExprTreeToIExpr(factors[rhs_idx]));
+        op, expr_tree_converter.ConvertInterpreted(factors[lhs_idx]),
+        expr_tree_converter.ConvertInterpreted(factors[rhs_idx]));
   }
 };
 
 std::unique_ptr<IExpr> ExprTreeConverter::ConvertExprTreeToIExpr(
     const FactorTree& tree) {
+  auto interpreted = ConvertInterpreted(tree);
+  // a lone field or constant gains nothing from compiling
+  if (!std::holds_alternative<ExprTree>(tree.factor) && !tree.neg_applied &&
+      !tree.not_applied) {
+    return interpreted;
+  }
+  auto compiled = CompileTyped(tree, *get_table_scan_);
+  if (!compiled.has_value()) {
+    return interpreted;
+  }
+  return std::make_unique<CompiledExpr>(std::move(compiled.value()),
+                                        std::move(interpreted));
+}
+
+std::unique_ptr<IExpr> ExprTreeConverter::ConvertInterpreted(
+    const FactorTree& tree) {
   auto vis = ExprTreeConverterVisitor{get_table_scan_.get(), *this};
   auto expr = std::visit(vis, tree.factor);
   if (tree.neg_applied) {
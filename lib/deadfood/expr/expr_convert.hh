@@ -11,7 +11,10 @@ class ExprTreeConverter {
  public:
   explicit ExprTreeConverter(std::unique_ptr<IScanSelector> scan);
 
+  // Compiles the tree into typed evaluators where its types allow it and
+  // falls back to the interpreted expressions otherwise.
   std::unique_ptr<IExpr> ConvertExprTreeToIExpr(const FactorTree& tree);
+  std::unique_ptr<IExpr> ConvertInterpreted(const FactorTree& tree);
 
  private:
   std::unique_ptr<IScanSelector> get_table_scan_;
@@ -38,10 +38,18 @@ struct ExprId {
   std::string id;
 };
 
+enum class AggregateFn { Count, Sum, Min, Max, Avg };
+
+// a call of an aggregate function, `args` is empty for COUNT(*)
+struct ExprAggregate {
+  AggregateFn fn;
+  std::vector<FactorTree> args;
+};
+
 struct FactorTree {
   bool neg_applied;
   bool not_applied;
-  std::variant<ExprTree, ExprId, Constant> factor;
+  std::variant<ExprTree, ExprId, Constant, ExprAggregate> factor;
 };
 
 }  // namespace deadfood::expr
\ No newline at end of file
@@ -3,8 +3,31 @@
 namespace deadfood::expr {
 
 FieldExpr::FieldExpr(scan::IScan* scan, const std::string& field_name)
-    : scan_{scan}, field_name_{field_name} {}
+    : scan_{scan},
+      field_name_{field_name},
+      binding_{scan != nullptr ? scan->BindField(field_name) : std::nullopt} {}
 
-core::FieldVariant FieldExpr::Eval() { return scan_->GetField(field_name_); }
+core::FieldVariant FieldExpr::Eval() {
+  if (binding_.has_value()) {
+    return scan::ReadField(binding_.value());
+  }
+  return scan_->GetField(field_name_);
+}
+
+bool FieldExpr::SupportsBatch() const { return true; }
+
+const scan::ColumnVector& FieldExpr::EvalBatch(const scan::ColumnBatch& batch,
+                                               scan::ColumnVector&) {
+  const auto idx = batch.FieldIndex(field_name_);
+  if (!idx.has_value()) {
+    throw std::runtime_error("no field with name '" + field_name_ +
+                             "' in batch");
+  }
+  return batch.column(idx.value());
+}
+
+void FieldExpr::CollectFieldNames(std::vector<std::string>& names) const {
+  names.emplace_back(field_name_);
+}
 
 }  // namespace deadfood::expr
\ No newline at end of file
@@ -1,21 +1,30 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 
 #include <deadfood/scan/iscan.hh>
 #include <deadfood/expr/iexpr.hh>
 
 namespace deadfood::expr {
 
+// Reads a field of `scan`. The reference is bound to its table column when
+// the expression is built, so evaluation is a direct typed read whenever the
+// field comes from a table.
 class FieldExpr : public IExpr {
  public:
   FieldExpr(scan::IScan* scan, const std::string& field_name);
 
   core::FieldVariant Eval() override;
+  [[nodiscard]] bool SupportsBatch() const override;
+  const scan::ColumnVector& EvalBatch(const scan::ColumnBatch& batch,
+                                      scan::ColumnVector& scratch) override;
+  void CollectFieldNames(std::vector<std::string>& names) const override;
 
  private:
   scan::IScan* scan_;
   std::string field_name_;
+  std::optional<scan::FieldBinding> binding_;
 };
 
 }  // namespace deadfood::expr
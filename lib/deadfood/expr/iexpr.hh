@@ -1,6 +1,11 @@
 #pragma once
 
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include <deadfood/core/field.hh>
+#include <deadfood/scan/column_batch.hh>
 
 namespace deadfood::expr {
 
@@ -8,6 +13,18 @@ class IExpr {
  public:
   virtual core::FieldVariant Eval() = 0;
 
+  // Batch evaluation reads fields from the columns of `batch`, looked up by
+  // the names the expression was built with, instead of from a scan. The
+  // result holds one value per physical row of the batch, only the selected
+  // rows are meaningful. It is either `scratch` or a column of `batch`.
+  [[nodiscard]] virtual bool SupportsBatch() const { return false; }
+  virtual const scan::ColumnVector& EvalBatch(const scan::ColumnBatch&,
+                                              scan::ColumnVector&) {
+    throw std::runtime_error("expression cannot be evaluated on batches");
+  }
+  // appends the names of the fields the expression reads
+  virtual void CollectFieldNames(std::vector<std::string>&) const {}
+
   virtual ~IExpr() = default;
 };
 
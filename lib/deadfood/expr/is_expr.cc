@@ -5,9 +5,7 @@ namespace deadfood::expr {
 IsExpr::IsExpr(std::unique_ptr<IExpr> lhs, std::unique_ptr<IExpr> rhs)
     : lhs_{std::move(lhs)}, rhs_{std::move(rhs)} {}
 
-core::FieldVariant IsExpr::Eval() {
-  const auto left = lhs_->Eval();
-  const auto right = rhs_->Eval();
+bool IsValues(const core::FieldVariant& left, const core::FieldVariant& right) {
   return std::visit(
       [&](auto&& left_arg) {
         return std::visit(
@@ -28,4 +26,32 @@ core::FieldVariant IsExpr::Eval() {
       left);
 }
 
+
+core::FieldVariant IsExpr::Eval() {
+  const auto left = lhs_->Eval();
+  const auto right = rhs_->Eval();
+  return IsValues(left, right);
+}
+
+bool IsExpr::SupportsBatch() const {
+  return lhs_->SupportsBatch() && rhs_->SupportsBatch();
+}
+
+const scan::ColumnVector& IsExpr::EvalBatch(const scan::ColumnBatch& batch,
+                                            scan::ColumnVector& scratch) {
+  const auto& lhs = lhs_->EvalBatch(batch, lhs_scratch_);
+  const auto& rhs = rhs_->EvalBatch(batch, rhs_scratch_);
+  scratch.ResetTyped<uint8_t>(batch.size());
+  auto& out = *scratch.typed<uint8_t>();
+  for (const auto row : batch.selection()) {
+    out[row] = IsValues(lhs.Get(row), rhs.Get(row));
+  }
+  return scratch;
+}
+
+void IsExpr::CollectFieldNames(std::vector<std::string>& names) const {
+  lhs_->CollectFieldNames(names);
+  rhs_->CollectFieldNames(names);
+}
+
 }  // namespace deadfood::expr
\ No newline at end of file
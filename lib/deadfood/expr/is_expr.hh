@@ -8,10 +8,16 @@ class IsExpr : public IExpr {
  public:
   IsExpr(std::unique_ptr<IExpr> lhs, std::unique_ptr<IExpr> rhs);
   core::FieldVariant Eval() override;
+  [[nodiscard]] bool SupportsBatch() const override;
+  const scan::ColumnVector& EvalBatch(const scan::ColumnBatch& batch,
+                                      scan::ColumnVector& scratch) override;
+  void CollectFieldNames(std::vector<std::string>& names) const override;
 
  private:
   std::unique_ptr<IExpr> lhs_;
   std::unique_ptr<IExpr> rhs_;
+  scan::ColumnVector lhs_scratch_;
+  scan::ColumnVector rhs_scratch_;
 };
 
 }  // namespace deadfood
@@ -19,10 +19,8 @@ bool IsNumber(const core::FieldVariant& variant) {
       variant);
 }
 
-core::FieldVariant MathExpr::Eval() {
-  auto lhs = lhs_->Eval();
-  auto rhs = rhs_->Eval();
-
+core::FieldVariant ComputeValues(MathExprOp op, const core::FieldVariant& lhs,
+                                 const core::FieldVariant& rhs) {
   return std::visit(
       [&](auto&& lhs_arg) -> core::FieldVariant {
         using L = std::decay_t<decltype(lhs_arg)>;
@@ -34,7 +32,7 @@ core::FieldVariant MathExpr::Eval() {
                 return core::null_t{};
               } else if constexpr (deadfood::util::IsNumberT<L>::value &&
                                    deadfood::util::IsNumberT<R>::value) {
-                switch (op_) {
+                switch (op) {
                   case MathExprOp::Plus:
                     return lhs_arg + rhs_arg;
                   case MathExprOp::Minus:
@@ -46,7 +44,7 @@ core::FieldVariant MathExpr::Eval() {
                 }
               } else if constexpr (std::is_same_v<L, std::string> &&
                                    std::is_same_v<R, std::string>) {
-                switch (op_) {
+                switch (op) {
                   case MathExprOp::Plus:
                     return lhs_arg + rhs_arg;
                   case MathExprOp::Minus:
@@ -66,4 +64,65 @@ core::FieldVariant MathExpr::Eval() {
       },
       lhs);
 }
+
+core::FieldVariant MathExpr::Eval() {
+  const auto lhs = lhs_->Eval();
+  const auto rhs = rhs_->Eval();
+  return ComputeValues(op_, lhs, rhs);
+}
+
+bool MathExpr::SupportsBatch() const {
+  return lhs_->SupportsBatch() && rhs_->SupportsBatch();
+}
+
+const scan::ColumnVector& MathExpr::EvalBatch(const scan::ColumnBatch& batch,
+                                              scan::ColumnVector& scratch) {
+  const auto& lhs = lhs_->EvalBatch(batch, lhs_scratch_);
+  const auto& rhs = rhs_->EvalBatch(batch, rhs_scratch_);
+  const auto& selection = batch.selection();
+
+  // numbers without NULLs: the result has the type the scalar path produces
+  const bool done = scan::VisitNumericColumn(lhs, [&](const auto& left) {
+    return scan::VisitNumericColumn(rhs, [&](const auto& right) {
+      using T = decltype(left[0] + right[0]);
+      scratch.ResetTyped<T>(batch.size());
+      auto& out = *scratch.typed<T>();
+      for (const auto row : selection) {
+        switch (op_) {
+          case MathExprOp::Plus:
+            out[row] =
+                static_cast<T>(left[row]) + static_cast<T>(right[row]);
+            break;
+          case MathExprOp::Minus:
+            out[row] =
+                static_cast<T>(left[row]) - static_cast<T>(right[row]);
+            break;
+          case MathExprOp::Mul:
+            out[row] =
+                static_cast<T>(left[row]) * static_cast<T>(right[row]);
+            break;
+          case MathExprOp::Div:
+            out[row] =
+                static_cast<T>(left[row]) / static_cast<T>(right[row]);
+            break;
+        }
+      }
+      return true;
+    });
+  });
+  if (done) {
+    return scratch;
+  }
+
+  scratch.ResetGeneric(batch.size());
+  for (const auto row : selection) {
+    scratch.Set(row, ComputeValues(op_, lhs.Get(row), rhs.Get(row)));
+  }
+  return scratch;
+}
+
+void MathExpr::CollectFieldNames(std::vector<std::string>& names) const {
+  lhs_->CollectFieldNames(names);
+  rhs_->CollectFieldNames(names);
+}
 }  // namespace deadfood::expr
\ No newline at end of file
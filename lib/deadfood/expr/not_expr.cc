@@ -13,4 +13,26 @@ core::FieldVariant NotExpr::Eval() {
   return !std::get<bool>(value);
 }
 
+bool NotExpr::SupportsBatch() const { return internal_.SupportsBatch(); }
+
+const scan::ColumnVector& NotExpr::EvalBatch(const scan::ColumnBatch& batch,
+                                             scan::ColumnVector& scratch) {
+  const auto& internal = internal_.EvalBatch(batch, internal_scratch_);
+  const auto& values = *internal.typed<uint8_t>();
+  scratch.ResetTyped<uint8_t>(batch.size());
+  auto& out = *scratch.typed<uint8_t>();
+  for (const auto row : batch.selection()) {
+    if (internal.IsNull(row)) {
+      scratch.SetNull(row);
+    } else {
+      out[row] = !values[row];
+    }
+  }
+  return scratch;
+}
+
+void NotExpr::CollectFieldNames(std::vector<std::string>& names) const {
+  internal_.CollectFieldNames(names);
+}
+
 }  // namespace deadfood::expr
\ No newline at end of file
@@ -10,10 +10,15 @@ class NotExpr : public IExpr {
   explicit NotExpr(std::unique_ptr<IExpr> internal);
 
   core::FieldVariant Eval() override;
+  [[nodiscard]] bool SupportsBatch() const override;
+  const scan::ColumnVector& EvalBatch(const scan::ColumnBatch& batch,
+                                      scan::ColumnVector& scratch) override;
+  void CollectFieldNames(std::vector<std::string>& names) const override;
 
  private:
   BoolExpr internal_;
 
+  scan::ColumnVector internal_scratch_;
 };
 
 }  // namespace deadfood
@@ -0,0 +1,552 @@
+#include "typed_expr.hh"
+
+#include <type_traits>
+
+#include <deadfood/expr/bin_bool_expr.hh>
+#include <deadfood/expr/cmp_expr.hh>
+#include <deadfood/expr/math_expr.hh>
+#include <deadfood/scan/field_binding.hh>
+
+namespace deadfood::expr {
+
+// Operands are combined in the type C++ would use for `lhs + rhs`, which is
+// what the interpreted expressions get from operating on the variant values.
+template <typename L, typename R>
+using CommonT = decltype(std::declval<L>() + std::declval<R>());
+
+template <typename To, typename From>
+To Widen(From value) {
+  if constexpr (std::is_same_v<To, From>) {
+    return value;
+  } else {
+    return static_cast<To>(value);
+  }
+}
+
+template <CmpOp kOp, typename T>
+bool Compare(T lhs, T rhs) {
+  if constexpr (kOp == CmpOp::Eq) {
+    return lhs == rhs;
+  } else {
+    return lhs < rhs;
+  }
+}
+
+template <MathExprOp kOp, typename T>
+T Compute(T lhs, T rhs) {
+  if constexpr (kOp == MathExprOp::Plus) {
+    return lhs + rhs;
+  } else if constexpr (kOp == MathExprOp::Minus) {
+    return lhs - rhs;
+  } else if constexpr (kOp == MathExprOp::Mul) {
+    return lhs * rhs;
+  } else {
+    return lhs / rhs;
+  }
+}
+
+[[noreturn]] void ThrowNullRhs() {
+  throw std::runtime_error("cannot compare number and not number");
+}
+
+template <typename T>
+class ConstNode : public TypedExpr<T> {
+ public:
+  explicit ConstNode(T value) : value_{value} {}
+
+  bool Eval(T& out) override {
+    out = value_;
+    return true;
+  }
+
+  [[nodiscard]] T value() const { return value_; }
+
+ private:
+  T value_;
+};
+
+template <typename T>
+class FieldNode : public TypedExpr<T> {
+ public:
+  explicit FieldNode(scan::FieldBinding binding)
+      : binding_{std::move(binding)} {}
+
+  bool Eval(T& out) override { return scan::ReadFieldAs(binding_, out); }
+
+  [[nodiscard]] const scan::FieldBinding& binding() const { return binding_; }
+
+ private:
+  scan::FieldBinding binding_;
+};
+
+template <typename L, typename R, MathExprOp kOp>
+class MathNode : public TypedExpr<CommonT<L, R>> {
+ public:
+  using T = CommonT<L, R>;
+
+  MathNode(std::unique_ptr<TypedExpr<L>> lhs,
+           std::unique_ptr<TypedExpr<R>> rhs)
+      : lhs_{std::move(lhs)}, rhs_{std::move(rhs)} {}
+
+  bool Eval(T& out) override {
+    L lhs{};
+    R rhs{};
+    const bool has_lhs = lhs_->Eval(lhs);
+    const bool has_rhs = rhs_->Eval(rhs);
+    if (!has_lhs || !has_rhs) {
+      return false;
+    }
+    out = Compute<kOp>(Widen<T>(lhs), Widen<T>(rhs));
+    return true;
+  }
+
+ private:
+  std::unique_ptr<TypedExpr<L>> lhs_;
+  std::unique_ptr<TypedExpr<R>> rhs_;
+};
+
+// NULL compares equal to NULL and unequal to anything else, a NULL right
+// operand next to a number is an error, as in `CmpExpr`.
+template <typename L, typename R, CmpOp kOp>
+class CmpNode : public TypedExpr<bool> {
+ public:
+  CmpNode(std::unique_ptr<TypedExpr<L>> lhs, std::unique_ptr<TypedExpr<R>> rhs)
+      : lhs_{std::move(lhs)}, rhs_{std::move(rhs)} {}
+
+  bool Eval(bool& out) override {
+    L lhs{};
+    R rhs{};
+    const bool has_lhs = lhs_->Eval(lhs);
+    const bool has_rhs = rhs_->Eval(rhs);
+    if (!has_lhs) {
+      out = !has_rhs;
+    } else if (!has_rhs) {
+      ThrowNullRhs();
+    } else {
+      using T = CommonT<L, R>;
+      out = Compare<kOp>(Widen<T>(lhs), Widen<T>(rhs));
+    }
+    return true;
+  }
+
+ private:
+  std::unique_ptr<TypedExpr<L>> lhs_;
+  std::unique_ptr<TypedExpr<R>> rhs_;
+};
+
+// The common predicate shapes read their columns directly instead of going
+// through child nodes.
+template <typename L, typename R, CmpOp kOp>
+class FieldConstCmpNode : public TypedExpr<bool> {
+ public:
+  FieldConstCmpNode(scan::FieldBinding lhs, R rhs)
+      : lhs_{std::move(lhs)}, rhs_{Widen<CommonT<L, R>>(rhs)} {}
+
+  bool Eval(bool& out) override {
+    L lhs{};
+    out = scan::ReadFieldAs(lhs_, lhs) &&
+          Compare<kOp>(Widen<CommonT<L, R>>(lhs), rhs_);
+    return true;
+  }
+
+ private:
+  scan::FieldBinding lhs_;
+  CommonT<L, R> rhs_;
+};
+
+template <typename L, typename R, CmpOp kOp>
+class ConstFieldCmpNode : public TypedExpr<bool> {
+ public:
+  ConstFieldCmpNode(L lhs, scan::FieldBinding rhs)
+      : lhs_{Widen<CommonT<L, R>>(lhs)}, rhs_{std::move(rhs)} {}
+
+  bool Eval(bool& out) override {
+    R rhs{};
+    if (!scan::ReadFieldAs(rhs_, rhs)) {
+      ThrowNullRhs();
+    }
+    out = Compare<kOp>(lhs_, Widen<CommonT<L, R>>(rhs));
+    return true;
+  }
+
+ private:
+  CommonT<L, R> lhs_;
+  scan::FieldBinding rhs_;
+};
+
+template <typename L, typename R, CmpOp kOp>
+class FieldFieldCmpNode : public TypedExpr<bool> {
+ public:
+  FieldFieldCmpNode(scan::FieldBinding lhs, scan::FieldBinding rhs)
+      : lhs_{std::move(lhs)}, rhs_{std::move(rhs)} {}
+
+  bool Eval(bool& out) override {
+    L lhs{};
+    R rhs{};
+    const bool has_lhs = scan::ReadFieldAs(lhs_, lhs);
+    const bool has_rhs = scan::ReadFieldAs(rhs_, rhs);
+    if (!has_lhs) {
+      out = !has_rhs;
+    } else if (!has_rhs) {
+      ThrowNullRhs();
+    } else {
+      using T = CommonT<L, R>;
+      out = Compare<kOp>(Widen<T>(lhs), Widen<T>(rhs));
+    }
+    return true;
+  }
+
+ private:
+  scan::FieldBinding lhs_;
+  scan::FieldBinding rhs_;
+};
+
+template <typename T>
+class ToBoolNode : public TypedExpr<bool> {
+ public:
+  explicit ToBoolNode(std::unique_ptr<TypedExpr<T>> internal)
+      : internal_{std::move(internal)} {}
+
+  bool Eval(bool& out) override {
+    T value{};
+    if (!internal_->Eval(value)) {
+      return false;
+    }
+    out = value != 0;
+    return true;
+  }
+
+ private:
+  std::unique_ptr<TypedExpr<T>> internal_;
+};
+
+class NotNode : public TypedExpr<bool> {
+ public:
+  explicit NotNode(std::unique_ptr<TypedExpr<bool>> internal)
+      : internal_{std::move(internal)} {}
+
+  bool Eval(bool& out) override {
+    if (!internal_->Eval(out)) {
+      return false;
+    }
+    out = !out;
+    return true;
+  }
+
+ private:
+  std::unique_ptr<TypedExpr<bool>> internal_;
+};
+
+// Follows `CombineValues`: NULL on one side gives NULL, except for OR which
+// then yields the other side.
+template <BinBoolOp kOp>
+class BinBoolNode : public TypedExpr<bool> {
+ public:
+  BinBoolNode(std::unique_ptr<TypedExpr<bool>> lhs,
+              std::unique_ptr<TypedExpr<bool>> rhs)
+      : lhs_{std::move(lhs)}, rhs_{std::move(rhs)} {}
+
+  bool Eval(bool& out) override {
+    bool lhs = false;
+    bool rhs = false;
+    const bool has_lhs = lhs_->Eval(lhs);
+    const bool has_rhs = rhs_->Eval(rhs);
+    if (!has_lhs || !has_rhs) {
+      if (kOp != BinBoolOp::Or || (!has_lhs && !has_rhs)) {
+        return false;
+      }
+      out = has_lhs ? lhs : rhs;
+      return true;
+    }
+    if constexpr (kOp == BinBoolOp::And) {
+      out = lhs && rhs;
+    } else if constexpr (kOp == BinBoolOp::Or) {
+      out = lhs || rhs;
+    } else {
+      out = lhs ^ rhs;
+    }
+    return true;
+  }
+
+ private:
+  std::unique_ptr<TypedExpr<bool>> lhs_;
+  std::unique_ptr<TypedExpr<bool>> rhs_;
+};
+
+template <typename Node, typename... Args>
+AnyTypedExpr MakeNode(Args&&... args) {
+  return std::unique_ptr<TypedExpr<typename Node::value_type>>(
+      std::make_unique<Node>(std::forward<Args>(args)...));
+}
+
+std::unique_ptr<TypedExpr<bool>> ToBool(AnyTypedExpr expr) {
+  return std::visit(
+      [](auto&& internal) -> std::unique_ptr<TypedExpr<bool>> {
+        using T = typename std::decay_t<decltype(*internal)>::value_type;
+        if constexpr (std::is_same_v<T, bool>) {
+          return std::move(internal);
+        } else {
+          return std::make_unique<ToBoolNode<T>>(std::move(internal));
+        }
+      },
+      std::move(expr));
+}
+
+template <MathExprOp kOp>
+AnyTypedExpr MakeMath(AnyTypedExpr lhs, AnyTypedExpr rhs) {
+  return std::visit(
+      [](auto&& left, auto&& right) {
+        using L = typename std::decay_t<decltype(*left)>::value_type;
+        using R = typename std::decay_t<decltype(*right)>::value_type;
+        return MakeNode<MathNode<L, R, kOp>>(std::move(left),
+                                             std::move(right));
+      },
+      std::move(lhs), std::move(rhs));
+}
+
+template <CmpOp kOp>
+AnyTypedExpr MakeCmp(AnyTypedExpr lhs, AnyTypedExpr rhs) {
+  return std::visit(
+      [](auto&& left, auto&& right) {
+        using L = typename std::decay_t<decltype(*left)>::value_type;
+        using R = typename std::decay_t<decltype(*right)>::value_type;
+        const auto* left_field = dynamic_cast<FieldNode<L>*>(left.get());
+        const auto* right_field = dynamic_cast<FieldNode<R>*>(right.get());
+        const auto* left_const = dynamic_cast<ConstNode<L>*>(left.get());
+        const auto* right_const = dynamic_cast<ConstNode<R>*>(right.get());
+        if (left_field != nullptr && right_const != nullptr) {
+          return MakeNode<FieldConstCmpNode<L, R, kOp>>(left_field->binding(),
+                                                        right_const->value());
+        }
+        if (left_const != nullptr && right_field != nullptr) {
+          return MakeNode<ConstFieldCmpNode<L, R, kOp>>(left_const->value(),
+                                                        right_field->binding());
+        }
+        if (left_field != nullptr && right_field != nullptr) {
+          return MakeNode<FieldFieldCmpNode<L, R, kOp>>(left_field->binding(),
+                                                        right_field->binding());
+        }
+        return MakeNode<CmpNode<L, R, kOp>>(std::move(left), std::move(right));
+      },
+      std::move(lhs), std::move(rhs));
+}
+
+AnyTypedExpr MakeBinBool(BinBoolOp op, AnyTypedExpr lhs, AnyTypedExpr rhs) {
+  auto left = ToBool(std::move(lhs));
+  auto right = ToBool(std::move(rhs));
+  switch (op) {
+    case BinBoolOp::And:
+      return MakeNode<BinBoolNode<BinBoolOp::And>>(std::move(left),
+                                                   std::move(right));
+    case BinBoolOp::Or:
+      return MakeNode<BinBoolNode<BinBoolOp::Or>>(std::move(left),
+                                                  std::move(right));
+    case BinBoolOp::Xor:
+      return MakeNode<BinBoolNode<BinBoolOp::Xor>>(std::move(left),
+                                                   std::move(right));
+  }
+  throw std::runtime_error("unknown boolean operation");
+}
+
+AnyTypedExpr MakeNot(AnyTypedExpr expr) {
+  return MakeNode<NotNode>(ToBool(std::move(expr)));
+}
+
+// Mirrors the shape `ExprTreeConverter` gives each operator, so both trees
+// evaluate the same way.
+struct TypedCompiler {
+  IScanSelector& scans;
+
+  std::optional<AnyTypedExpr> Compile(const FactorTree& tree) {
+    auto expr = std::visit(*this, tree.factor);
+    if (!expr.has_value()) {
+      return std::nullopt;
+    }
+    if (tree.neg_applied) {
+      expr = MakeMath<MathExprOp::Minus>(MakeNode<ConstNode<int>>(0),
+                                         std::move(expr.value()));
+    }
+    if (tree.not_applied) {
+      expr = MakeNot(std::move(expr.value()));
+    }
+    return expr;
+  }
+
+  std::optional<AnyTypedExpr> operator()(const ExprTree& expr) {
+    if (expr.factors.size() < 2) {
+      return std::nullopt;
+    }
+    switch (expr.op) {
+      case GenBinOp::Or:
+        return FoldBinBool(expr.factors, BinBoolOp::Or);
+      case GenBinOp::And:
+        return FoldBinBool(expr.factors, BinBoolOp::And);
+      case GenBinOp::Xor:
+        return FoldBinBool(expr.factors, BinBoolOp::Xor);
+      case GenBinOp::Plus:
+        return FoldMath<MathExprOp::Plus>(expr.factors);
+      case GenBinOp::Minus:
+        return FoldMath<MathExprOp::Minus>(expr.factors);
+      case GenBinOp::Mul:
+        return FoldMath<MathExprOp::Mul>(expr.factors);
+      case GenBinOp::Div:
+        return FoldMath<MathExprOp::Div>(expr.factors);
+      case GenBinOp::Eq:
+        return CompileCmp<CmpOp::Eq>(expr.factors, 0, 1);
+      case GenBinOp::NotEq: {
+        auto eq = CompileCmp<CmpOp::Eq>(expr.factors, 0, 1);
+        if (!eq.has_value()) {
+          return std::nullopt;
+        }
+        return MakeNot(std::move(eq.value()));
+      }
+      case GenBinOp::LT:
+        return CompileCmp<CmpOp::Le>(expr.factors, 0, 1);
+      case GenBinOp::GT:
+        return CompileCmp<CmpOp::Le>(expr.factors, 1, 0);
+      case GenBinOp::LE:
+      case GenBinOp::GE: {
+        const size_t left_idx = expr.op == GenBinOp::LE ? 0 : 1;
+        const size_t right_idx = expr.op == GenBinOp::LE ? 1 : 0;
+        auto less = CompileCmp<CmpOp::Le>(expr.factors, left_idx, right_idx);
+        auto eq = CompileCmp<CmpOp::Eq>(expr.factors, left_idx, right_idx);
+        if (!less.has_value() || !eq.has_value()) {
+          return std::nullopt;
+        }
+        return MakeBinBool(BinBoolOp::Or, std::move(less.value()),
+                           std::move(eq.value()));
+      }
+      case GenBinOp::Is:
+      case GenBinOp::IsNot:
+        return std::nullopt;
+    }
+    return std::nullopt;
+  }
+
+  std::optional<AnyTypedExpr> operator()(const ExprId& field_name) {
+    const auto* scan = scans.GetScan(field_name.id);
+    if (scan == nullptr) {
+      return std::nullopt;
+    }
+    auto binding = scan->BindField(field_name.id);
+    if (!binding.has_value()) {
+      return std::nullopt;
+    }
+    switch (binding->field.type()) {
+      case core::Field::FieldType::Bool:
+        return MakeNode<FieldNode<bool>>(std::move(binding.value()));
+      case core::Field::FieldType::Int:
+        return MakeNode<FieldNode<int>>(std::move(binding.value()));
+      case core::Field::FieldType::Float:
+        return MakeNode<FieldNode<float>>(std::move(binding.value()));
+      case core::Field::FieldType::Double:
+        return MakeNode<FieldNode<double>>(std::move(binding.value()));
+      case core::Field::FieldType::Varchar:
+        return std::nullopt;
+    }
+    return std::nullopt;
+  }
+
+  std::optional<AnyTypedExpr> operator()(const Constant& constant) {
+    return std::visit(
+        [](auto&& arg) -> std::optional<AnyTypedExpr> {
+          using T = std::decay_t<decltype(arg)>;
+          if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, int> ||
+                        std::is_same_v<T, double>) {
+            return MakeNode<ConstNode<T>>(arg);
+          }
+          return std::nullopt;
+        },
+        constant);
+  }
+
+  std::optional<AnyTypedExpr> operator()(const ExprAggregate& /*aggregate*/) {
+    return std::nullopt;
+  }
+
+ private:
+  template <CmpOp kOp>
+  std::optional<AnyTypedExpr> CompileCmp(const std::vector<FactorTree>& factors,
+                                         size_t lhs_idx, size_t rhs_idx) {
+    if (factors.size() != 2) {
+      return std::nullopt;
+    }
+    auto lhs = Compile(factors[lhs_idx]);
+    auto rhs = Compile(factors[rhs_idx]);
+    if (!lhs.has_value() || !rhs.has_value()) {
+      return std::nullopt;
+    }
+    return MakeCmp<kOp>(std::move(lhs.value()), std::move(rhs.value()));
+  }
+
+  template <MathExprOp kOp>
+  std::optional<AnyTypedExpr> FoldMath(const std::vector<FactorTree>& factors) {
+    auto ret = Compile(factors[0]);
+    for (size_t i = 1; i < factors.size() && ret.has_value(); ++i) {
+      auto next = Compile(factors[i]);
+      if (!next.has_value()) {
+        return std::nullopt;
+      }
+      ret = MakeMath<kOp>(std::move(ret.value()), std::move(next.value()));
+    }
+    return ret;
+  }
+
+  std::optional<AnyTypedExpr> FoldBinBool(
+      const std::vector<FactorTree>& factors, BinBoolOp op) {
+    auto ret = Compile(factors[0]);
+    for (size_t i = 1; i < factors.size() && ret.has_value(); ++i) {
+      auto next = Compile(factors[i]);
+      if (!next.has_value()) {
+        return std::nullopt;
+      }
+      ret = MakeBinBool(op, std::move(ret.value()), std::move(next.value()));
+    }
+    return ret;
+  }
+};
+
+std::optional<AnyTypedExpr> CompileTyped(const FactorTree& tree,
+                                         IScanSelector& scans) {
+  return TypedCompiler{scans}.Compile(tree);
+}
+
+CompiledExpr::CompiledExpr(AnyTypedExpr compiled,
+                           std::unique_ptr<IExpr> interpreted)
+    : compiled_{std::move(compiled)}, interpreted_{std::move(interpreted)} {}
+
+core::FieldVariant CompiledExpr::Eval() {
+  return std::visit(
+      [](auto&& compiled) -> core::FieldVariant {
+        typename std::decay_t<decltype(*compiled)>::value_type value{};
+        if (!compiled->Eval(value)) {
+          return core::null_t{};
+        }
+        return value;
+      },
+      compiled_);
+}
+
+bool CompiledExpr::IsTrue() {
+  return std::visit(
+      [](auto&& compiled) {
+        typename std::decay_t<decltype(*compiled)>::value_type value{};
+        return compiled->Eval(value) && value != 0;
+      },
+      compiled_);
+}
+
+bool CompiledExpr::SupportsBatch() const {
+  return interpreted_->SupportsBatch();
+}
+
+const scan::ColumnVector& CompiledExpr::EvalBatch(
+    const scan::ColumnBatch& batch, scan::ColumnVector& scratch) {
+  return interpreted_->EvalBatch(batch, scratch);
+}
+
+void CompiledExpr::CollectFieldNames(std::vector<std::string>& names) const {
+  interpreted_->CollectFieldNames(names);
+}
+
+}  // namespace deadfood::expr
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <variant>
+
+#include <deadfood/expr/iexpr.hh>
+#include <deadfood/expr/expr_tree.hh>
+#include <deadfood/expr/scan_selector/iscanselector.hh>
+
+namespace deadfood::expr {
+
+// An expression compiled for a static result type `T`, one of bool, int,
+// float and double. Values are produced unboxed, NULL is reported through the
+// return value instead of a `core::FieldVariant`.
+template <typename T>
+class TypedExpr {
+ public:
+  using value_type = T;
+
+  // returns false if the value is NULL, `out` is unspecified then
+  virtual bool Eval(T& out) = 0;
+
+  virtual ~TypedExpr() = default;
+};
+
+using AnyTypedExpr = std::variant<std::unique_ptr<TypedExpr<bool>>,
+                                  std::unique_ptr<TypedExpr<int>>,
+                                  std::unique_ptr<TypedExpr<float>>,
+                                  std::unique_ptr<TypedExpr<double>>>;
+
+// Compiles `tree` into typed evaluators, taking the column types from the
+// fields bound through `scans`. Returns nullopt if the tree needs something
+// only the interpreted expressions handle: strings, NULL literals, `IS`, or
+// fields that are not read straight from a table.
+std::optional<AnyTypedExpr> CompileTyped(const FactorTree& tree,
+                                         IScanSelector& scans);
+
+// Evaluates rows through a compiled tree. The interpreted tree it was
+// compiled from is kept for batch evaluation, which is already typed.
+class CompiledExpr : public IExpr {
+ public:
+  CompiledExpr(AnyTypedExpr compiled, std::unique_ptr<IExpr> interpreted);
+
+  core::FieldVariant Eval() override;
+  // the value converted to bool, NULL counts as false
+  bool IsTrue();
+
+  [[nodiscard]] bool SupportsBatch() const override;
+  const scan::ColumnVector& EvalBatch(const scan::ColumnBatch& batch,
+                                      scan::ColumnVector& scratch) override;
+  void CollectFieldNames(std::vector<std::string>& names) const override;
+
+ private:
+  AnyTypedExpr compiled_;
+  std::unique_ptr<IExpr> interpreted_;
+};
+
+}  // namespace deadfood::expr
@@ -14,7 +14,9 @@ static const std::set<std::string> kKeywords = {
     "into",    "values", "delete", "update",  "set",     "create", "table",
     "boolean", "int",    "float",  "double",  "varchar", "as",     "join",
     "on",      "exists", "null",   "primary", "foreign", "key",    "references",
-    "unique",  "not",    "drop"};
+    "unique",  "not",    "drop",   "index",   "with",    "analyze", "group",
+    "by",      "having", "order",  "limit",   "offset",  "distinct",
+    "union",   "intersect", "except", "all",   "vacuum"};
 
 enum class Keyword {
   Select,
@@ -48,7 +50,22 @@ enum class Keyword {
   Unique,
   Not,
   Drop,
-  Is
+  Is,
+  Index,
+  With,
+  Analyze,
+  Group,
+  By,
+  Having,
+  Order,
+  Limit,
+  Offset,
+  Distinct,
+  Union,
+  Intersect,
+  Except,
+  All,
+  Vacuum
 };
 
 static std::map<std::string, Keyword> kKeywordLiteralToKeyword = {
@@ -67,7 +84,15 @@ static std::map<std::string, Keyword> kKeywordLiteralToKeyword = {
     {"primary", Keyword::Primary}, {"foreign", Keyword::Foreign},
     {"key", Keyword::Key},         {"references", Keyword::References},
     {"unique", Keyword::Unique},   {"not", Keyword::Not},
-    {"drop", Keyword::Drop},       {"is", Keyword::Is}};
+    {"drop", Keyword::Drop},       {"is", Keyword::Is},
+    {"index", Keyword::Index},     {"with", Keyword::With},
+    {"analyze", Keyword::Analyze}, {"group", Keyword::Group},
+    {"by", Keyword::By},           {"having", Keyword::Having},
+    {"order", Keyword::Order},     {"limit", Keyword::Limit},
+    {"offset", Keyword::Offset},   {"distinct", Keyword::Distinct},
+    {"union", Keyword::Union},     {"intersect", Keyword::Intersect},
+    {"except", Keyword::Except},   {"all", Keyword::All},
+    {"vacuum", Keyword::Vacuum}};
 
 enum class Symbol {
   LParen,
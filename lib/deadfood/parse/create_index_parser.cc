@@ -0,0 +1,27 @@
+#include "create_index_parser.hh"
+
+#include <deadfood/parse/parser_error.hh>
+
+#include <deadfood/parse/parse_util.hh>
+
+namespace deadfood::parse {
+
+query::CreateIndexQuery ParseCreateIndexQuery(
+    const std::vector<lex::Token>& tokens) {
+  auto it = tokens.begin();
+  const auto end = tokens.end();
+  util::ParseKeyword(it, end, lex::Keyword::Create);
+  util::ParseKeyword(it, end, lex::Keyword::Index);
+  auto index_name = util::ParseIdWithoutDot(it, end);
+  util::ParseKeyword(it, end, lex::Keyword::On);
+  auto table_name = util::ParseIdWithoutDot(it, end);
+  util::ParseSymbol(it, end, lex::Symbol::LParen);
+  auto field_name = util::ParseIdWithoutDot(it, end);
+  util::ParseSymbol(it, end, lex::Symbol::RParen);
+  util::RaiseParserErrorIf(it != end, "unexpected end");
+  return {.index_name = std::move(index_name),
+          .table_name = std::move(table_name),
+          .field_name = std::move(field_name)};
+}
+
+}  // namespace deadfood::parse
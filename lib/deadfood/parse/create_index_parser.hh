@@ -0,0 +1,12 @@
+#pragma once
+
+#include <deadfood/query/create_index_query.hh>
+#include <deadfood/lex/lex.hh>
+
+namespace deadfood::parse {
+
+// CREATE INDEX index_name ON table_name (field_name)
+query::CreateIndexQuery ParseCreateIndexQuery(
+    const std::vector<lex::Token>& tokens);
+
+}  // namespace deadfood::parse
@@ -108,6 +108,28 @@ Field ParseField(It& it, const It end) {
   return {field_name, field_type, is_unique, may_be_null};
 }
 
+// WITH (storage = row | column)
+template <std::forward_iterator It>
+storage::Layout ParseTableOptions(It& it, const It end) {
+  util::ParseKeyword(it, end, lex::Keyword::With);
+  util::ParseSymbol(it, end, lex::Symbol::LParen);
+  const auto option = util::ParseIdWithoutDot(it, end);
+  if (deadfood::util::lowercase(option) != "storage") {
+    throw ParserError("unknown table option `" + option + "`");
+  }
+  util::ParseSymbol(it, end, lex::Symbol::Eq);
+  const auto value =
+      deadfood::util::lowercase(util::ParseIdWithoutDot(it, end));
+  util::ParseSymbol(it, end, lex::Symbol::RParen);
+  if (value == "row") {
+    return storage::Layout::Row;
+  }
+  if (value == "column") {
+    return storage::Layout::Column;
+  }
+  throw ParserError("expected `row` or `column` storage");
+}
+
 template <typename It>
 core::ReferencesConstraint ParseReferencesConstraint(
     const std::string& table_name, It& it, const It end) {
@@ -162,6 +184,10 @@ ParseCreateTableQuery(const std::vector<lex::Token>& tokens) {
       }
     }
   }
+  util::ParseSymbol(it, end, lex::Symbol::RParen);
+  if (it != end) {
+    query.set_layout(ParseTableOptions(it, end));
+  }
   return {query, constraints};
 }
 
@@ -0,0 +1,19 @@
+#include "drop_index_parser.hh"
+
+#include <deadfood/parse/parser_error.hh>
+
+#include <deadfood/parse/parse_util.hh>
+
+namespace deadfood::parse {
+
+std::string ParseDropIndexQuery(const std::vector<lex::Token>& tokens) {
+  auto it = tokens.begin();
+  const auto end = tokens.end();
+  util::ParseKeyword(it, end, lex::Keyword::Drop);
+  util::ParseKeyword(it, end, lex::Keyword::Index);
+  auto index_name = util::ParseIdWithoutDot(it, end);
+  util::RaiseParserErrorIf(it != end, "unexpected end");
+  return index_name;
+}
+
+}  // namespace deadfood::parse
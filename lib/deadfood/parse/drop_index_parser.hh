@@ -0,0 +1,9 @@
+#pragma once
+
+#include <deadfood/lex/lex.hh>
+
+namespace deadfood::parse {
+
+std::string ParseDropIndexQuery(const std::vector<lex::Token>& tokens);
+
+}  // namespace deadfood::parse
@@ -3,7 +3,9 @@
 #include <deadfood/expr/expr_tree.hh>
 #include <deadfood/lex/lex.hh>
 #include <deadfood/parse/parser_error.hh>
+#include <deadfood/util/str.hh>
 
+#include <map>
 #include <optional>
 #include <vector>
 #include <algorithm>
@@ -13,6 +15,21 @@ namespace deadfood::parse {
 template <typename It>
 expr::FactorTree ParseExprTreeInternal(It& it, const It end);
 
+inline std::optional<expr::AggregateFn> GetAggregateFn(
+    const std::string& name) {
+  static const std::map<std::string, expr::AggregateFn> kAggregateFns = {
+      {"count", expr::AggregateFn::Count},
+      {"sum", expr::AggregateFn::Sum},
+      {"min", expr::AggregateFn::Min},
+      {"max", expr::AggregateFn::Max},
+      {"avg", expr::AggregateFn::Avg}};
+  const auto it = kAggregateFns.find(deadfood::util::lowercase(name));
+  if (it == kAggregateFns.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
 template <typename It>
 struct my_visitor {
   It& it;
@@ -43,6 +60,25 @@ struct my_visitor {
   }
 
   std::optional<expr::FactorTree> operator()(const lex::Identifier& tok) {
+    const auto fn = GetAggregateFn(tok.id);
+    if (fn.has_value() && it + 1 != end &&
+        lex::IsSymbol(*(it + 1), lex::Symbol::LParen)) {
+      it += 2;
+      expr::ExprAggregate aggregate{.fn = fn.value(), .args = {}};
+      if (fn == expr::AggregateFn::Count && it != end &&
+          lex::IsSymbol(*it, lex::Symbol::Mul)) {
+        ++it;
+      } else {
+        aggregate.args.emplace_back(ParseExprTreeInternal(it, end));
+      }
+      if (it == end || !lex::IsSymbol(*it, lex::Symbol::RParen)) {
+        throw ParserError("expected `)`");
+      }
+      ++it;
+      return expr::FactorTree{.neg_applied = neg_applied,
+                              .not_applied = not_applied,
+                              .factor = std::move(aggregate)};
+    }
     ++it;
     return expr::FactorTree{.neg_applied = neg_applied,
                             .not_applied = not_applied,
@@ -56,13 +56,14 @@ query::InsertQuery ParseInsertQueryInternal(It& it, const It end) {
     }
   }
 
-  return query::InsertQuery{
-      .table_name = table_name, .fields = field_names, .values = values};
+  return query::InsertQuery{.table_name = table_name,
+                            .fields = field_names,
+                            .values = std::move(values)};
 }
 
 query::InsertQuery ParseInsertQuery(const std::vector<lex::Token>& tokens) {
   auto it = tokens.begin();
-  const auto ret = ParseInsertQueryInternal(it, tokens.end());
+  auto ret = ParseInsertQueryInternal(it, tokens.end());
   util::RaiseParserErrorIf(it != tokens.end(), "unexpected end");
   return ret;
 }
@@ -67,6 +67,17 @@ query::Selector ParseSelector(It& it, const It end) {
                               .field_name = std::move(field_name)};
 }
 
+// the row count after LIMIT or OFFSET
+template <std::forward_iterator It>
+size_t ParseRowCount(It& it, const It end) {
+  util::ExpectNotEnd(it, end);
+  const auto* count = std::get_if<int>(&*it);
+  util::RaiseParserErrorIf(count == nullptr || *count < 0,
+                           "expected a number of rows");
+  ++it;
+  return static_cast<size_t>(*count);
+}
+
 template <std::forward_iterator It>
 query::SelectFrom ParseSource(It& it, const It end) {
   if (lex::IsSymbol(*it, lex::Symbol::LParen)) {
@@ -88,13 +99,25 @@ query::SelectFrom ParseSource(It& it, const It end) {
 }  // namespace
 
 template <std::forward_iterator It>
-inline query::SelectQuery ParseSelectQuery(It& it, const It end) {
+bool IsSetOperator(const It& it, const It end) {
+  return it != end && (lex::IsKeyword(*it, lex::Keyword::Union) ||
+                       lex::IsKeyword(*it, lex::Keyword::Intersect) ||
+                       lex::IsKeyword(*it, lex::Keyword::Except));
+}
+
+// a single SELECT, without set operations
+template <std::forward_iterator It>
+inline query::SelectQuery ParseSelectCore(It& it, const It end) {
   query::SelectQuery ret;
   util::ParseKeyword(it, end, lex::Keyword::Select);
+  if (it != end && lex::IsKeyword(*it, lex::Keyword::Distinct)) {
+    ret.distinct = true;
+    ++it;
+  }
 
   while (it != end && !lex::IsSymbol(*it, lex::Symbol::RParen) &&
          !lex::IsKeyword(*it, lex::Keyword::From) &&
-         !lex::IsKeyword(*it, lex::Keyword::Where)) {
+         !lex::IsKeyword(*it, lex::Keyword::Where) && !IsSetOperator(it, end)) {
     auto selector = ParseSelector(it, end);
     ret.selectors.emplace_back(std::move(selector));
     if (it != end && lex::IsSymbol(*it, lex::Symbol::Comma)) {
@@ -113,7 +136,13 @@ inline query::SelectQuery ParseSelectQuery(It& it, const It end) {
   if (lex::IsKeyword(*it, lex::Keyword::From)) {
     ++it;
     while (it != end && !lex::IsSymbol(*it, lex::Symbol::RParen) &&
-           !lex::IsKeyword(*it, lex::Keyword::Where)) {
+           !lex::IsKeyword(*it, lex::Keyword::Where) &&
+           !lex::IsKeyword(*it, lex::Keyword::Group) &&
+           !lex::IsKeyword(*it, lex::Keyword::Having) &&
+           !lex::IsKeyword(*it, lex::Keyword::Order) &&
+           !lex::IsKeyword(*it, lex::Keyword::Limit) &&
+           !lex::IsKeyword(*it, lex::Keyword::Offset) &&
+           !IsSetOperator(it, end)) {
       {
         std::forward_iterator auto copy_it = it;
         if (ParseJoinType(copy_it, end).has_value()) {
@@ -168,9 +197,103 @@ inline query::SelectQuery ParseSelectQuery(It& it, const It end) {
     ++it;
     auto predicate = ParseExprTree(it, end);
     ret.predicate = std::move(predicate);
-    return ret;
   }
 
+  if (it != end && lex::IsKeyword(*it, lex::Keyword::Group)) {
+    ++it;
+    util::ParseKeyword(it, end, lex::Keyword::By);
+    while (true) {
+      ret.group_by.emplace_back(ParseExprTree(it, end));
+      if (it == end || !lex::IsSymbol(*it, lex::Symbol::Comma)) {
+        break;
+      }
+      ++it;
+    }
+  }
+
+  if (it != end && lex::IsKeyword(*it, lex::Keyword::Having)) {
+    ++it;
+    auto having = ParseExprTree(it, end);
+    ret.having = std::move(having);
+  }
+
+  if (it != end && lex::IsKeyword(*it, lex::Keyword::Order)) {
+    ++it;
+    util::ParseKeyword(it, end, lex::Keyword::By);
+    while (true) {
+      auto expr = ParseExprTree(it, end);
+      ret.order_by.emplace_back(
+          query::OrderKey{.expr = std::move(expr), .descending = false});
+      if (it != end && std::holds_alternative<lex::Identifier>(*it)) {
+        const auto direction =
+            deadfood::util::lowercase(std::get<lex::Identifier>(*it).id);
+        if (direction == "desc") {
+          ret.order_by.back().descending = true;
+          ++it;
+        } else if (direction == "asc") {
+          ++it;
+        }
+      }
+      if (it == end || !lex::IsSymbol(*it, lex::Symbol::Comma)) {
+        break;
+      }
+      ++it;
+    }
+  }
+
+  if (it != end && lex::IsKeyword(*it, lex::Keyword::Limit)) {
+    ++it;
+    ret.limit = ParseRowCount(it, end);
+  }
+  if (it != end && lex::IsKeyword(*it, lex::Keyword::Offset)) {
+    ++it;
+    ret.offset = ParseRowCount(it, end);
+  }
+
+  return ret;
+}
+
+template <std::forward_iterator It>
+inline query::SelectQuery ParseSelectQuery(It& it, const It end) {
+  auto ret = ParseSelectCore(it, end);
+  const auto is_ordered = [](const query::SelectQuery& query) {
+    return !query.order_by.empty() || query.limit.has_value() ||
+           query.offset.has_value();
+  };
+  while (IsSetOperator(it, end)) {
+    const auto& previous = ret.set_operations.empty()
+                               ? ret
+                               : ret.set_operations.back().query;
+    util::RaiseParserErrorIf(
+        is_ordered(previous),
+        "ORDER BY, LIMIT and OFFSET must follow the last query");
+    query::SetOperation operation{.op = query::SetOperator::Union,
+                                  .all = false,
+                                  .query = {}};
+    if (lex::IsKeyword(*it, lex::Keyword::Intersect)) {
+      operation.op = query::SetOperator::Intersect;
+    } else if (lex::IsKeyword(*it, lex::Keyword::Except)) {
+      operation.op = query::SetOperator::Except;
+    }
+    ++it;
+    if (operation.op == query::SetOperator::Union && it != end &&
+        lex::IsKeyword(*it, lex::Keyword::All)) {
+      operation.all = true;
+      ++it;
+    }
+    operation.query = ParseSelectCore(it, end);
+    ret.set_operations.emplace_back(std::move(operation));
+  }
+  // those of the last query apply to the result of all of them
+  if (!ret.set_operations.empty()) {
+    auto& last = ret.set_operations.back().query;
+    ret.order_by = std::move(last.order_by);
+    ret.limit = last.limit;
+    ret.offset = last.offset;
+    last.order_by.clear();
+    last.limit.reset();
+    last.offset.reset();
+  }
   return ret;
 }
 
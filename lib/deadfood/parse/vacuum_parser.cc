@@ -0,0 +1,22 @@
+#include "vacuum_parser.hh"
+
+#include <deadfood/parse/parser_error.hh>
+
+#include <deadfood/parse/parse_util.hh>
+
+namespace deadfood::parse {
+
+std::optional<std::string> ParseVacuumQuery(
+    const std::vector<lex::Token>& tokens) {
+  auto it = tokens.begin();
+  const auto end = tokens.end();
+  util::ParseKeyword(it, end, lex::Keyword::Vacuum);
+  if (it == end) {
+    return std::nullopt;
+  }
+  auto table_name = util::ParseIdWithoutDot(it, end);
+  util::RaiseParserErrorIf(it != end, "unexpected end");
+  return table_name;
+}
+
+}  // namespace deadfood::parse
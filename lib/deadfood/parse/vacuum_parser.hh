@@ -0,0 +1,13 @@
+#pragma once
+
+#include <optional>
+
+#include <deadfood/lex/lex.hh>
+
+namespace deadfood::parse {
+
+// `VACUUM [table]`; returns the table name, or nullopt for all tables
+std::optional<std::string> ParseVacuumQuery(
+    const std::vector<lex::Token>& tokens);
+
+}  // namespace deadfood::parse
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+namespace deadfood::query {
+
+struct CreateIndexQuery {
+  std::string index_name;
+  std::string table_name;
+  std::string field_name;
+};
+
+}  // namespace deadfood::query
@@ -3,7 +3,7 @@
 namespace deadfood::query {
 
 CreateTableQuery::CreateTableQuery(const std::string& table_name)
-    : table_name_{table_name} {}
+    : table_name_{table_name}, layout_{storage::Layout::Row} {}
 
 const std::string& CreateTableQuery::table_name() const { return table_name_; }
 
@@ -41,4 +41,8 @@ const std::vector<std::string>& CreateTableQuery::field_names() const {
   return field_names_;
 }
 
-}  // namespace deadfood::query
\ No newline at end of file
+storage::Layout CreateTableQuery::layout() const { return layout_; }
+
+void CreateTableQuery::set_layout(storage::Layout layout) { layout_ = layout; }
+
+}  // namespace deadfood::query
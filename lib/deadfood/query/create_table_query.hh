@@ -5,6 +5,7 @@
 #include <map>
 
 #include <deadfood/core/field.hh>
+#include <deadfood/storage/layout.hh>
 
 namespace deadfood::query {
 
@@ -25,8 +26,12 @@ class CreateTableQuery {
 
   [[nodiscard]] const std::vector<std::string>& field_names() const;
 
+  [[nodiscard]] storage::Layout layout() const;
+  void set_layout(storage::Layout layout);
+
  private:
   std::string table_name_;
+  storage::Layout layout_;
 
   std::map<std::string, size_t> field_indices_;
   std::vector<std::string> field_names_;
@@ -10,6 +10,7 @@
 namespace deadfood::query {
 
 struct SelectQuery;
+struct SetOperation;
 
 struct FromTable {
   std::string table_name;
@@ -32,14 +33,37 @@ struct FieldSelector {
   std::string field_name;
 };
 
+// a key of ORDER BY
+struct OrderKey {
+  expr::FactorTree expr;
+  bool descending;
+};
+
 using SelectFrom = std::variant<SelectQuery, FromTable>;
 using Selector = std::variant<SelectAllSelector, std::string, FieldSelector>;
 
 struct SelectQuery {
+  bool distinct = false;
   std::vector<Selector> selectors;
   std::vector<SelectFrom> sources;
   std::optional<expr::FactorTree> predicate;
   std::vector<Join> joins;
+  std::vector<expr::FactorTree> group_by;
+  std::optional<expr::FactorTree> having;
+  std::vector<OrderKey> order_by;
+  std::optional<size_t> limit;
+  std::optional<size_t> offset;
+  // applied left to right; ORDER BY, LIMIT and OFFSET apply to the result
+  std::vector<SetOperation> set_operations;
+};
+
+enum class SetOperator { Union, Intersect, Except };
+
+struct SetOperation {
+  SetOperator op;
+  // keeps duplicates, UNION only
+  bool all;
+  SelectQuery query;
 };
 
 }  // namespace deadfood::query
@@ -0,0 +1,179 @@
+#include "column_batch.hh"
+
+#include <algorithm>
+#include <numeric>
+
+namespace deadfood::scan {
+
+size_t ColumnVector::size() const { return nulls_.size(); }
+
+bool ColumnVector::IsNull(size_t row) const { return nulls_[row] != 0; }
+
+bool ColumnVector::HasNulls() const {
+  return std::find(nulls_.begin(), nulls_.end(), 1) != nulls_.end();
+}
+
+core::FieldVariant ColumnVector::Get(size_t row) const {
+  if (IsNull(row)) {
+    return core::null_t{};
+  }
+  return std::visit(
+      [&](auto&& values) -> core::FieldVariant {
+        using T = typename std::decay_t<decltype(values)>::value_type;
+        if constexpr (std::is_same_v<T, uint8_t>) {
+          return values[row] != 0;
+        } else {
+          return values[row];
+        }
+      },
+      data_);
+}
+
+void ColumnVector::Clear() {
+  std::visit([](auto&& values) { values.clear(); }, data_);
+  nulls_.clear();
+}
+
+void ColumnVector::ResetGeneric(size_t size) {
+  data_ = std::vector<core::FieldVariant>(size, core::null_t{});
+  nulls_.assign(size, 1);
+}
+
+void ColumnVector::Fill(size_t size, const core::FieldVariant& value) {
+  std::visit(
+      [&](auto&& arg) {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, core::null_t>) {
+          ResetGeneric(size);
+        } else if constexpr (std::is_same_v<T, bool>) {
+          ResetTyped<uint8_t>(size);
+          std::fill(typed<uint8_t>()->begin(), typed<uint8_t>()->end(),
+                    arg ? 1 : 0);
+        } else {
+          ResetTyped<T>(size);
+          std::fill(typed<T>()->begin(), typed<T>()->end(), arg);
+        }
+      },
+      value);
+}
+
+void ColumnVector::Append(const core::FieldVariant& value) {
+  nulls_.emplace_back(std::holds_alternative<core::null_t>(value) ? 1 : 0);
+  std::visit([](auto&& values) { values.emplace_back(); }, data_);
+  Set(size() - 1, value);
+}
+
+void ColumnVector::Set(size_t row, const core::FieldVariant& value) {
+  if (std::holds_alternative<core::null_t>(value)) {
+    SetNull(row);
+    return;
+  }
+  nulls_[row] = 0;
+  const bool stored = std::visit(
+      [&](auto&& values) {
+        using T = typename std::decay_t<decltype(values)>::value_type;
+        if constexpr (std::is_same_v<T, core::FieldVariant>) {
+          values[row] = value;
+          return true;
+        } else if constexpr (std::is_same_v<T, uint8_t>) {
+          if (const auto* v = std::get_if<bool>(&value)) {
+            values[row] = *v ? 1 : 0;
+            return true;
+          }
+        } else {
+          if (const auto* v = std::get_if<T>(&value)) {
+            values[row] = *v;
+            return true;
+          }
+        }
+        return false;
+      },
+      data_);
+  if (!stored) {
+    Box();
+    std::get<std::vector<core::FieldVariant>>(data_)[row] = value;
+  }
+}
+
+void ColumnVector::SetNull(size_t row) {
+  nulls_[row] = 1;
+  if (auto* values = typed<core::FieldVariant>()) {
+    (*values)[row] = core::null_t{};
+  }
+}
+
+std::vector<uint8_t>& ColumnVector::nulls() { return nulls_; }
+
+void ColumnVector::Box() {
+  if (typed<core::FieldVariant>() != nullptr) {
+    return;
+  }
+  std::vector<core::FieldVariant> boxed;
+  boxed.reserve(size());
+  for (size_t row = 0; row < size(); ++row) {
+    boxed.emplace_back(Get(row));
+  }
+  data_ = std::move(boxed);
+}
+
+const std::vector<uint8_t>& ColumnVector::nulls() const { return nulls_; }
+
+ColumnBatch::ColumnBatch(std::vector<std::string> fields, size_t capacity)
+    : fields_{std::move(fields)},
+      columns_(fields_.size()),
+      capacity_{capacity},
+      size_{0} {}
+
+const std::vector<std::string>& ColumnBatch::fields() const { return fields_; }
+
+size_t ColumnBatch::capacity() const { return capacity_; }
+
+void ColumnBatch::set_capacity(size_t capacity) { capacity_ = capacity; }
+
+size_t ColumnBatch::size() const { return size_; }
+
+std::optional<size_t> ColumnBatch::FieldIndex(
+    const std::string& field_name) const {
+  const auto it = std::find(fields_.begin(), fields_.end(), field_name);
+  if (it == fields_.end()) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(std::distance(fields_.begin(), it));
+}
+
+size_t ColumnBatch::AddField(const std::string& field_name) {
+  if (const auto idx = FieldIndex(field_name)) {
+    return idx.value();
+  }
+  fields_.emplace_back(field_name);
+  columns_.emplace_back();
+  return fields_.size() - 1;
+}
+
+ColumnVector& ColumnBatch::column(size_t idx) { return columns_[idx]; }
+
+const ColumnVector& ColumnBatch::column(size_t idx) const {
+  return columns_[idx];
+}
+
+std::vector<uint32_t>& ColumnBatch::selection() { return selection_; }
+
+const std::vector<uint32_t>& ColumnBatch::selection() const {
+  return selection_;
+}
+
+void ColumnBatch::Clear() {
+  for (auto& column : columns_) {
+    column.Clear();
+  }
+  size_ = 0;
+  selection_.clear();
+}
+
+void ColumnBatch::SetSize(size_t size) {
+  size_ = size;
+  selection_.resize(size);
+  std::iota(selection_.begin(), selection_.end(), 0);
+}
+
+}  // namespace deadfood::scan
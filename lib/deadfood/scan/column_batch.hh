@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <deadfood/core/field.hh>
+
+namespace deadfood::scan {
+
+// Values of one field for all rows of a batch. Columns read from a table are
+// typed (`bool` is stored as `uint8_t`); anything else falls back to boxed
+// `FieldVariant`s. A typed column holds an arbitrary value in NULL rows.
+class ColumnVector {
+ public:
+  using Data =
+      std::variant<std::vector<core::FieldVariant>, std::vector<uint8_t>,
+                   std::vector<int>, std::vector<float>, std::vector<double>,
+                   std::vector<std::string>>;
+
+  ColumnVector() = default;
+
+  [[nodiscard]] size_t size() const;
+  [[nodiscard]] bool IsNull(size_t row) const;
+  [[nodiscard]] bool HasNulls() const;
+  [[nodiscard]] core::FieldVariant Get(size_t row) const;
+
+  // keeps the current representation
+  void Clear();
+  // makes the column a generic one of `size` NULLs
+  void ResetGeneric(size_t size);
+  // makes the column hold `value` in `size` rows
+  void Fill(size_t size, const core::FieldVariant& value);
+  // makes the column a typed one of `size` rows without NULLs
+  template <typename T>
+  void ResetTyped(size_t size);
+
+  void Append(const core::FieldVariant& value);
+  void Set(size_t row, const core::FieldVariant& value);
+  void SetNull(size_t row);
+
+  template <typename T>
+  [[nodiscard]] std::vector<T>* typed() {
+    return std::get_if<std::vector<T>>(&data_);
+  }
+  template <typename T>
+  [[nodiscard]] const std::vector<T>* typed() const {
+    return std::get_if<std::vector<T>>(&data_);
+  }
+  [[nodiscard]] std::vector<uint8_t>& nulls();
+  [[nodiscard]] const std::vector<uint8_t>& nulls() const;
+
+ private:
+  // converts a typed column into a generic one
+  void Box();
+
+  Data data_;
+  std::vector<uint8_t> nulls_;
+};
+
+template <typename T>
+void ColumnVector::ResetTyped(size_t size) {
+  if (auto* values = typed<T>()) {
+    values->resize(size);
+  } else {
+    data_ = std::vector<T>(size);
+  }
+  nulls_.assign(size, 0);
+}
+
+// Calls `f` with the typed values of a numeric column without NULLs and
+// returns what it returns; returns false for any other column.
+template <typename F>
+bool VisitNumericColumn(const ColumnVector& column, F&& f) {
+  if (column.HasNulls()) {
+    return false;
+  }
+  if (const auto* values = column.typed<int>()) {
+    return f(*values);
+  }
+  if (const auto* values = column.typed<double>()) {
+    return f(*values);
+  }
+  if (const auto* values = column.typed<float>()) {
+    return f(*values);
+  }
+  if (const auto* values = column.typed<uint8_t>()) {
+    return f(*values);
+  }
+  return false;
+}
+
+// A chunk of rows stored column by column. `fields()` names the columns the
+// consumer asked for; producers may append more (e.g. fields a filter needs).
+// Only the rows listed in `selection()` belong to the batch, filters narrow it
+// instead of moving data around.
+class ColumnBatch {
+ public:
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  explicit ColumnBatch(std::vector<std::string> fields,
+                       size_t capacity = kDefaultCapacity);
+
+  [[nodiscard]] const std::vector<std::string>& fields() const;
+  [[nodiscard]] size_t capacity() const;
+  // producers fill at most `capacity` rows, a LIMIT lowers it to read no
+  // rows it would drop
+  void set_capacity(size_t capacity);
+  // number of physical rows, including unselected ones
+  [[nodiscard]] size_t size() const;
+
+  [[nodiscard]] std::optional<size_t> FieldIndex(
+      const std::string& field_name) const;
+  // returns the index of the column, adding it if needed
+  size_t AddField(const std::string& field_name);
+
+  ColumnVector& column(size_t idx);
+  [[nodiscard]] const ColumnVector& column(size_t idx) const;
+
+  [[nodiscard]] std::vector<uint32_t>& selection();
+  [[nodiscard]] const std::vector<uint32_t>& selection() const;
+
+  // drops all rows, keeping the columns
+  void Clear();
+  // sets the number of physical rows and selects all of them
+  void SetSize(size_t size);
+
+ private:
+  std::vector<std::string> fields_;
+  std::vector<ColumnVector> columns_;
+  size_t capacity_;
+  size_t size_;
+  std::vector<uint32_t> selection_;
+};
+
+}  // namespace deadfood::scan
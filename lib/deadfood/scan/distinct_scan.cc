@@ -0,0 +1,78 @@
+#include "distinct_scan.hh"
+
+namespace deadfood::scan {
+
+DistinctScan::DistinctScan(std::unique_ptr<IScan> input,
+                           std::vector<std::string> fields)
+    : input_{std::move(input)},
+      fields_{std::move(fields)},
+      values_(fields_.size()) {}
+
+void DistinctScan::Rewind() {
+  input_->BeforeFirst();
+  seen_.Clear();
+}
+
+bool DistinctScan::Next() {
+  while (input_->Next()) {
+    for (size_t i = 0; i < fields_.size(); ++i) {
+      values_[i] = input_->GetField(fields_[i]);
+    }
+    core::EncodeRow(values_, row_);
+    if (seen_.Insert(row_)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool DistinctScan::NextBatch(ColumnBatch& batch) {
+  std::vector<size_t> columns;
+  columns.reserve(fields_.size());
+  for (const auto& field : fields_) {
+    columns.push_back(batch.AddField(field));
+  }
+  while (input_->NextBatch(batch)) {
+    auto& selection = batch.selection();
+    size_t kept = 0;
+    for (const uint32_t row : selection) {
+      for (size_t i = 0; i < columns.size(); ++i) {
+        values_[i] = batch.column(columns[i]).Get(row);
+      }
+      core::EncodeRow(values_, row_);
+      if (seen_.Insert(row_)) {
+        selection[kept++] = row;
+      }
+    }
+    selection.resize(kept);
+    if (kept != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool DistinctScan::HasField(const std::string& field_name) const {
+  return input_->HasField(field_name);
+}
+
+core::FieldVariant DistinctScan::GetField(
+    const std::string& field_name) const {
+  return input_->GetField(field_name);
+}
+
+std::optional<FieldBinding> DistinctScan::BindField(
+    const std::string& field_name) const {
+  return input_->BindField(field_name);
+}
+
+void DistinctScan::SetField(const std::string& /*field_name*/,
+                            const core::FieldVariant& /*value*/) {}
+
+void DistinctScan::Insert() {}
+
+void DistinctScan::Delete() {}
+
+void DistinctScan::Close() { input_->Close(); }
+
+}  // namespace deadfood::scan
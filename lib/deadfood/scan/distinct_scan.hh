@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <deadfood/core/row_set.hh>
+#include <deadfood/scan/iscan.hh>
+
+namespace deadfood::scan {
+
+// Returns the rows of `input` whose values of `fields` were not seen before,
+// in input order. Rows are kept encoded in a `core::RowSet`, so a duplicate
+// costs a hash probe and no copy of its values.
+class DistinctScan : public IScan {
+ public:
+  DistinctScan(std::unique_ptr<IScan> input, std::vector<std::string> fields);
+
+  void Rewind() override;
+  bool Next() override;
+  bool NextBatch(ColumnBatch& batch) override;
+
+  [[nodiscard]] bool HasField(const std::string& field_name) const override;
+  [[nodiscard]] core::FieldVariant GetField(
+      const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
+  void SetField(const std::string& field_name,
+                const core::FieldVariant& value) override;
+
+  void Insert() override;
+  void Delete() override;
+
+  void Close() override;
+
+ private:
+  std::unique_ptr<IScan> input_;
+  std::vector<std::string> fields_;
+
+  core::RowSet seen_;
+  std::vector<core::FieldVariant> values_;
+  std::string row_;
+};
+
+}  // namespace deadfood::scan
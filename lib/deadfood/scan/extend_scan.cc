@@ -10,7 +10,7 @@ ExtendScan::ExtendScan(std::unique_ptr<IScan> internal,
       name_{name},
       before_first_{true} {}
 
-void ExtendScan::BeforeFirst() {
+void ExtendScan::Rewind() {
   if (internal_ != nullptr) {
     internal_->BeforeFirst();
   }
@@ -27,6 +27,31 @@ bool ExtendScan::Next() {
   return false;
 }
 
+bool ExtendScan::NextBatch(ColumnBatch& batch) {
+  if (internal_ == nullptr || !expr_->SupportsBatch()) {
+    return IScan::NextBatch(batch);
+  }
+  std::vector<std::string> expr_fields;
+  expr_->CollectFieldNames(expr_fields);
+  for (const auto& field_name : expr_fields) {
+    batch.AddField(field_name);
+  }
+  // the extension is only computed when somebody asked for it
+  const auto idx = batch.FieldIndex(name_);
+  if (!internal_->NextBatch(batch)) {
+    return false;
+  }
+  if (idx.has_value()) {
+    const auto& result = expr_->EvalBatch(batch, result_);
+    if (&result == &result_) {
+      std::swap(batch.column(idx.value()), result_);
+    } else if (&result != &batch.column(idx.value())) {
+      batch.column(idx.value()) = result;
+    }
+  }
+  return true;
+}
+
 bool ExtendScan::HasField(const std::string& field_name) const {
   if (field_name == name_) {
     return true;
@@ -37,6 +62,14 @@ bool ExtendScan::HasField(const std::string& field_name) const {
   return false;
 }
 
+std::optional<FieldBinding> ExtendScan::BindField(
+    const std::string& field_name) const {
+  if (field_name == name_ || internal_ == nullptr) {
+    return std::nullopt;
+  }
+  return internal_->BindField(field_name);
+}
+
 core::FieldVariant ExtendScan::GetField(const std::string& field_name) const {
   if (field_name == name_) {
     return expr_->Eval();
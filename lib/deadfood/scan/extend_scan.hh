@@ -8,10 +8,13 @@ namespace deadfood::scan {
 class ExtendScan : public IScan {
  public:
   ExtendScan(std::unique_ptr<IScan> internal, std::unique_ptr<expr::IExpr> expr, const std::string& name);
-  void BeforeFirst() override;
+  void Rewind() override;
   bool Next() override;
+  bool NextBatch(ColumnBatch& batch) override;
   bool HasField(const std::string& field_name) const override;
   core::FieldVariant GetField(const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
   void SetField(const std::string& field_name,
                 const core::FieldVariant& value) override;
   void Insert() override;
@@ -23,6 +26,7 @@ class ExtendScan : public IScan {
   std::unique_ptr<expr::IExpr> expr_;
   std::string name_;
   bool before_first_;
+  ColumnVector result_;
 };
 
 }  // namespace deadfood::scan
@@ -0,0 +1,31 @@
+#include "field_binding.hh"
+
+#include <deadfood/scan/table_scan.hh>
+
+namespace deadfood::scan {
+
+core::FieldVariant ReadField(const FieldBinding& binding) {
+  for (const auto* flag : binding.null_flags) {
+    if (*flag) {
+      return core::null_t{};
+    }
+  }
+  return binding.scan->Read(binding);
+}
+
+template <typename T>
+bool ReadFieldAs(const FieldBinding& binding, T& out) {
+  for (const auto* flag : binding.null_flags) {
+    if (*flag) {
+      return false;
+    }
+  }
+  return binding.scan->ReadAs(binding, out);
+}
+
+template bool ReadFieldAs(const FieldBinding&, bool&);
+template bool ReadFieldAs(const FieldBinding&, int&);
+template bool ReadFieldAs(const FieldBinding&, float&);
+template bool ReadFieldAs(const FieldBinding&, double&);
+
+}  // namespace deadfood::scan
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <deadfood/core/field.hh>
+
+namespace deadfood::scan {
+
+class TableScan;
+
+// A column reference resolved once when the plan is built: the table scan
+// that owns the column and the column's index in the table. Reading through a
+// binding is a typed load from the current row of `scan`, without the name
+// lookups `IScan::GetField` performs on every call.
+struct FieldBinding {
+  const TableScan* scan;
+  core::Field field;
+  size_t index;
+  // outer joins blank out one of their sides; the value reads as NULL while
+  // any of these flags is set
+  std::vector<const bool*> null_flags;
+};
+
+core::FieldVariant ReadField(const FieldBinding& binding);
+
+// Typed counterpart of `ReadField` for a column whose C++ type is `T` (bool,
+// int, float or double). Returns false if the value is NULL.
+template <typename T>
+bool ReadFieldAs(const FieldBinding& binding, T& out);
+
+}  // namespace deadfood::scan
@@ -0,0 +1,204 @@
+#include "hash_aggregate_scan.hh"
+
+#include <utility>
+
+#include <deadfood/core/field_key.hh>
+#include <deadfood/util/parse.hh>
+
+namespace deadfood::scan {
+
+HashAggregateScan::HashAggregateScan(std::unique_ptr<IScan> input,
+                                     std::vector<Key> keys,
+                                     std::vector<Aggregate> aggregates)
+    : input_{std::move(input)},
+      keys_{std::move(keys)},
+      aggregates_{std::move(aggregates)},
+      built_{false},
+      group_count_{0},
+      row_keys_(keys_.size()),
+      group_{0},
+      before_start_{true} {}
+
+void HashAggregateScan::Build() {
+  group_count_ = 0;
+  group_keys_.clear();
+  states_.clear();
+  slots_.Clear();
+
+  input_->BeforeFirst();
+  if (keys_.empty()) {
+    // a single group, updated in place
+    FindOrAddGroup(0);
+    while (input_->Next()) {
+      Accumulate(0);
+    }
+    built_ = true;
+    return;
+  }
+
+  const core::FieldKeyHash hash;
+  while (input_->Next()) {
+    size_t row_hash = 0;
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      row_keys_[i] = keys_[i].expr->Eval();
+      row_hash = row_hash * 31 + hash(row_keys_[i]);
+    }
+    Accumulate(FindOrAddGroup(core::MixHash(row_hash)));
+  }
+  built_ = true;
+}
+
+size_t HashAggregateScan::FindOrAddGroup(size_t hash) {
+  const core::FieldKeyEqual equal;
+  const auto [group, added] = slots_.FindOrAdd(hash, [&](size_t other) {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      if (!equal(group_keys_[other * keys_.size() + i], row_keys_[i])) {
+        return false;
+      }
+    }
+    return true;
+  });
+  if (added) {
+    ++group_count_;
+    group_keys_.insert(group_keys_.end(), row_keys_.begin(), row_keys_.end());
+    states_.resize(states_.size() + aggregates_.size(),
+                   State{.count = 0,
+                         .int_sum = 0,
+                         .double_sum = 0,
+                         .has_double = false,
+                         .extreme = core::null_t{}});
+  }
+  return group;
+}
+
+void HashAggregateScan::Accumulate(size_t group) {
+  const core::FieldKeyLess less;
+  for (size_t i = 0; i < aggregates_.size(); ++i) {
+    auto& aggregate = aggregates_[i];
+    auto& state = states_[group * aggregates_.size() + i];
+    if (aggregate.arg == nullptr) {
+      ++state.count;
+      continue;
+    }
+    auto value = aggregate.arg->Eval();
+    if (std::holds_alternative<core::null_t>(value)) {
+      continue;
+    }
+    ++state.count;
+    switch (aggregate.fn) {
+      case expr::AggregateFn::Count:
+        break;
+      case expr::AggregateFn::Sum:
+      case expr::AggregateFn::Avg:
+        if (const auto* i_value = std::get_if<int>(&value)) {
+          state.int_sum += *i_value;
+        } else if (const auto* b_value = std::get_if<bool>(&value)) {
+          state.int_sum += *b_value ? 1 : 0;
+        } else if (const auto* f_value = std::get_if<float>(&value)) {
+          state.double_sum += static_cast<double>(*f_value);
+          state.has_double = true;
+        } else if (const auto* d_value = std::get_if<double>(&value)) {
+          state.double_sum += *d_value;
+          state.has_double = true;
+        } else {
+          throw std::runtime_error("cannot sum not numbers");
+        }
+        break;
+      case expr::AggregateFn::Min:
+        if (std::holds_alternative<core::null_t>(state.extreme) ||
+            less(value, state.extreme)) {
+          state.extreme = std::move(value);
+        }
+        break;
+      case expr::AggregateFn::Max:
+        if (std::holds_alternative<core::null_t>(state.extreme) ||
+            less(state.extreme, value)) {
+          state.extreme = std::move(value);
+        }
+        break;
+    }
+  }
+}
+
+core::FieldVariant HashAggregateScan::Result(size_t group,
+                                             size_t aggregate) const {
+  const auto& state = states_[group * aggregates_.size() + aggregate];
+  switch (aggregates_[aggregate].fn) {
+    case expr::AggregateFn::Count:
+      return static_cast<int>(state.count);
+    case expr::AggregateFn::Sum:
+      if (state.count == 0) {
+        return core::null_t{};
+      }
+      // INTs whose sum does not fit in an INT add up to a double
+      if (state.has_double || !std::in_range<int>(state.int_sum)) {
+        return static_cast<double>(state.int_sum) + state.double_sum;
+      }
+      return static_cast<int>(state.int_sum);
+    case expr::AggregateFn::Avg:
+      if (state.count == 0) {
+        return core::null_t{};
+      }
+      return (static_cast<double>(state.int_sum) + state.double_sum) /
+             static_cast<double>(state.count);
+    case expr::AggregateFn::Min:
+    case expr::AggregateFn::Max:
+      return state.extreme;
+  }
+  return core::null_t{};
+}
+
+void HashAggregateScan::Rewind() {
+  // the groups are kept: the input does not change while a query runs
+  group_ = 0;
+  before_start_ = true;
+}
+
+bool HashAggregateScan::Next() {
+  if (!built_) {
+    Build();
+  }
+  if (before_start_) {
+    before_start_ = false;
+  } else if (group_ < group_count_) {
+    ++group_;
+  }
+  return group_ < group_count_;
+}
+
+std::optional<size_t> HashAggregateScan::FieldIndex(
+    const std::string& field_name) const {
+  for (size_t i = 0; i < aggregates_.size(); ++i) {
+    if (aggregates_[i].name == field_name) {
+      return keys_.size() + i;
+    }
+  }
+  return parse::util::FindFieldName(keys_, field_name, &Key::name);
+}
+
+bool HashAggregateScan::HasField(const std::string& field_name) const {
+  return FieldIndex(field_name).has_value();
+}
+
+core::FieldVariant HashAggregateScan::GetField(
+    const std::string& field_name) const {
+  const auto index = FieldIndex(field_name);
+  if (before_start_ || group_ >= group_count_ || !index.has_value()) {
+    return core::null_t{};
+  }
+  if (index.value() < keys_.size()) {
+    return group_keys_[group_ * keys_.size() + index.value()];
+  }
+  return Result(group_, index.value() - keys_.size());
+}
+
+void HashAggregateScan::SetField(const std::string& /*field_name*/,
+                                 const core::FieldVariant& /*value*/) {}
+
+void HashAggregateScan::Insert() {}
+
+void HashAggregateScan::Delete() {}
+
+void HashAggregateScan::Close() { input_->Close(); }
+
+}  // namespace deadfood::scan
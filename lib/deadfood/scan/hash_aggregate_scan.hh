@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <deadfood/core/slot_table.hh>
+#include <deadfood/expr/expr_tree.hh>
+#include <deadfood/expr/iexpr.hh>
+#include <deadfood/scan/iscan.hh>
+
+namespace deadfood::scan {
+
+// Groups the rows of `input` by the values of the `keys` and computes the
+// `aggregates` of every group. The groups live in an open-addressing hash
+// table of group numbers; their keys and running states are kept in flat
+// arrays, one entry per group. Without keys all rows form a single group,
+// which is accumulated in one pass without hashing and is produced even if
+// the input is empty.
+//
+// A row of the result has the key values under the key names and the
+// aggregate results under theirs. Groups come out in the order they were
+// first seen.
+class HashAggregateScan : public IScan {
+ public:
+  struct Key {
+    std::string name;
+    std::unique_ptr<expr::IExpr> expr;
+  };
+  struct Aggregate {
+    std::string name;
+    expr::AggregateFn fn;
+    // nullptr for COUNT(*)
+    std::unique_ptr<expr::IExpr> arg;
+  };
+
+  HashAggregateScan(std::unique_ptr<IScan> input, std::vector<Key> keys,
+                    std::vector<Aggregate> aggregates);
+
+  void Rewind() override;
+  bool Next() override;
+
+  [[nodiscard]] bool HasField(const std::string& field_name) const override;
+  [[nodiscard]] core::FieldVariant GetField(
+      const std::string& field_name) const override;
+  void SetField(const std::string& field_name,
+                const core::FieldVariant& value) override;
+
+  void Insert() override;
+  void Delete() override;
+
+  void Close() override;
+
+ private:
+  // running state of one aggregate of one group
+  struct State {
+    size_t count;
+    int64_t int_sum;
+    double double_sum;
+    bool has_double;
+    // MIN / MAX so far
+    core::FieldVariant extreme;
+  };
+
+  void Build();
+  size_t FindOrAddGroup(size_t hash);
+  void Accumulate(size_t group);
+  [[nodiscard]] core::FieldVariant Result(size_t group,
+                                          size_t aggregate) const;
+  [[nodiscard]] std::optional<size_t> FieldIndex(
+      const std::string& field_name) const;
+
+  std::unique_ptr<IScan> input_;
+  std::vector<Key> keys_;
+  std::vector<Aggregate> aggregates_;
+
+  bool built_;
+  size_t group_count_;
+  // group `g` has keys group_keys_[g * keys_.size() ...] and states
+  // states_[g * aggregates_.size() ...]
+  std::vector<core::FieldVariant> group_keys_;
+  std::vector<State> states_;
+  // group numbers by the hash of their keys
+  core::SlotTable slots_;
+  // keys of the current input row
+  std::vector<core::FieldVariant> row_keys_;
+
+  size_t group_;
+  bool before_start_;
+};
+
+}  // namespace deadfood::scan
@@ -0,0 +1,199 @@
+#include "hash_join_scan.hh"
+
+#include <deadfood/expr/const_expr.hh>
+
+namespace deadfood::scan {
+
+HashJoinScan::HashJoinScan(std::unique_ptr<IScan> probe,
+                           std::unique_ptr<TableScan> build,
+                           std::string probe_field, std::string build_field,
+                           Mode mode)
+    : probe_{std::move(probe)},
+      build_{std::move(build)},
+      probe_field_{std::move(probe_field)},
+      build_field_{std::move(build_field)},
+      mode_{mode},
+      predicate_{std::make_unique<expr::ConstExpr>(true)},
+      built_{false},
+      candidates_{nullptr},
+      candidate_pos_{0},
+      probe_matched_{true},
+      emitting_unmatched_{false},
+      unmatched_pos_{0},
+      probe_null_{false},
+      build_null_{false} {
+  probe_key_ = probe_->BindField(probe_field_);
+}
+
+void HashJoinScan::Build() {
+  const auto key = build_->BindField(build_field_);
+  build_->BeforeFirst();
+  while (build_->Next()) {
+    if (build_filter_.has_value() && !build_filter_->IsTrue()) {
+      continue;
+    }
+    table_[key.has_value() ? ReadField(key.value())
+                           : build_->GetField(build_field_)]
+        .emplace_back(build_rows_.size());
+    build_rows_.emplace_back(build_->row_id());
+  }
+  built_ = true;
+}
+
+void HashJoinScan::Rewind() {
+  // the hash table is kept: the build side is a base table, which does not
+  // change while a query runs
+  probe_->BeforeFirst();
+  build_matched_.assign(build_rows_.size(), false);
+  candidates_ = nullptr;
+  candidate_pos_ = 0;
+  probe_matched_ = true;
+  emitting_unmatched_ = false;
+  unmatched_pos_ = 0;
+  probe_null_ = false;
+  build_null_ = false;
+}
+
+bool HashJoinScan::Next() {
+  if (!built_) {
+    Build();
+    build_matched_.assign(build_rows_.size(), false);
+  }
+  if (emitting_unmatched_) {
+    return NextUnmatchedBuildRow();
+  }
+
+  while (true) {
+    probe_null_ = false;
+    build_null_ = false;
+    while (candidates_ != nullptr && candidate_pos_ < candidates_->size()) {
+      const size_t pos = (*candidates_)[candidate_pos_++];
+      if (!build_->MoveToRowId(build_rows_[pos])) {
+        continue;
+      }
+      if (!predicate_.IsTrue()) {
+        continue;
+      }
+      probe_matched_ = true;
+      build_matched_[pos] = true;
+      return true;
+    }
+
+    if (mode_ == Mode::PreserveProbe && !probe_matched_) {
+      probe_matched_ = true;
+      build_null_ = true;
+      return true;
+    }
+
+    if (!probe_->Next()) {
+      break;
+    }
+    probe_matched_ = false;
+    const auto it = table_.find(probe_key_.has_value()
+                                    ? ReadField(probe_key_.value())
+                                    : probe_->GetField(probe_field_));
+    candidates_ = it == table_.end() ? nullptr : &it->second;
+    candidate_pos_ = 0;
+  }
+
+  candidates_ = nullptr;
+  if (mode_ != Mode::PreserveBuild) {
+    return false;
+  }
+  emitting_unmatched_ = true;
+  return NextUnmatchedBuildRow();
+}
+
+bool HashJoinScan::NextUnmatchedBuildRow() {
+  probe_null_ = true;
+  build_null_ = false;
+  while (unmatched_pos_ < build_rows_.size()) {
+    const size_t pos = unmatched_pos_++;
+    if (!build_matched_[pos] && build_->MoveToRowId(build_rows_[pos])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HashJoinScan::NextBatch(ColumnBatch& batch) {
+  // each field is looked up in the inputs once per batch, not once per row
+  enum class Side { Probe, Build, None };
+  std::vector<Side> sides;
+  for (const auto& field_name : batch.fields()) {
+    sides.emplace_back(probe_->HasField(field_name)   ? Side::Probe
+                       : build_->HasField(field_name) ? Side::Build
+                                                      : Side::None);
+  }
+
+  batch.Clear();
+  size_t size = 0;
+  while (size < batch.capacity() && Next()) {
+    for (size_t i = 0; i < sides.size(); ++i) {
+      const auto& field_name = batch.fields()[i];
+      if (sides[i] == Side::Probe && !probe_null_) {
+        batch.column(i).Append(probe_->GetField(field_name));
+      } else if (sides[i] == Side::Build && !build_null_) {
+        batch.column(i).Append(build_->GetField(field_name));
+      } else {
+        batch.column(i).Append(core::null_t{});
+      }
+    }
+    ++size;
+  }
+  batch.SetSize(size);
+  return size != 0;
+}
+
+bool HashJoinScan::HasField(const std::string& field_name) const {
+  return probe_->HasField(field_name) || build_->HasField(field_name);
+}
+
+std::optional<FieldBinding> HashJoinScan::BindField(
+    const std::string& field_name) const {
+  auto binding = probe_->HasField(field_name) ? probe_->BindField(field_name)
+                                              : build_->BindField(field_name);
+  if (binding.has_value()) {
+    binding->null_flags.emplace_back(binding->scan == build_.get()
+                                         ? &build_null_
+                                         : &probe_null_);
+  }
+  return binding;
+}
+
+core::FieldVariant HashJoinScan::GetField(const std::string& field_name) const {
+  if (probe_->HasField(field_name)) {
+    return probe_null_ ? core::null_t{} : probe_->GetField(field_name);
+  }
+  if (build_->HasField(field_name) && !build_null_) {
+    return build_->GetField(field_name);
+  }
+  return core::null_t{};
+}
+
+void HashJoinScan::SetField(const std::string& field_name,
+                            const core::FieldVariant& value) {
+  if (probe_->HasField(field_name)) {
+    probe_->SetField(field_name, value);
+    return;
+  }
+  build_->SetField(field_name, value);
+}
+
+void HashJoinScan::Insert() {}
+void HashJoinScan::Delete() {}
+
+void HashJoinScan::Close() {
+  probe_->Close();
+  build_->Close();
+}
+
+void HashJoinScan::set_predicate(std::unique_ptr<expr::IExpr> expr) {
+  predicate_ = expr::BoolExpr(std::move(expr));
+}
+
+void HashJoinScan::set_build_filter(std::unique_ptr<expr::IExpr> expr) {
+  build_filter_.emplace(std::move(expr));
+}
+
+}  // namespace deadfood::scan
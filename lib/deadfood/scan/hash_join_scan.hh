@@ -0,0 +1,81 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <deadfood/core/field_key.hh>
+#include <deadfood/expr/bool_expr.hh>
+#include <deadfood/scan/iscan.hh>
+#include <deadfood/scan/table_scan.hh>
+
+namespace deadfood::scan {
+
+// Equi-join of an arbitrary `probe` input with a table. The rows of `build`
+// are hashed by `build_field` once; every probe row then only visits the rows
+// whose key equals its `probe_field` value. The join predicate is still
+// evaluated on those candidate pairs, so it may contain more than the key
+// equality.
+class HashJoinScan : public IScan {
+ public:
+  enum class Mode {
+    Inner,
+    // probe rows without a match are emitted once with NULL build fields
+    PreserveProbe,
+    // build rows without a match are emitted after all matches with NULL
+    // probe fields
+    PreserveBuild
+  };
+
+  HashJoinScan(std::unique_ptr<IScan> probe, std::unique_ptr<TableScan> build,
+               std::string probe_field, std::string build_field, Mode mode);
+
+  void Rewind() override;
+  bool Next() override;
+  bool NextBatch(ColumnBatch& batch) override;
+  bool HasField(const std::string& field_name) const override;
+  core::FieldVariant GetField(const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
+  void SetField(const std::string& field_name,
+                const core::FieldVariant& value) override;
+  void Insert() override;
+  void Delete() override;
+  void Close() override;
+
+  void set_predicate(std::unique_ptr<expr::IExpr> expr);
+  // rows of `build` failing `expr` are left out of the hash table, so they
+  // are neither matched nor emitted as unmatched build rows
+  void set_build_filter(std::unique_ptr<expr::IExpr> expr);
+
+ private:
+  void Build();
+  bool NextUnmatchedBuildRow();
+
+  std::unique_ptr<IScan> probe_;
+  std::unique_ptr<TableScan> build_;
+  std::string probe_field_;
+  std::string build_field_;
+  // the join key of the probe side, resolved once
+  std::optional<FieldBinding> probe_key_;
+  Mode mode_;
+  expr::BoolExpr predicate_;
+  std::optional<expr::BoolExpr> build_filter_;
+
+  bool built_;
+  // rowids of `build_` in scan order; the hash table stores positions in it
+  std::vector<size_t> build_rows_;
+  std::vector<bool> build_matched_;
+  std::unordered_map<core::FieldVariant, std::vector<size_t>,
+                     core::FieldKeyHash, core::FieldKeyEqual>
+      table_;
+
+  const std::vector<size_t>* candidates_;
+  size_t candidate_pos_;
+  bool probe_matched_;
+  bool emitting_unmatched_;
+  size_t unmatched_pos_;
+  bool probe_null_;
+  bool build_null_;
+};
+
+}  // namespace deadfood::scan
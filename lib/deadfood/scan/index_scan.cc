@@ -0,0 +1,55 @@
+#include "index_scan.hh"
+
+namespace deadfood::scan {
+
+IndexScan::IndexScan(std::unique_ptr<TableScan> internal,
+                     std::vector<size_t> row_ids)
+    : internal_{std::move(internal)},
+      row_ids_{std::move(row_ids)},
+      pos_{0},
+      before_first_{true} {}
+
+size_t IndexScan::row_id() const { return internal_->row_id(); }
+
+void IndexScan::Rewind() { before_first_ = true; }
+
+bool IndexScan::Next() {
+  if (before_first_) {
+    before_first_ = false;
+    pos_ = 0;
+  } else if (pos_ < row_ids_.size()) {
+    ++pos_;
+  }
+
+  while (pos_ < row_ids_.size() && !internal_->MoveToRowId(row_ids_[pos_])) {
+    ++pos_;
+  }
+  return pos_ < row_ids_.size();
+}
+
+bool IndexScan::HasField(const std::string& field_name) const {
+  return internal_->HasField(field_name);
+}
+
+std::optional<FieldBinding> IndexScan::BindField(
+    const std::string& field_name) const {
+  return internal_->BindField(field_name);
+}
+
+core::FieldVariant IndexScan::GetField(const std::string& field_name) const {
+  if (before_first_ || pos_ >= row_ids_.size()) {
+    return core::null_t{};
+  }
+  return internal_->GetField(field_name);
+}
+
+void IndexScan::SetField(const std::string& field_name,
+                         const core::FieldVariant& value) {
+  internal_->SetField(field_name, value);
+}
+
+void IndexScan::Insert() { internal_->Insert(); }
+void IndexScan::Delete() { internal_->Delete(); }
+void IndexScan::Close() { internal_->Close(); }
+
+}  // namespace deadfood::scan
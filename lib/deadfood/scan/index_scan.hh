@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include <deadfood/scan/iscan.hh>
+#include <deadfood/scan/table_scan.hh>
+
+namespace deadfood::scan {
+
+// Visits only the rows with the given ids, in the given order. The ids are
+// usually obtained from an index lookup; rows deleted in the meantime are
+// skipped.
+class IndexScan : public IScan {
+ public:
+  IndexScan(std::unique_ptr<TableScan> internal, std::vector<size_t> row_ids);
+
+  // id of the current row
+  [[nodiscard]] size_t row_id() const;
+
+  void Rewind() override;
+  bool Next() override;
+  bool HasField(const std::string& field_name) const override;
+  core::FieldVariant GetField(const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
+  void SetField(const std::string& field_name,
+                const core::FieldVariant& value) override;
+  void Insert() override;
+  void Delete() override;
+  void Close() override;
+
+ private:
+  std::unique_ptr<TableScan> internal_;
+  std::vector<size_t> row_ids_;
+  size_t pos_;
+  bool before_first_;
+};
+
+}  // namespace deadfood::scan
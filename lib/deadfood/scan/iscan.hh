@@ -1,25 +1,74 @@
 #pragma once
 
+#include <optional>
+
 #include <deadfood/core/field.hh>
+#include <deadfood/scan/column_batch.hh>
+#include <deadfood/scan/field_binding.hh>
 
 namespace deadfood::scan {
 
 
 class IScan {
  public:
-  virtual void BeforeFirst() = 0;
+  // moves the scan before its first row
+  void BeforeFirst() {
+    exhausted_ = false;
+    Rewind();
+  }
   virtual bool Next() = 0;
 
   [[nodiscard]] virtual bool HasField(const std::string& field_name) const = 0;
   [[nodiscard]] virtual core::FieldVariant GetField(const std::string& field_name) const = 0;
   virtual void SetField(const std::string& field_name, const core::FieldVariant& value) = 0;
 
+  // Resolves `field_name` to the table column it is read from, if there is
+  // one. Scans that compute a field themselves return nothing, and callers
+  // keep using `GetField` for it.
+  [[nodiscard]] virtual std::optional<FieldBinding> BindField(
+      const std::string& /*field_name*/) const {
+    return std::nullopt;
+  }
+
+  // Fills `batch` with up to `batch.capacity()` next rows and selects those
+  // that belong to the result. Returns false once the scan is exhausted,
+  // otherwise at least one row is selected. Fields the scan does not have
+  // are NULL. This default goes row by row, and once `Next` returns false it
+  // is not called again before `BeforeFirst`; scans override it to work on
+  // whole columns.
+  virtual bool NextBatch(ColumnBatch& batch) {
+    batch.Clear();
+    size_t size = 0;
+    while (size < batch.capacity() && !exhausted_) {
+      if (!Next()) {
+        exhausted_ = true;
+        break;
+      }
+      for (size_t i = 0; i < batch.fields().size(); ++i) {
+        const auto& field_name = batch.fields()[i];
+        batch.column(i).Append(HasField(field_name) ? GetField(field_name)
+                                                    : core::null_t{});
+      }
+      ++size;
+    }
+    batch.SetSize(size);
+    return size != 0;
+  }
+
   virtual void Insert() = 0;
   virtual void Delete() = 0;
 
   virtual void Close() = 0;
 
   virtual ~IScan() = default;
+
+ protected:
+  // what `BeforeFirst` does for the scan
+  virtual void Rewind() = 0;
+
+ private:
+  // whether the default `NextBatch` saw the last row
+  bool exhausted_ = false;
 };
 
-}  // namespace deadfood::scan
\ No newline at end of file
+}  // namespace deadfood::scan
@@ -15,21 +15,19 @@ LeftJoinScan::LeftJoinScan(std::unique_ptr<IScan> lhs,
       cur_lhs_has_rhs_{false},
       rhs_null_{false} {}
 
-void LeftJoinScan::BeforeFirst() {
+void LeftJoinScan::Rewind() {
   lhs_->BeforeFirst();
   lhs_has_row_ = lhs_->Next();
   rhs_->BeforeFirst();
   cur_lhs_has_rhs_ = false;
+  rhs_null_ = false;
 }
 
 bool FindMatchingRhs(IScan* rhs, expr::BoolExpr& predicate) {
   while (rhs->Next()) {
-    auto result = predicate.Eval();
-    if (std::holds_alternative<core::null_t>(result) ||
-        !std::get<bool>(result)) {
-      continue;
+    if (predicate.IsTrue()) {
+      return true;
     }
-    return true;
   }
   return false;
 }
@@ -42,6 +40,7 @@ bool LeftJoinScan::Next() {
   if (rhs_null_) {
     rhs_null_ = false;
     if (!lhs_->Next()) {
+      lhs_has_row_ = false;
       return false;
     }
     cur_lhs_has_rhs_ = false;
@@ -53,6 +52,7 @@ bool LeftJoinScan::Next() {
     return true;
   } else if (cur_lhs_has_rhs_) {
     if (!lhs_->Next()) {
+      lhs_has_row_ = false;
       return false;
     }
     cur_lhs_has_rhs_ = false;
@@ -71,6 +71,18 @@ bool LeftJoinScan::HasField(const std::string& field_name) const {
   return lhs_->HasField(field_name) || rhs_->HasField(field_name);
 }
 
+std::optional<FieldBinding> LeftJoinScan::BindField(
+    const std::string& field_name) const {
+  if (lhs_->HasField(field_name)) {
+    return lhs_->BindField(field_name);
+  }
+  auto binding = rhs_->BindField(field_name);
+  if (binding.has_value()) {
+    binding->null_flags.emplace_back(&rhs_null_);
+  }
+  return binding;
+}
+
 core::FieldVariant LeftJoinScan::GetField(const std::string& field_name) const {
   if (lhs_->HasField(field_name)) {
     return lhs_->GetField(field_name);
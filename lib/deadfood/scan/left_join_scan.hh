@@ -9,10 +9,12 @@ class LeftJoinScan : public IScan {
  public:
   LeftJoinScan(std::unique_ptr<IScan> lhs, std::unique_ptr<IScan> rhs, std::unique_ptr<expr::IExpr> expr);
 
-  void BeforeFirst() override;
+  void Rewind() override;
   bool Next() override;
   bool HasField(const std::string& field_name) const override;
   core::FieldVariant GetField(const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
   void SetField(const std::string& field_name,
                 const core::FieldVariant& value) override;
   void Insert() override;
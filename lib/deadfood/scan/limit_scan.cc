@@ -0,0 +1,97 @@
+#include "limit_scan.hh"
+
+#include <algorithm>
+
+namespace deadfood::scan {
+
+LimitScan::LimitScan(std::unique_ptr<IScan> input, std::optional<size_t> limit,
+                     size_t offset)
+    : input_{std::move(input)},
+      limit_{limit},
+      offset_{offset},
+      to_skip_{offset},
+      returned_{0} {}
+
+void LimitScan::Rewind() {
+  input_->BeforeFirst();
+  to_skip_ = offset_;
+  returned_ = 0;
+}
+
+bool LimitScan::Exhausted() const {
+  return limit_.has_value() && returned_ >= limit_.value();
+}
+
+bool LimitScan::Next() {
+  if (Exhausted()) {
+    return false;
+  }
+  for (; to_skip_ > 0; --to_skip_) {
+    if (!input_->Next()) {
+      return false;
+    }
+  }
+  if (!input_->Next()) {
+    return false;
+  }
+  ++returned_;
+  return true;
+}
+
+bool LimitScan::NextBatch(ColumnBatch& batch) {
+  const size_t capacity = batch.capacity();
+  while (!Exhausted()) {
+    size_t wanted = capacity;
+    if (limit_.has_value()) {
+      wanted = std::min(wanted, to_skip_ + limit_.value() - returned_);
+    }
+    batch.set_capacity(wanted);
+    const bool has_rows = input_->NextBatch(batch);
+    batch.set_capacity(capacity);
+    if (!has_rows) {
+      return false;
+    }
+
+    auto& selection = batch.selection();
+    const size_t skipped = std::min(to_skip_, selection.size());
+    selection.erase(selection.begin(),
+                    selection.begin() + static_cast<std::ptrdiff_t>(skipped));
+    to_skip_ -= skipped;
+    if (limit_.has_value()) {
+      selection.resize(
+          std::min(selection.size(), limit_.value() - returned_));
+    }
+    returned_ += selection.size();
+    if (!selection.empty()) {
+      return true;
+    }
+  }
+  batch.Clear();
+  return false;
+}
+
+bool LimitScan::HasField(const std::string& field_name) const {
+  return input_->HasField(field_name);
+}
+
+core::FieldVariant LimitScan::GetField(const std::string& field_name) const {
+  return input_->GetField(field_name);
+}
+
+std::optional<FieldBinding> LimitScan::BindField(
+    const std::string& field_name) const {
+  return input_->BindField(field_name);
+}
+
+void LimitScan::SetField(const std::string& field_name,
+                         const core::FieldVariant& value) {
+  input_->SetField(field_name, value);
+}
+
+void LimitScan::Insert() { input_->Insert(); }
+
+void LimitScan::Delete() { input_->Delete(); }
+
+void LimitScan::Close() { input_->Close(); }
+
+}  // namespace deadfood::scan
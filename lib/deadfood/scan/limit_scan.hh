@@ -0,0 +1,45 @@
+#pragma once
+
+#include <optional>
+
+#include <deadfood/scan/iscan.hh>
+
+namespace deadfood::scan {
+
+// Skips the first `offset` rows of `input` and returns at most `limit` of the
+// rest. No row is asked of `input` once the limit is reached, and batches are
+// asked for no more rows than are still wanted.
+class LimitScan : public IScan {
+ public:
+  LimitScan(std::unique_ptr<IScan> input, std::optional<size_t> limit,
+            size_t offset);
+
+  void Rewind() override;
+  bool Next() override;
+  bool NextBatch(ColumnBatch& batch) override;
+
+  [[nodiscard]] bool HasField(const std::string& field_name) const override;
+  [[nodiscard]] core::FieldVariant GetField(
+      const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
+  void SetField(const std::string& field_name,
+                const core::FieldVariant& value) override;
+
+  void Insert() override;
+  void Delete() override;
+
+  void Close() override;
+
+ private:
+  [[nodiscard]] bool Exhausted() const;
+
+  std::unique_ptr<IScan> input_;
+  std::optional<size_t> limit_;
+  size_t offset_;
+
+  size_t to_skip_;
+  size_t returned_;
+};
+
+}  // namespace deadfood::scan
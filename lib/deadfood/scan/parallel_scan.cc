@@ -0,0 +1,132 @@
+#include "parallel_scan.hh"
+
+#include <algorithm>
+
+#include <deadfood/util/parse.hh>
+
+namespace deadfood::scan {
+
+// morsels dealt to every worker per wave, so stealing can even out the load
+constexpr size_t kMorselsPerWorker = 4;
+
+ParallelScan::ParallelScan(storage::TableStorage& storage,
+                           const core::Schema& schema,
+                           const std::string& table_name,
+                           const PipelineBuilder& build,
+                           std::vector<std::string> fields,
+                           util::ThreadPool& pool, size_t morsel_slots)
+    : storage_{storage},
+      table_name_{table_name},
+      fields_{std::move(fields)},
+      pool_{pool},
+      morsel_slots_{std::max<size_t>(morsel_slots, 1)},
+      morsel_count_{0},
+      next_morsel_{0},
+      morsel_{0},
+      row_{0},
+      before_start_{true} {
+  for (size_t worker = 0; worker < pool_.size(); ++worker) {
+    auto table = std::make_unique<TableScan>(storage, schema, table_name);
+    auto* table_ptr = table.get();
+    pipelines_.push_back(
+        Pipeline{.table = table_ptr, .top = build(std::move(table))});
+  }
+  BeforeFirst();
+}
+
+void ParallelScan::Rewind() {
+  morsel_count_ = (storage_.slot_count() + morsel_slots_ - 1) / morsel_slots_;
+  next_morsel_ = 0;
+  wave_.clear();
+  morsel_ = 0;
+  row_ = 0;
+  before_start_ = true;
+}
+
+bool ParallelScan::Next() {
+  if (before_start_) {
+    before_start_ = false;
+  } else if (morsel_ < wave_.size()) {
+    ++row_;
+  }
+  while (true) {
+    if (morsel_ < wave_.size()) {
+      if (row_ < wave_[morsel_].rows) {
+        return true;
+      }
+      ++morsel_;
+      row_ = 0;
+      continue;
+    }
+    if (next_morsel_ == morsel_count_) {
+      return false;
+    }
+    RunWave();
+  }
+}
+
+void ParallelScan::RunWave() {
+  const size_t first = next_morsel_;
+  const size_t count =
+      std::min(morsel_count_ - first, pool_.size() * kMorselsPerWorker);
+  wave_.assign(count, Morsel{.rows = 0, .values = {}});
+  pool_.Run(count, [&](size_t worker, size_t i) {
+    auto& pipeline = pipelines_[worker];
+    const size_t begin = (first + i) * morsel_slots_;
+    pipeline.table->SetSlotRange(begin, begin + morsel_slots_);
+    pipeline.top->BeforeFirst();
+    auto& morsel = wave_[i];
+    while (pipeline.top->Next()) {
+      ++morsel.rows;
+      for (const auto& field : fields_) {
+        morsel.values.push_back(pipeline.top->GetField(field));
+      }
+    }
+  });
+  next_morsel_ += count;
+  morsel_ = 0;
+  row_ = 0;
+}
+
+std::optional<size_t> ParallelScan::FieldIndex(
+    const std::string& field_name) const {
+  auto it = std::ranges::find(fields_, field_name);
+  if (it == fields_.end()) {
+    const auto [tbl, field] =
+        deadfood::parse::util::GetFullFieldName(field_name);
+    if (tbl.has_value() && tbl.value() == table_name_) {
+      it = std::ranges::find(fields_, field);
+    }
+  }
+  if (it == fields_.end()) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(it - fields_.begin());
+}
+
+bool ParallelScan::HasField(const std::string& field_name) const {
+  return FieldIndex(field_name).has_value();
+}
+
+core::FieldVariant ParallelScan::GetField(const std::string& field_name) const {
+  const auto index = FieldIndex(field_name);
+  if (before_start_ || morsel_ >= wave_.size() || !index.has_value()) {
+    return core::null_t{};
+  }
+  return wave_[morsel_].values[row_ * fields_.size() + index.value()];
+}
+
+void ParallelScan::SetField(const std::string& /*field_name*/,
+                            const core::FieldVariant& /*value*/) {}
+
+void ParallelScan::Insert() {}
+
+void ParallelScan::Delete() {}
+
+void ParallelScan::Close() {
+  for (auto& pipeline : pipelines_) {
+    pipeline.top->Close();
+  }
+}
+
+}  // namespace deadfood::scan
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <deadfood/scan/iscan.hh>
+#include <deadfood/scan/table_scan.hh>
+#include <deadfood/util/thread_pool.hh>
+
+namespace deadfood::scan {
+
+// Runs a pipeline of scans over a table on the workers of a thread pool. The
+// table is cut into morsels, ranges of `morsel_slots` slots, which the workers
+// take in turn. Every worker owns a copy of the pipeline, built by `build` on
+// top of a TableScan of its own, so expressions are never shared between
+// threads. The `fields` of the rows a morsel yields are buffered, and the rows
+// are handed out in table order, a wave of morsels at a time.
+//
+// Fields are looked up by their name in `fields`, earlier names shadowing
+// later ones; a name qualified with `table_name` also finds the unqualified
+// one. The scan is read-only.
+class ParallelScan : public IScan {
+ public:
+  static constexpr size_t kMorselSlots = 1 << 14;
+
+  // `build` is only called from the constructor
+  using PipelineBuilder =
+      std::function<std::unique_ptr<IScan>(std::unique_ptr<TableScan>)>;
+
+  ParallelScan(storage::TableStorage& storage, const core::Schema& schema,
+               const std::string& table_name, const PipelineBuilder& build,
+               std::vector<std::string> fields, util::ThreadPool& pool,
+               size_t morsel_slots = kMorselSlots);
+
+  void Rewind() override;
+  bool Next() override;
+
+  [[nodiscard]] bool HasField(const std::string& field_name) const override;
+  [[nodiscard]] core::FieldVariant GetField(
+      const std::string& field_name) const override;
+  void SetField(const std::string& field_name,
+                const core::FieldVariant& value) override;
+
+  void Insert() override;
+  void Delete() override;
+
+  void Close() override;
+
+ private:
+  struct Pipeline {
+    TableScan* table;
+    std::unique_ptr<IScan> top;
+  };
+  // rows of one morsel, `fields_.size()` values per row
+  struct Morsel {
+    size_t rows;
+    std::vector<core::FieldVariant> values;
+  };
+
+  [[nodiscard]] std::optional<size_t> FieldIndex(
+      const std::string& field_name) const;
+  void RunWave();
+
+  storage::TableStorage& storage_;
+  std::string table_name_;
+  std::vector<std::string> fields_;
+  util::ThreadPool& pool_;
+  size_t morsel_slots_;
+  std::vector<Pipeline> pipelines_;
+  size_t morsel_count_;
+  size_t next_morsel_;
+  std::vector<Morsel> wave_;
+  size_t morsel_;
+  size_t row_;
+  bool before_start_;
+};
+
+}  // namespace deadfood::scan
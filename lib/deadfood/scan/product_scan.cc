@@ -5,7 +5,7 @@ namespace deadfood::scan {
 ProductScan::ProductScan(std::unique_ptr<IScan> lhs, std::unique_ptr<IScan> rhs)
     : lhs_{std::move(lhs)}, rhs_{std::move(rhs)}, lhs_has_rows{lhs_->Next()} {}
 
-void ProductScan::BeforeFirst() {
+void ProductScan::Rewind() {
   lhs_->BeforeFirst();
   lhs_->Next();
   rhs_->BeforeFirst();
@@ -29,6 +29,14 @@ bool ProductScan::HasField(const std::string& field_name) const {
   return lhs_->HasField(field_name) || rhs_->HasField(field_name);
 }
 
+std::optional<FieldBinding> ProductScan::BindField(
+    const std::string& field_name) const {
+  if (lhs_->HasField(field_name)) {
+    return lhs_->BindField(field_name);
+  }
+  return rhs_->BindField(field_name);
+}
+
 core::FieldVariant ProductScan::GetField(const std::string& field_name) const {
   if (lhs_->HasField(field_name)) {
     return lhs_->GetField(field_name);
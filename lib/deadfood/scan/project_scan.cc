@@ -6,10 +6,19 @@ ProjectScan::ProjectScan(std::unique_ptr<IScan> internal,
                          const std::unordered_set<std::string>& fields)
     : internal_{std::move(internal)}, fields_{fields} {}
 
-void ProjectScan::BeforeFirst() { internal_->BeforeFirst(); }
+void ProjectScan::Rewind() { internal_->BeforeFirst(); }
 
 bool ProjectScan::Next() { return internal_->Next(); }
 
+bool ProjectScan::NextBatch(ColumnBatch& batch) {
+  for (const auto& field_name : batch.fields()) {
+    if (!fields_.contains(field_name)) {
+      throw std::runtime_error("no field with name '" + field_name + "'");
+    }
+  }
+  return internal_->NextBatch(batch);
+}
+
 bool ProjectScan::HasField(const std::string& field_name) const {
   if (fields_.contains(field_name)) {
     return internal_->HasField(field_name);
@@ -17,6 +26,14 @@ bool ProjectScan::HasField(const std::string& field_name) const {
   return false;
 }
 
+std::optional<FieldBinding> ProjectScan::BindField(
+    const std::string& field_name) const {
+  if (fields_.contains(field_name)) {
+    return internal_->BindField(field_name);
+  }
+  return std::nullopt;
+}
+
 core::FieldVariant ProjectScan::GetField(const std::string& field_name) const {
   if (fields_.contains(field_name)) {
     return internal_->GetField(field_name);
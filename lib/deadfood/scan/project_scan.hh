@@ -9,10 +9,13 @@ class ProjectScan : public IScan {
  public:
   ProjectScan(std::unique_ptr<IScan> internal, const std::unordered_set<std::string>& fields);
 
-  void BeforeFirst() override;
+  void Rewind() override;
   bool Next() override;
+  bool NextBatch(ColumnBatch& batch) override;
   bool HasField(const std::string& field_name) const override;
   core::FieldVariant GetField(const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
   void SetField(const std::string& field_name,
                 const core::FieldVariant& value) override;
   void Insert() override;
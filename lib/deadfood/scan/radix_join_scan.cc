@@ -0,0 +1,279 @@
+#include "radix_join_scan.hh"
+
+#include <algorithm>
+#include <bit>
+
+#include <deadfood/core/field_key.hh>
+#include <deadfood/expr/const_expr.hh>
+
+namespace deadfood::scan {
+
+// share of the L2 cache the build rows of one partition may take
+constexpr size_t kPartitionBytes = 128 << 10;
+constexpr size_t kMaxRadixBits = 12;
+constexpr size_t kNoEntry = static_cast<size_t>(-1);
+
+RadixJoinScan::RadixJoinScan(std::unique_ptr<TableScan> probe,
+                             std::unique_ptr<TableScan> build,
+                             std::string probe_field, std::string build_field,
+                             Mode mode, util::ThreadPool& pool,
+                             std::optional<size_t> radix_bits)
+    : probe_{std::move(probe)},
+      build_{std::move(build)},
+      probe_field_{std::move(probe_field)},
+      build_field_{std::move(build_field)},
+      mode_{mode},
+      pool_{pool},
+      radix_bits_{radix_bits},
+      predicate_{std::make_unique<expr::ConstExpr>(true)},
+      joined_{false},
+      probe_pos_{0},
+      candidate_pos_{0},
+      probe_has_row_{false},
+      probe_matched_{true},
+      emitting_unmatched_{false},
+      unmatched_pos_{0},
+      probe_null_{false},
+      build_null_{false} {}
+
+RadixJoinScan::Partitions RadixJoinScan::Partition(
+    const TableScan& scan, const std::string& field) const {
+  const size_t partitions = size_t{1} << radix_bits_.value();
+  const size_t morsels = (scan.slot_count() + kMorselSlots - 1) / kMorselSlots;
+  std::vector<std::unique_ptr<TableScan>> scans;
+  for (size_t worker = 0; worker < pool_.size(); ++worker) {
+    scans.push_back(scan.Clone());
+  }
+
+  // every morsel gathers its rows and counts them per partition...
+  std::vector<std::vector<Entry>> gathered(morsels);
+  std::vector<std::vector<size_t>> counts(morsels,
+                                          std::vector<size_t>(partitions));
+  pool_.Run(morsels, [&](size_t worker, size_t morsel) {
+    auto& morsel_scan = *scans[worker];
+    const auto key = morsel_scan.BindField(field).value();
+    morsel_scan.SetSlotRange(morsel * kMorselSlots,
+                             (morsel + 1) * kMorselSlots);
+    morsel_scan.BeforeFirst();
+    while (morsel_scan.Next()) {
+      auto value = morsel_scan.Read(key);
+      const size_t hash = core::MixHash(core::FieldKeyHash{}(value));
+      ++counts[morsel][hash & (partitions - 1)];
+      gathered[morsel].push_back(Entry{.row_id = morsel_scan.row_id(),
+                                       .hash = hash,
+                                       .key = std::move(value)});
+    }
+  });
+
+  // ...so that it knows where to put them, keeping the table order within
+  // every partition
+  Partitions ret;
+  ret.starts.assign(partitions + 1, 0);
+  std::vector<std::vector<size_t>> offsets(morsels,
+                                           std::vector<size_t>(partitions));
+  size_t total = 0;
+  for (size_t partition = 0; partition < partitions; ++partition) {
+    ret.starts[partition] = total;
+    for (size_t morsel = 0; morsel < morsels; ++morsel) {
+      offsets[morsel][partition] = total;
+      total += counts[morsel][partition];
+    }
+  }
+  ret.starts[partitions] = total;
+  ret.entries.resize(total);
+  pool_.Run(morsels, [&](size_t, size_t morsel) {
+    for (auto& entry : gathered[morsel]) {
+      auto& offset = offsets[morsel][entry.hash & (partitions - 1)];
+      ret.entries[offset++] = std::move(entry);
+    }
+  });
+  return ret;
+}
+
+void RadixJoinScan::Join() {
+  if (!radix_bits_.has_value()) {
+    const size_t bytes =
+        build_->row_count() * (sizeof(Entry) + 2 * sizeof(size_t));
+    radix_bits_ = std::min<size_t>(std::bit_width(bytes / kPartitionBytes),
+                                   kMaxRadixBits);
+  }
+  probe_rows_ = Partition(*probe_, probe_field_);
+  build_rows_ = Partition(*build_, build_field_);
+
+  const size_t partitions = size_t{1} << radix_bits_.value();
+  std::vector<std::vector<size_t>> starts(partitions);
+  std::vector<std::vector<size_t>> candidates(partitions);
+  pool_.Run(partitions, [&](size_t, size_t partition) {
+    const size_t build_begin = build_rows_.starts[partition];
+    const size_t build_size = build_rows_.starts[partition + 1] - build_begin;
+    // chained hash table over the partition, the chains in table order
+    const size_t buckets = std::bit_ceil(std::max<size_t>(build_size, 1));
+    std::vector<size_t> heads(buckets, kNoEntry);
+    std::vector<size_t> next(build_size);
+    for (size_t i = build_size; i-- > 0;) {
+      const auto& entry = build_rows_.entries[build_begin + i];
+      auto& head = heads[(entry.hash >> radix_bits_.value()) & (buckets - 1)];
+      next[i] = head;
+      head = i;
+    }
+
+    const core::FieldKeyEqual equal;
+    for (size_t pos = probe_rows_.starts[partition];
+         pos < probe_rows_.starts[partition + 1]; ++pos) {
+      const auto& entry = probe_rows_.entries[pos];
+      starts[partition].push_back(candidates[partition].size());
+      for (size_t i =
+               heads[(entry.hash >> radix_bits_.value()) & (buckets - 1)];
+           i != kNoEntry; i = next[i]) {
+        const auto& build_entry = build_rows_.entries[build_begin + i];
+        if (build_entry.hash == entry.hash &&
+            equal(build_entry.key, entry.key)) {
+          candidates[partition].push_back(build_begin + i);
+        }
+      }
+    }
+  });
+
+  candidate_starts_.clear();
+  candidates_.clear();
+  for (size_t partition = 0; partition < partitions; ++partition) {
+    for (const size_t start : starts[partition]) {
+      candidate_starts_.push_back(candidates_.size() + start);
+    }
+    candidates_.insert(candidates_.end(), candidates[partition].begin(),
+                       candidates[partition].end());
+  }
+  candidate_starts_.push_back(candidates_.size());
+  joined_ = true;
+}
+
+void RadixJoinScan::Rewind() {
+  // the partitions are kept: both inputs are base tables, which do not change
+  // while a query runs
+  build_matched_.assign(build_rows_.entries.size(), false);
+  probe_pos_ = 0;
+  candidate_pos_ = 0;
+  probe_has_row_ = false;
+  probe_matched_ = true;
+  emitting_unmatched_ = false;
+  unmatched_pos_ = 0;
+  probe_null_ = false;
+  build_null_ = false;
+}
+
+bool RadixJoinScan::Next() {
+  if (!joined_) {
+    Join();
+    BeforeFirst();
+  }
+  if (emitting_unmatched_) {
+    return NextUnmatchedBuildRow();
+  }
+
+  while (true) {
+    probe_null_ = false;
+    build_null_ = false;
+    if (probe_has_row_) {
+      while (candidate_pos_ < candidate_starts_[probe_pos_ + 1]) {
+        const size_t pos = candidates_[candidate_pos_++];
+        if (!build_->MoveToRowId(build_rows_.entries[pos].row_id)) {
+          continue;
+        }
+        if (!predicate_.IsTrue()) {
+          continue;
+        }
+        probe_matched_ = true;
+        build_matched_[pos] = true;
+        return true;
+      }
+      if (mode_ == Mode::PreserveProbe && !probe_matched_) {
+        probe_matched_ = true;
+        build_null_ = true;
+        return true;
+      }
+      ++probe_pos_;
+    }
+
+    if (probe_pos_ == probe_rows_.entries.size()) {
+      break;
+    }
+    probe_has_row_ =
+        probe_->MoveToRowId(probe_rows_.entries[probe_pos_].row_id);
+    if (!probe_has_row_) {
+      ++probe_pos_;
+      continue;
+    }
+    probe_matched_ = false;
+    candidate_pos_ = candidate_starts_[probe_pos_];
+  }
+
+  probe_has_row_ = false;
+  if (mode_ != Mode::PreserveBuild) {
+    return false;
+  }
+  emitting_unmatched_ = true;
+  return NextUnmatchedBuildRow();
+}
+
+bool RadixJoinScan::NextUnmatchedBuildRow() {
+  probe_null_ = true;
+  build_null_ = false;
+  while (unmatched_pos_ < build_rows_.entries.size()) {
+    const size_t pos = unmatched_pos_++;
+    if (!build_matched_[pos] &&
+        build_->MoveToRowId(build_rows_.entries[pos].row_id)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RadixJoinScan::HasField(const std::string& field_name) const {
+  return probe_->HasField(field_name) || build_->HasField(field_name);
+}
+
+std::optional<FieldBinding> RadixJoinScan::BindField(
+    const std::string& field_name) const {
+  auto binding = probe_->HasField(field_name) ? probe_->BindField(field_name)
+                                              : build_->BindField(field_name);
+  if (binding.has_value()) {
+    binding->null_flags.emplace_back(binding->scan == build_.get()
+                                         ? &build_null_
+                                         : &probe_null_);
+  }
+  return binding;
+}
+
+core::FieldVariant RadixJoinScan::GetField(
+    const std::string& field_name) const {
+  if (probe_->HasField(field_name)) {
+    return probe_null_ ? core::null_t{} : probe_->GetField(field_name);
+  }
+  if (build_->HasField(field_name) && !build_null_) {
+    return build_->GetField(field_name);
+  }
+  return core::null_t{};
+}
+
+void RadixJoinScan::SetField(const std::string& field_name,
+                             const core::FieldVariant& value) {
+  if (probe_->HasField(field_name)) {
+    probe_->SetField(field_name, value);
+    return;
+  }
+  build_->SetField(field_name, value);
+}
+
+void RadixJoinScan::Insert() {}
+void RadixJoinScan::Delete() {}
+
+void RadixJoinScan::Close() {
+  probe_->Close();
+  build_->Close();
+}
+
+void RadixJoinScan::set_predicate(std::unique_ptr<expr::IExpr> expr) {
+  predicate_ = expr::BoolExpr(std::move(expr));
+}
+
+}  // namespace deadfood::scan
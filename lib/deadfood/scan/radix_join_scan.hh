@@ -0,0 +1,93 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include <deadfood/expr/bool_expr.hh>
+#include <deadfood/scan/hash_join_scan.hh>
+#include <deadfood/scan/iscan.hh>
+#include <deadfood/scan/table_scan.hh>
+#include <deadfood/util/thread_pool.hh>
+
+namespace deadfood::scan {
+
+// Equi-join of two tables on the workers of a thread pool. Both inputs are
+// radix-partitioned by the hash of their join key, with enough partitions for
+// the build rows of each to fit in L2 cache; the partitions are then built and
+// probed concurrently. The join predicate is evaluated on the candidate pairs
+// as they are handed out, probe rows in partition order. The modes are those
+// of HashJoinScan.
+class RadixJoinScan : public IScan {
+ public:
+  using Mode = HashJoinScan::Mode;
+
+  static constexpr size_t kMorselSlots = 1 << 14;
+
+  // `radix_bits` is the log2 of the partition count, nullopt sizes the
+  // partitions for the cache
+  RadixJoinScan(std::unique_ptr<TableScan> probe,
+                std::unique_ptr<TableScan> build, std::string probe_field,
+                std::string build_field, Mode mode, util::ThreadPool& pool,
+                std::optional<size_t> radix_bits = std::nullopt);
+
+  void Rewind() override;
+  bool Next() override;
+  bool HasField(const std::string& field_name) const override;
+  core::FieldVariant GetField(const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
+  void SetField(const std::string& field_name,
+                const core::FieldVariant& value) override;
+  void Insert() override;
+  void Delete() override;
+  void Close() override;
+
+  void set_predicate(std::unique_ptr<expr::IExpr> expr);
+
+ private:
+  // a row of one input with its join key
+  struct Entry {
+    size_t row_id;
+    size_t hash;
+    core::FieldVariant key;
+  };
+  // the rows of one input, partition `p` in entries[starts[p], starts[p + 1])
+  struct Partitions {
+    std::vector<Entry> entries;
+    std::vector<size_t> starts;
+  };
+
+  [[nodiscard]] Partitions Partition(const TableScan& scan,
+                                     const std::string& field) const;
+  void Join();
+  bool NextUnmatchedBuildRow();
+
+  std::unique_ptr<TableScan> probe_;
+  std::unique_ptr<TableScan> build_;
+  std::string probe_field_;
+  std::string build_field_;
+  Mode mode_;
+  util::ThreadPool& pool_;
+  std::optional<size_t> radix_bits_;
+  expr::BoolExpr predicate_;
+
+  bool joined_;
+  Partitions probe_rows_;
+  Partitions build_rows_;
+  // positions in `build_rows_` of the rows whose key equals the one of probe
+  // entry `i` are candidates_[candidate_starts_[i], candidate_starts_[i + 1])
+  std::vector<size_t> candidate_starts_;
+  std::vector<size_t> candidates_;
+  std::vector<bool> build_matched_;
+
+  size_t probe_pos_;
+  size_t candidate_pos_;
+  bool probe_has_row_;
+  bool probe_matched_;
+  bool emitting_unmatched_;
+  size_t unmatched_pos_;
+  bool probe_null_;
+  bool build_null_;
+};
+
+}  // namespace deadfood::scan
@@ -8,10 +8,23 @@ RenameScan::RenameScan(std::unique_ptr<IScan> internal,
       old_name_{old_name},
       new_name_{new_name} {}
 
-void RenameScan::BeforeFirst() { internal_->BeforeFirst(); }
+void RenameScan::Rewind() { internal_->BeforeFirst(); }
 
 bool RenameScan::Next() { return internal_->Next(); }
 
+bool RenameScan::NextBatch(ColumnBatch& batch) {
+  const auto new_idx = batch.FieldIndex(new_name_);
+  if (!new_idx.has_value()) {
+    return internal_->NextBatch(batch);
+  }
+  const size_t old_idx = batch.AddField(old_name_);
+  if (!internal_->NextBatch(batch)) {
+    return false;
+  }
+  batch.column(new_idx.value()) = batch.column(old_idx);
+  return true;
+}
+
 bool RenameScan::HasField(const std::string& field_name) const {
   if (field_name == new_name_) {
     return internal_->HasField(old_name_);
@@ -19,6 +32,14 @@ bool RenameScan::HasField(const std::string& field_name) const {
   return internal_->HasField(field_name);
 }
 
+std::optional<FieldBinding> RenameScan::BindField(
+    const std::string& field_name) const {
+  if (field_name == new_name_) {
+    return internal_->BindField(old_name_);
+  }
+  return internal_->BindField(field_name);
+}
+
 core::FieldVariant RenameScan::GetField(const std::string& field_name) const {
   if (field_name == new_name_) {
     return internal_->GetField(old_name_);
@@ -8,10 +8,13 @@ class RenameScan : public IScan {
  public:
   RenameScan(std::unique_ptr<IScan> internal, const std::string& old_name,
              const std::string& new_name);
-  void BeforeFirst() override;
+  void Rewind() override;
   bool Next() override;
+  bool NextBatch(ColumnBatch& batch) override;
   bool HasField(const std::string& field_name) const override;
   core::FieldVariant GetField(const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
   void SetField(const std::string& field_name,
                 const core::FieldVariant& value) override;
   void Insert() override;
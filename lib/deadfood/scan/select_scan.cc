@@ -9,18 +9,36 @@ void SelectScan::set_predicate(expr::BoolExpr&& predicate) {
   predicate_ = std::move(predicate);
 }
 
-void SelectScan::BeforeFirst() { internal_->BeforeFirst(); }
+void SelectScan::Rewind() { internal_->BeforeFirst(); }
 
 bool SelectScan::Next() {
   while (internal_->Next()) {
-    const auto v = predicate_.Eval();
-    if (std::holds_alternative<core::null_t>(v)) {
-      continue;
+    if (predicate_.IsTrue()) {
+      return true;
     }
-    if (!std::get<bool>(v)) {
-      continue;
+  }
+  return false;
+}
+
+bool SelectScan::NextBatch(ColumnBatch& batch) {
+  if (!predicate_.SupportsBatch()) {
+    return IScan::NextBatch(batch);
+  }
+  std::vector<std::string> predicate_fields;
+  predicate_.CollectFieldNames(predicate_fields);
+  for (const auto& field_name : predicate_fields) {
+    batch.AddField(field_name);
+  }
+
+  while (internal_->NextBatch(batch)) {
+    const auto& result = predicate_.EvalBatch(batch, predicate_result_);
+    const auto& values = *result.typed<uint8_t>();
+    std::erase_if(batch.selection(), [&](const uint32_t row) {
+      return result.IsNull(row) || values[row] == 0;
+    });
+    if (!batch.selection().empty()) {
+      return true;
     }
-    return true;
   }
   return false;
 }
@@ -29,6 +47,11 @@ bool SelectScan::HasField(const std::string& field_name) const {
   return internal_->HasField(field_name);
 }
 
+std::optional<FieldBinding> SelectScan::BindField(
+    const std::string& field_name) const {
+  return internal_->BindField(field_name);
+}
+
 core::FieldVariant SelectScan::GetField(const std::string& field_name) const {
   return internal_->GetField(field_name);
 }
@@ -11,13 +11,16 @@ class SelectScan : public IScan {
 
   void set_predicate(expr::BoolExpr&& predicate);
 
-  void BeforeFirst() override;
+  void Rewind() override;
 
   bool Next() override;
+  bool NextBatch(ColumnBatch& batch) override;
 
   [[nodiscard]] bool HasField(const std::string& field_name) const override;
   [[nodiscard]] core::FieldVariant GetField(
       const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
   void SetField(const std::string& field_name,
                 const core::FieldVariant& value) override;
 
@@ -29,6 +32,7 @@ class SelectScan : public IScan {
  private:
   std::unique_ptr<IScan> internal_;
   expr::BoolExpr predicate_;
+  ColumnVector predicate_result_;
 };
 
 }  // namespace deadfood::scan
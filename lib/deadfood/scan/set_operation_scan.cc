@@ -0,0 +1,124 @@
+#include "set_operation_scan.hh"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <deadfood/util/parse.hh>
+
+namespace deadfood::scan {
+
+SetOperationScan::SetOperationScan(std::unique_ptr<IScan> lhs,
+                                   std::vector<std::string> lhs_fields,
+                                   std::unique_ptr<IScan> rhs,
+                                   std::vector<std::string> rhs_fields,
+                                   query::SetOperator op, bool all)
+    : lhs_{std::move(lhs)},
+      lhs_fields_{std::move(lhs_fields)},
+      rhs_{std::move(rhs)},
+      rhs_fields_{std::move(rhs_fields)},
+      op_{op},
+      all_{all},
+      rhs_built_{false},
+      values_(lhs_fields_.size()),
+      current_{nullptr},
+      on_rhs_{false} {
+  if (lhs_fields_.size() != rhs_fields_.size()) {
+    throw std::runtime_error(
+        "queries of a set operation must select the same number of fields");
+  }
+}
+
+void SetOperationScan::EncodeCurrent(const IScan& scan,
+                                     const std::vector<std::string>& fields) {
+  for (size_t i = 0; i < fields.size(); ++i) {
+    values_[i] = scan.GetField(fields[i]);
+  }
+  core::EncodeRow(values_, row_);
+}
+
+void SetOperationScan::BuildRhs() {
+  rhs_rows_.Clear();
+  rhs_->BeforeFirst();
+  while (rhs_->Next()) {
+    EncodeCurrent(*rhs_, rhs_fields_);
+    rhs_rows_.Insert(row_);
+  }
+  rhs_built_ = true;
+}
+
+void SetOperationScan::Rewind() {
+  // the rows of `rhs` are kept: the input does not change while a query runs
+  lhs_->BeforeFirst();
+  rhs_->BeforeFirst();
+  returned_.Clear();
+  current_ = nullptr;
+  on_rhs_ = false;
+}
+
+bool SetOperationScan::Next() {
+  if (op_ != query::SetOperator::Union && !rhs_built_) {
+    BuildRhs();
+  }
+  while (!on_rhs_ && lhs_->Next()) {
+    if (op_ == query::SetOperator::Union && all_) {
+      current_ = lhs_.get();
+      return true;
+    }
+    EncodeCurrent(*lhs_, lhs_fields_);
+    if (op_ != query::SetOperator::Union &&
+        rhs_rows_.Contains(row_) != (op_ == query::SetOperator::Intersect)) {
+      continue;
+    }
+    if (returned_.Insert(row_)) {
+      current_ = lhs_.get();
+      return true;
+    }
+  }
+  on_rhs_ = true;
+  while (op_ == query::SetOperator::Union && rhs_->Next()) {
+    if (all_) {
+      current_ = rhs_.get();
+      return true;
+    }
+    EncodeCurrent(*rhs_, rhs_fields_);
+    if (returned_.Insert(row_)) {
+      current_ = rhs_.get();
+      return true;
+    }
+  }
+  current_ = nullptr;
+  return false;
+}
+
+std::optional<size_t> SetOperationScan::FieldIndex(
+    const std::string& field_name) const {
+  return parse::util::FindFieldName(lhs_fields_, field_name);
+}
+
+bool SetOperationScan::HasField(const std::string& field_name) const {
+  return FieldIndex(field_name).has_value();
+}
+
+core::FieldVariant SetOperationScan::GetField(
+    const std::string& field_name) const {
+  const auto index = FieldIndex(field_name);
+  if (current_ == nullptr || !index.has_value()) {
+    return core::null_t{};
+  }
+  const auto& fields = current_ == lhs_.get() ? lhs_fields_ : rhs_fields_;
+  return current_->GetField(fields[index.value()]);
+}
+
+void SetOperationScan::SetField(const std::string& /*field_name*/,
+                                const core::FieldVariant& /*value*/) {}
+
+void SetOperationScan::Insert() {}
+
+void SetOperationScan::Delete() {}
+
+void SetOperationScan::Close() {
+  lhs_->Close();
+  rhs_->Close();
+}
+
+}  // namespace deadfood::scan
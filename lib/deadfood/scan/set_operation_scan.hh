@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <deadfood/core/row_set.hh>
+#include <deadfood/query/select_query.hh>
+#include <deadfood/scan/iscan.hh>
+
+namespace deadfood::scan {
+
+// Combines the rows of two queries selecting the same number of fields. The
+// fields are named after `lhs_fields`; the n-th of them reads the n-th field
+// of whichever side the current row comes from.
+//
+// UNION returns the rows of `lhs`, then those of `rhs`, and unless `all` is
+// set drops the rows already returned. INTERSECT and EXCEPT first collect the
+// rows of `rhs` in a `core::RowSet`, then stream `lhs`, keeping the distinct
+// rows found in the set, or not found in it.
+class SetOperationScan : public IScan {
+ public:
+  SetOperationScan(std::unique_ptr<IScan> lhs,
+                   std::vector<std::string> lhs_fields,
+                   std::unique_ptr<IScan> rhs,
+                   std::vector<std::string> rhs_fields, query::SetOperator op,
+                   bool all);
+
+  void Rewind() override;
+  bool Next() override;
+
+  [[nodiscard]] bool HasField(const std::string& field_name) const override;
+  [[nodiscard]] core::FieldVariant GetField(
+      const std::string& field_name) const override;
+  void SetField(const std::string& field_name,
+                const core::FieldVariant& value) override;
+
+  void Insert() override;
+  void Delete() override;
+
+  void Close() override;
+
+ private:
+  void BuildRhs();
+  // encodes the current row of `scan` into row_
+  void EncodeCurrent(const IScan& scan, const std::vector<std::string>& fields);
+  [[nodiscard]] std::optional<size_t> FieldIndex(
+      const std::string& field_name) const;
+
+  std::unique_ptr<IScan> lhs_;
+  std::vector<std::string> lhs_fields_;
+  std::unique_ptr<IScan> rhs_;
+  std::vector<std::string> rhs_fields_;
+  query::SetOperator op_;
+  bool all_;
+
+  bool rhs_built_;
+  core::RowSet rhs_rows_;
+  core::RowSet returned_;
+  std::vector<core::FieldVariant> values_;
+  std::string row_;
+
+  // the side of the current row, nullptr before the first and after the last
+  const IScan* current_;
+  bool on_rhs_;
+};
+
+}  // namespace deadfood::scan
@@ -0,0 +1,270 @@
+#include "sort_scan.hh"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+
+#include <deadfood/core/field_key.hh>
+#include <deadfood/util/parse.hh>
+
+namespace deadfood::scan {
+
+constexpr uint64_t kNullPrefix = std::numeric_limits<uint64_t>::max();
+
+// maps doubles to unsigned integers of the same order
+uint64_t EncodeNumber(double value) {
+  if (value == 0) {
+    value = 0;  // -0.0
+  }
+  const auto bits = std::bit_cast<uint64_t>(value);
+  return (bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63);
+}
+
+bool IsNumberOrNull(const core::FieldVariant& value) {
+  return !std::holds_alternative<std::string>(value);
+}
+
+// the first 8 bytes of a string in an order-preserving integer
+uint64_t StringPrefix(const std::string& value) {
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(prefix); ++i) {
+    prefix <<= 8;
+    if (i < value.size()) {
+      prefix |= static_cast<unsigned char>(value[i]);
+    }
+  }
+  return prefix;
+}
+
+SortScan::SortScan(std::unique_ptr<IScan> input, std::vector<Key> keys,
+                   std::vector<std::string> fields,
+                   std::optional<size_t> limit)
+    : input_{std::move(input)},
+      keys_{std::move(keys)},
+      fields_{std::move(fields)},
+      limit_{limit},
+      sorted_{false},
+      row_count_{0},
+      pos_{0},
+      before_start_{true} {}
+
+void SortScan::Sort() {
+  if (limit_.has_value()) {
+    SelectTop();
+    return;
+  }
+  std::vector<std::vector<core::FieldVariant>> key_values(keys_.size());
+  rows_.clear();
+  row_count_ = 0;
+  input_->BeforeFirst();
+  while (input_->Next()) {
+    for (const auto& field : fields_) {
+      rows_.push_back(input_->GetField(field));
+    }
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      key_values[i].push_back(keys_[i].expr->Eval());
+    }
+    ++row_count_;
+  }
+  if (row_count_ > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("too many rows to sort");
+  }
+
+  order_.resize(row_count_);
+  for (size_t row = 0; row < row_count_; ++row) {
+    order_[row] = Entry{.prefix = 0, .row = static_cast<uint32_t>(row)};
+  }
+  // every pass is stable, so the first key ends up deciding
+  for (size_t i = keys_.size(); i-- > 0;) {
+    if (std::ranges::all_of(key_values[i], IsNumberOrNull)) {
+      RadixSortKey(key_values[i], keys_[i].descending);
+    } else {
+      CompareSortKey(key_values[i], keys_[i].descending);
+    }
+  }
+  scratch_ = {};
+  sorted_ = true;
+}
+
+void SortScan::RadixSortKey(const std::vector<core::FieldVariant>& values,
+                            bool descending) {
+  for (auto& entry : order_) {
+    const auto& value = values[entry.row];
+    uint64_t prefix = kNullPrefix;
+    if (const auto* i_value = std::get_if<int>(&value)) {
+      prefix = EncodeNumber(*i_value);
+    } else if (const auto* b_value = std::get_if<bool>(&value)) {
+      prefix = EncodeNumber(*b_value ? 1 : 0);
+    } else if (const auto* f_value = std::get_if<float>(&value)) {
+      prefix = EncodeNumber(static_cast<double>(*f_value));
+    } else if (const auto* d_value = std::get_if<double>(&value)) {
+      prefix = EncodeNumber(*d_value);
+    }
+    entry.prefix = descending ? ~prefix : prefix;
+  }
+
+  // least significant byte first; a byte all entries share needs no pass
+  std::array<std::array<size_t, 256>, sizeof(uint64_t)> counts{};
+  for (const auto& entry : order_) {
+    for (size_t byte = 0; byte < sizeof(uint64_t); ++byte) {
+      ++counts[byte][(entry.prefix >> (8 * byte)) & 0xff];
+    }
+  }
+  scratch_.resize(order_.size());
+  for (size_t byte = 0; byte < sizeof(uint64_t); ++byte) {
+    auto& count = counts[byte];
+    if (std::ranges::find(count, order_.size()) != count.end()) {
+      continue;
+    }
+    size_t offset = 0;
+    for (auto& bucket : count) {
+      const size_t size = bucket;
+      bucket = offset;
+      offset += size;
+    }
+    for (const auto& entry : order_) {
+      scratch_[count[(entry.prefix >> (8 * byte)) & 0xff]++] = entry;
+    }
+    order_.swap(scratch_);
+  }
+}
+
+void SortScan::CompareSortKey(const std::vector<core::FieldVariant>& values,
+                              bool descending) {
+  for (auto& entry : order_) {
+    const auto& value = values[entry.row];
+    uint64_t prefix = 0;
+    if (const auto* s_value = std::get_if<std::string>(&value)) {
+      prefix = StringPrefix(*s_value);
+    } else if (std::holds_alternative<core::null_t>(value)) {
+      prefix = kNullPrefix;
+    }
+    entry.prefix = descending ? ~prefix : prefix;
+  }
+  // equal prefixes do not make equal keys, the values decide then
+  const core::FieldKeyLess less;
+  std::ranges::stable_sort(order_, [&](const Entry& lhs, const Entry& rhs) {
+    if (lhs.prefix != rhs.prefix) {
+      return lhs.prefix < rhs.prefix;
+    }
+    return descending ? less(values[rhs.row], values[lhs.row])
+                      : less(values[lhs.row], values[rhs.row]);
+  });
+}
+
+void SortScan::SelectTop() {
+  const size_t limit = limit_.value();
+  // slot `s` of the heap holds a row in rows_[s * fields_.size() ...], its
+  // keys in top_keys[s * keys_.size() ...] and its position in the input
+  std::vector<core::FieldVariant> top_keys;
+  std::vector<size_t> top_positions;
+  const core::FieldKeyLess less;
+  const auto precedes = [&](const core::FieldVariant* lhs_keys,
+                            size_t lhs_position,
+                            const core::FieldVariant* rhs_keys,
+                            size_t rhs_position) {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      if (less(lhs_keys[i], rhs_keys[i])) {
+        return !keys_[i].descending;
+      }
+      if (less(rhs_keys[i], lhs_keys[i])) {
+        return keys_[i].descending;
+      }
+    }
+    return lhs_position < rhs_position;
+  };
+  const auto slot_precedes = [&](uint32_t lhs, uint32_t rhs) {
+    return precedes(&top_keys[lhs * keys_.size()], top_positions[lhs],
+                    &top_keys[rhs * keys_.size()], top_positions[rhs]);
+  };
+
+  // a max-heap: the last of the rows kept is on top
+  std::vector<uint32_t> heap;
+  std::vector<core::FieldVariant> row_keys(keys_.size());
+  rows_.clear();
+  size_t position = 0;
+  input_->BeforeFirst();
+  for (; input_->Next(); ++position) {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      row_keys[i] = keys_[i].expr->Eval();
+    }
+    uint32_t slot = 0;
+    if (heap.size() < limit) {
+      slot = static_cast<uint32_t>(heap.size());
+      rows_.resize(rows_.size() + fields_.size());
+      top_keys.resize(top_keys.size() + keys_.size());
+      top_positions.push_back(0);
+    } else if (limit != 0 &&
+               precedes(row_keys.data(), position,
+                        &top_keys[heap.front() * keys_.size()],
+                        top_positions[heap.front()])) {
+      std::ranges::pop_heap(heap, slot_precedes);
+      slot = heap.back();
+      heap.pop_back();
+    } else {
+      continue;
+    }
+    for (size_t i = 0; i < fields_.size(); ++i) {
+      rows_[slot * fields_.size() + i] = input_->GetField(fields_[i]);
+    }
+    std::ranges::copy(row_keys, &top_keys[slot * keys_.size()]);
+    top_positions[slot] = position;
+    heap.push_back(slot);
+    std::ranges::push_heap(heap, slot_precedes);
+  }
+
+  std::ranges::sort(heap, slot_precedes);
+  row_count_ = heap.size();
+  order_.clear();
+  for (const uint32_t slot : heap) {
+    order_.push_back(Entry{.prefix = 0, .row = slot});
+  }
+  sorted_ = true;
+}
+
+void SortScan::Rewind() {
+  // the sorted rows are kept: the input does not change while a query runs
+  pos_ = 0;
+  before_start_ = true;
+}
+
+bool SortScan::Next() {
+  if (!sorted_) {
+    Sort();
+  }
+  if (before_start_) {
+    before_start_ = false;
+  } else if (pos_ < row_count_) {
+    ++pos_;
+  }
+  return pos_ < row_count_;
+}
+
+std::optional<size_t> SortScan::FieldIndex(
+    const std::string& field_name) const {
+  return parse::util::FindFieldName(fields_, field_name);
+}
+
+bool SortScan::HasField(const std::string& field_name) const {
+  return FieldIndex(field_name).has_value();
+}
+
+core::FieldVariant SortScan::GetField(const std::string& field_name) const {
+  const auto index = FieldIndex(field_name);
+  if (before_start_ || pos_ >= row_count_ || !index.has_value()) {
+    return core::null_t{};
+  }
+  return rows_[order_[pos_].row * fields_.size() + index.value()];
+}
+
+void SortScan::SetField(const std::string& /*field_name*/,
+                        const core::FieldVariant& /*value*/) {}
+
+void SortScan::Insert() {}
+
+void SortScan::Delete() {}
+
+void SortScan::Close() { input_->Close(); }
+
+}  // namespace deadfood::scan
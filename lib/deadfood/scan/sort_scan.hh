@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <deadfood/expr/iexpr.hh>
+#include <deadfood/scan/iscan.hh>
+
+namespace deadfood::scan {
+
+// Returns the rows of `input` ordered by the `keys`, ties in input order. The
+// values of `fields` are copied out of every row once; the sort itself only
+// moves (key prefix, row number) pairs, one stable pass per key from the last
+// to the first. Numeric keys are radix-sorted on an order-preserving 64-bit
+// encoding, any other key is compared, its first bytes being the prefix.
+// Keys are ordered like lookup keys: numbers, then strings, then NULL.
+//
+// With a `limit` only the first `limit` rows are wanted: they are kept in a
+// bounded heap as the input goes by, so the rows of the result are all that
+// is ever copied, and only those are sorted.
+class SortScan : public IScan {
+ public:
+  struct Key {
+    std::unique_ptr<expr::IExpr> expr;
+    bool descending;
+  };
+
+  SortScan(std::unique_ptr<IScan> input, std::vector<Key> keys,
+           std::vector<std::string> fields,
+           std::optional<size_t> limit = std::nullopt);
+
+  void Rewind() override;
+  bool Next() override;
+
+  [[nodiscard]] bool HasField(const std::string& field_name) const override;
+  [[nodiscard]] core::FieldVariant GetField(
+      const std::string& field_name) const override;
+  void SetField(const std::string& field_name,
+                const core::FieldVariant& value) override;
+
+  void Insert() override;
+  void Delete() override;
+
+  void Close() override;
+
+ private:
+  struct Entry {
+    uint64_t prefix;
+    uint32_t row;
+  };
+
+  void Sort();
+  void SelectTop();
+  void RadixSortKey(const std::vector<core::FieldVariant>& values,
+                    bool descending);
+  void CompareSortKey(const std::vector<core::FieldVariant>& values,
+                      bool descending);
+  [[nodiscard]] std::optional<size_t> FieldIndex(
+      const std::string& field_name) const;
+
+  std::unique_ptr<IScan> input_;
+  std::vector<Key> keys_;
+  std::vector<std::string> fields_;
+  std::optional<size_t> limit_;
+
+  bool sorted_;
+  size_t row_count_;
+  // row `r` has the values rows_[r * fields_.size() ...]
+  std::vector<core::FieldVariant> rows_;
+  std::vector<Entry> order_;
+  std::vector<Entry> scratch_;
+
+  size_t pos_;
+  bool before_start_;
+};
+
+}  // namespace deadfood::scan
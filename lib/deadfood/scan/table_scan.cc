@@ -1,5 +1,7 @@
 #include "table_scan.hh"
 
+#include <algorithm>
+
 #include <deadfood/core/row.hh>
 #include <deadfood/util/parse.hh>
 
@@ -10,29 +12,114 @@ TableScan::TableScan(storage::TableStorage& storage, const core::Schema& schema,
     : table_name_{table_name},
       storage_{storage},
       schema_{schema},
-      it_{storage.storage().begin()},
-      before_start_{true} {}
+      slot_{0},
+      before_start_{true},
+      first_slot_{0},
+      end_slot_{storage::TableStorage::kNoRow} {}
 
 void TableScan::set_table_name(const std::string& table_name) {
   table_name_ = table_name;
 }
 
-void TableScan::BeforeFirst() { before_start_ = true; }
+bool TableScan::MoveToRowId(size_t row_id) {
+  if (!storage_.Exists(row_id)) {
+    return false;
+  }
+  before_start_ = false;
+  slot_ = storage_.SlotOf(row_id);
+  return true;
+}
+
+size_t TableScan::row_id() const { return storage_.RowIdAt(slot_); }
+
+size_t TableScan::row_count() const { return storage_.size(); }
+
+size_t TableScan::slot_count() const { return storage_.slot_count(); }
+
+std::unique_ptr<TableScan> TableScan::Clone() const {
+  return std::make_unique<TableScan>(storage_, schema_, table_name_);
+}
+
+void TableScan::SetSlotRange(size_t begin, size_t end) {
+  first_slot_ = begin;
+  end_slot_ = end;
+}
+
+void TableScan::Rewind() { before_start_ = true; }
 
 bool TableScan::Next() {
+  const size_t slot_count = std::min(storage_.slot_count(), end_slot_);
   if (before_start_) {
     before_start_ = false;
-    it_ = storage_.storage().begin();
-    return it_ != storage_.storage().end();
+    slot_ = first_slot_;
+  } else if (slot_ < slot_count) {
+    ++slot_;
   }
+  slot_ = storage_.NextLiveSlot(slot_, slot_count);
+  return slot_ < slot_count;
+}
 
-  if (it_ == storage_.storage().end()) {
-    return false;
+template <typename T, typename Read>
+void FillColumn(storage::TableStorage& storage, const std::vector<size_t>& slots,
+                size_t field, ColumnVector& column, Read read) {
+  column.ResetTyped<T>(slots.size());
+  auto& values = *column.typed<T>();
+  auto& nulls = column.nulls();
+  for (size_t i = 0; i < slots.size(); ++i) {
+    if (storage.IsNull(slots[i], field)) {
+      nulls[i] = 1;
+    } else {
+      values[i] = read(storage.GetCell(slots[i], field));
+    }
   }
+}
 
-  ++it_;
+bool TableScan::NextBatch(ColumnBatch& batch) {
+  batch.Clear();
+  batch_slots_.clear();
+  while (batch_slots_.size() < batch.capacity() && Next()) {
+    batch_slots_.emplace_back(slot_);
+  }
 
-  return it_ != storage_.storage().end();
+  for (size_t i = 0; i < batch.fields().size(); ++i) {
+    auto& column = batch.column(i);
+    const auto binding = BindField(batch.fields()[i]);
+    if (!binding.has_value()) {
+      column.ResetGeneric(batch_slots_.size());
+      continue;
+    }
+    const size_t field = binding->index;
+    const size_t size = binding->field.size();
+    using Buffer = storage::ByteBuffer;
+    switch (binding->field.type()) {
+      case core::Field::FieldType::Bool:
+        FillColumn<uint8_t>(storage_, batch_slots_, field, column,
+                            [](const Buffer& cell) {
+                              return static_cast<uint8_t>(cell.ReadBool(0));
+                            });
+        break;
+      case core::Field::FieldType::Int:
+        FillColumn<int>(storage_, batch_slots_, field, column,
+                        [](const Buffer& cell) { return cell.ReadInt(0); });
+        break;
+      case core::Field::FieldType::Float:
+        FillColumn<float>(storage_, batch_slots_, field, column,
+                          [](const Buffer& cell) { return cell.ReadFloat(0); });
+        break;
+      case core::Field::FieldType::Double:
+        FillColumn<double>(
+            storage_, batch_slots_, field, column,
+            [](const Buffer& cell) { return cell.ReadDouble(0); });
+        break;
+      case core::Field::FieldType::Varchar:
+        FillColumn<std::string>(
+            storage_, batch_slots_, field, column,
+            [&](const Buffer& cell) { return cell.ReadVarchar(0, size); });
+        break;
+    }
+  }
+  batch.SetSize(batch_slots_.size());
+  return !batch_slots_.empty();
 }
 
 bool TableScan::HasField(const std::string& field_name) const {
@@ -43,52 +130,163 @@ bool TableScan::HasField(const std::string& field_name) const {
   return schema_.Exists(field);
 }
 
+std::optional<FieldBinding> TableScan::BindField(
+    const std::string& field_name) const {
+  if (!HasField(field_name)) {
+    return std::nullopt;
+  }
+  const auto [_, field] = deadfood::parse::util::GetFullFieldName(field_name);
+  return FieldBinding{.scan = this,
+                      .field = schema_.field_info(field),
+                      .index = schema_.Index(field),
+                      .null_flags = {}};
+}
+
+core::FieldVariant TableScan::Read(const FieldBinding& binding) const {
+  if (!OnLiveRow()) {
+    return core::null_t{};
+  }
+  if (storage_.IsNull(slot_, binding.index)) {
+    return core::null_t{};
+  }
+  const auto cell = storage_.GetCell(slot_, binding.index);
+  switch (binding.field.type()) {
+    case core::Field::FieldType::Bool:
+      return cell.ReadBool(0);
+    case core::Field::FieldType::Int:
+      return cell.ReadInt(0);
+    case core::Field::FieldType::Float:
+      return cell.ReadFloat(0);
+    case core::Field::FieldType::Double:
+      return cell.ReadDouble(0);
+    case core::Field::FieldType::Varchar:
+      return cell.ReadVarchar(0, binding.field.size());
+  }
+  return core::null_t{};
+}
+
+template <typename T>
+bool TableScan::ReadAs(const FieldBinding& binding, T& out) const {
+  if (!OnLiveRow() || storage_.IsNull(slot_, binding.index)) {
+    return false;
+  }
+  const auto cell = storage_.GetCell(slot_, binding.index);
+  if constexpr (std::is_same_v<T, bool>) {
+    out = cell.ReadBool(0);
+  } else if constexpr (std::is_same_v<T, int>) {
+    out = cell.ReadInt(0);
+  } else if constexpr (std::is_same_v<T, float>) {
+    out = cell.ReadFloat(0);
+  } else {
+    out = cell.ReadDouble(0);
+  }
+  return true;
+}
+
+template bool TableScan::ReadAs(const FieldBinding&, bool&) const;
+template bool TableScan::ReadAs(const FieldBinding&, int&) const;
+template bool TableScan::ReadAs(const FieldBinding&, float&) const;
+template bool TableScan::ReadAs(const FieldBinding&, double&) const;
+
 core::FieldVariant TableScan::GetField(const std::string& field_name) const {
-  if (it_ == storage_.storage().end()) {
+  if (!OnLiveRow()) {
     return core::null_t{};
   }
-  const auto row = core::Row(it_->second, schema_);
+  const auto row = core::Row(storage_, slot_, schema_);
   const auto [_, field] = deadfood::parse::util::GetFullFieldName(field_name);
   return row.GetField(field);
 }
 
 void TableScan::SetField(const std::string& field_name,
                          const core::FieldVariant& value) {
-  auto row = core::Row(it_->second, schema_);
+  if (!OnLiveRow()) {
+    return;
+  }
+  auto row = core::Row(storage_, slot_, schema_);
   const auto [_, field] = deadfood::parse::util::GetFullFieldName(field_name);
+  auto* hash_index = storage_.hash_index(field);
+  auto* btree_index = storage_.btree_index(field);
+  if (hash_index == nullptr && btree_index == nullptr) {
+    row.SetField(field, value);
+    return;
+  }
+  // the stored value may differ from `value` (e.g. truncation), so the indices
+  // are fed with what is read back from the row
+  const auto current_row_id = row_id();
+  const auto old_value = row.GetField(field);
   row.SetField(field, value);
+  const auto new_value = row.GetField(field);
+  if (hash_index != nullptr) {
+    hash_index->Erase(old_value, current_row_id);
+    hash_index->Insert(new_value, current_row_id);
+  }
+  if (btree_index != nullptr) {
+    btree_index->Erase(old_value, current_row_id);
+    btree_index->Insert(new_value, current_row_id);
+  }
 }
 
 void TableScan::Insert() {
-  size_t row_id = 0;
-  if (!storage_.storage().empty()) {
-    auto last = storage_.storage().end();
-    --last;
-    row_id = last->first + 1;
+  slot_ = storage_.Insert();
+  IndexCurrentRow();
+}
+
+void TableScan::InsertRow(const std::vector<std::string>& fields,
+                          const std::vector<core::FieldVariant>& values) {
+  slot_ = storage_.Insert();
+  auto row = core::Row(storage_, slot_, schema_);
+  for (size_t i = 0; i < fields.size(); ++i) {
+    const auto [_, field] = deadfood::parse::util::GetFullFieldName(fields[i]);
+    row.SetField(field, values[i]);
   }
+  IndexCurrentRow();
+}
 
-  auto [new_it, _] =
-      storage_.storage().emplace(row_id, storage::ByteBuffer(schema_.size()));
-  it_ = new_it;
+void TableScan::WriteRow(size_t row_id, const char* data) {
+  if (MoveToRowId(row_id)) {
+    UnindexCurrentRow();
+  } else {
+    before_start_ = false;
+    slot_ = storage_.Insert(row_id);
+  }
+  storage_.WriteRow(slot_, data);
+  IndexCurrentRow();
 }
 
 void TableScan::Delete() {
-  if (before_start_ || storage_.storage().empty() ||
-      it_ == storage_.storage().end()) {
+  if (before_start_ || !OnLiveRow()) {
     return;
   }
+  UnindexCurrentRow();
+  // the slot is only tombstoned; `Next` simply moves on to the one after
+  storage_.RemoveSlot(slot_);
+}
 
-  auto copy_it = it_;
-  if (storage_.storage().begin() == it_) {
-    before_start_ = true;
-  } else {
-    --copy_it;
-  }
+void TableScan::Close() {}
 
-  storage_.storage().erase(it_);
-  it_ = copy_it;
+bool TableScan::OnLiveRow() const {
+  return slot_ < std::min(storage_.slot_count(), end_slot_) &&
+         storage_.IsLive(slot_);
 }
 
-void TableScan::Close() {}
+void TableScan::IndexCurrentRow() {
+  const auto row = core::Row(storage_, slot_, schema_);
+  for (auto& [field, index] : storage_.hash_indices()) {
+    index.Insert(row.GetField(field), row_id());
+  }
+  for (auto& [field, index] : storage_.btree_indices()) {
+    index.Insert(row.GetField(field), row_id());
+  }
+}
+
+void TableScan::UnindexCurrentRow() {
+  const auto row = core::Row(storage_, slot_, schema_);
+  for (auto& [field, index] : storage_.hash_indices()) {
+    index.Erase(row.GetField(field), row_id());
+  }
+  for (auto& [field, index] : storage_.btree_indices()) {
+    index.Erase(row.GetField(field), row_id());
+  }
+}
 
-}  // namespace deadfood::scan
\ No newline at end of file
+}  // namespace deadfood::scan
@@ -12,13 +12,42 @@ class TableScan : public IScan {
             const std::string& table_name);
 
   void set_table_name(const std::string& table_name);
+  // a new scan over the same table under the same name
+  [[nodiscard]] std::unique_ptr<TableScan> Clone() const;
+  // restricts the scan to the slots in [begin, end), takes effect on the next
+  // `BeforeFirst`
+  void SetSlotRange(size_t begin, size_t end);
 
-  void BeforeFirst() override;
+  // positions the scan on the row with the given id, if it still exists
+  bool MoveToRowId(size_t row_id);
+  [[nodiscard]] size_t row_id() const;
+  // number of live rows in the underlying table
+  [[nodiscard]] size_t row_count() const;
+  // number of slots of the underlying table, live or not
+  [[nodiscard]] size_t slot_count() const;
+  // reads a field bound by `BindField` from the current row
+  [[nodiscard]] core::FieldVariant Read(const FieldBinding& binding) const;
+  // reads a bound bool, int, float or double field without boxing it,
+  // returns false if the value is NULL
+  template <typename T>
+  bool ReadAs(const FieldBinding& binding, T& out) const;
+  // inserts a row holding `values` in `fields` and indexes it once, instead of
+  // re-indexing on every `SetField`; the scan is left on the new row
+  void InsertRow(const std::vector<std::string>& fields,
+                 const std::vector<core::FieldVariant>& values);
+  // stores the row image `data` under `row_id`, replacing the row with that
+  // id if there is one; the scan is left on the row
+  void WriteRow(size_t row_id, const char* data);
+
+  void Rewind() override;
   bool Next() override;
+  bool NextBatch(ColumnBatch& batch) override;
 
   [[nodiscard]] bool HasField(const std::string& field_name) const override;
   [[nodiscard]] core::FieldVariant GetField(
       const std::string& field_name) const override;
+  [[nodiscard]] std::optional<FieldBinding> BindField(
+      const std::string& field_name) const override;
   void SetField(const std::string& field_name,
                 const core::FieldVariant& value) override;
 
@@ -31,8 +60,16 @@ class TableScan : public IScan {
   std::string table_name_;
   storage::TableStorage& storage_;
   const core::Schema& schema_;
-  decltype(storage_.storage().begin()) it_;
+  size_t slot_;
   bool before_start_;
+  size_t first_slot_;
+  size_t end_slot_;
+  // slots of the rows gathered by the last `NextBatch`
+  std::vector<size_t> batch_slots_;
+
+  [[nodiscard]] bool OnLiveRow() const;
+  void IndexCurrentRow();
+  void UnindexCurrentRow();
 };
 
 }  // namespace deadfood::scan
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "block_file.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <deadfood/util/crc32c.hh>
+#include <deadfood/util/system_error.hh>
+
+namespace deadfood::storage {
+
+// not valid text nor a plausible big-endian number, so no file of version 1
+// starts with it
+constexpr std::array<char, 8> kSnapshotMagic = {'\x89', 'D', 'F', 'D',
+                                                '\r',   '\n', '\x1a', '\n'};
+constexpr size_t kSnapshotHeaderSize =
+    kSnapshotMagic.size() + sizeof(uint32_t);
+constexpr size_t kBlockHeaderSize = 2 * sizeof(uint32_t);
+
+BlockWriter::BlockWriter(const std::filesystem::path& path)
+    : path_{path},
+      fd_{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                 0644)} {
+  if (fd_ < 0) {
+    throw util::SystemError("cannot create " + path_.string());
+  }
+  std::array<char, kSnapshotHeaderSize> header{};
+  std::ranges::copy(kSnapshotMagic, header.begin());
+  binary::EncodeUint(header.data() + kSnapshotMagic.size(), kSnapshotVersion);
+  WriteAll(header.data(), header.size());
+  block_.reserve(kBlockHeaderSize + kBlockSize);
+  block_.resize(kBlockHeaderSize);
+}
+
+BlockWriter::~BlockWriter() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+char* BlockWriter::Append(size_t size) {
+  if (block_.size() + size > kBlockHeaderSize + kBlockSize &&
+      block_.size() > kBlockHeaderSize) {
+    WriteBlock();
+  }
+  const size_t pos = block_.size();
+  block_.resize(pos + size);
+  return block_.data() + pos;
+}
+
+void BlockWriter::Append(std::string_view bytes) {
+  while (!bytes.empty()) {
+    const size_t room = kBlockHeaderSize + kBlockSize - block_.size();
+    if (room == 0) {
+      WriteBlock();
+      continue;
+    }
+    const size_t size = std::min(room, bytes.size());
+    block_.append(bytes.substr(0, size));
+    bytes.remove_prefix(size);
+  }
+}
+
+void BlockWriter::Finish() {
+  if (block_.size() > kBlockHeaderSize) {
+    WriteBlock();
+  }
+  if (::fsync(fd_) != 0) {
+    throw util::SystemError("cannot sync " + path_.string());
+  }
+  if (::close(fd_) != 0) {
+    fd_ = -1;
+    throw util::SystemError("cannot close " + path_.string());
+  }
+  fd_ = -1;
+}
+
+void BlockWriter::WriteBlock() {
+  const size_t size = block_.size() - kBlockHeaderSize;
+  char* pos = binary::EncodeUint(block_.data(), static_cast<uint32_t>(size));
+  binary::EncodeUint(pos, util::Crc32c(block_.data() + kBlockHeaderSize, size));
+  WriteAll(block_.data(), block_.size());
+  block_.resize(kBlockHeaderSize);
+}
+
+void BlockWriter::WriteAll(const char* data, size_t size) {
+  while (size != 0) {
+    const auto written = ::write(fd_, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw util::SystemError("cannot write " + path_.string());
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+}
+
+BlockReader::BlockReader(const std::filesystem::path& path)
+    : path_{path},
+      fd_{::open(path.c_str(), O_RDONLY | O_CLOEXEC)},
+      version_{0},
+      pos_{0} {
+  if (fd_ < 0) {
+    throw util::SystemError("cannot open " + path_.string());
+  }
+  ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+  std::array<char, kSnapshotHeaderSize> header{};
+  if (ReadSome(header.data(), header.size()) != header.size() ||
+      !std::equal(kSnapshotMagic.begin(), kSnapshotMagic.end(),
+                  header.begin())) {
+    throw std::runtime_error(path_.string() + " is not a snapshot file");
+  }
+  version_ =
+      binary::DecodeUint<uint32_t>(header.data() + kSnapshotMagic.size());
+  if (version_ > kSnapshotVersion) {
+    throw std::runtime_error(path_.string() + " has unsupported version " +
+                             std::to_string(version_));
+  }
+}
+
+BlockReader::~BlockReader() { ::close(fd_); }
+
+bool BlockReader::HasHeader(const std::filesystem::path& path) {
+  std::ifstream stream(path, std::ios::binary);
+  std::array<char, kSnapshotMagic.size()> magic{};
+  return stream.read(magic.data(), magic.size()) && magic == kSnapshotMagic;
+}
+
+uint32_t BlockReader::version() const { return version_; }
+
+bool BlockReader::AtEnd() { return pos_ == block_.size() && !NextBlock(); }
+
+const char* BlockReader::Read(size_t size) {
+  if (pos_ == block_.size()) {
+    NextBlock();
+  }
+  if (block_.size() - pos_ < size) {
+    throw std::runtime_error(path_.string() + " is truncated");
+  }
+  const char* data = block_.data() + pos_;
+  pos_ += size;
+  return data;
+}
+
+std::string BlockReader::ReadAll() {
+  std::string ret = block_.substr(pos_);
+  while (NextBlock()) {
+    ret += block_;
+  }
+  pos_ = block_.size();
+  return ret;
+}
+
+bool BlockReader::NextBlock() {
+  std::array<char, kBlockHeaderSize> header{};
+  const size_t header_size = ReadSome(header.data(), header.size());
+  if (header_size == 0) {
+    return false;
+  }
+  const size_t size = binary::DecodeUint<uint32_t>(header.data());
+  block_.resize(size);
+  pos_ = 0;
+  if (header_size != header.size() ||
+      ReadSome(block_.data(), size) != size) {
+    throw std::runtime_error(path_.string() + " is truncated");
+  }
+  if (util::Crc32c(block_.data(), size) !=
+      binary::DecodeUint<uint32_t>(header.data() + sizeof(uint32_t))) {
+    throw std::runtime_error(path_.string() + " is corrupted");
+  }
+  return true;
+}
+
+size_t BlockReader::ReadSome(char* data, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    const auto got = ::read(fd_, data + done, size - done);
+    if (got < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw util::SystemError("cannot read " + path_.string());
+    }
+    if (got == 0) {
+      break;
+    }
+    done += static_cast<size_t>(got);
+  }
+  return done;
+}
+
+std::unique_ptr<std::istream> OpenSnapshotFile(
+    const std::filesystem::path& path) {
+  if (!BlockReader::HasHeader(path)) {
+    return std::make_unique<std::ifstream>(path, std::ios::binary);
+  }
+  return std::make_unique<std::istringstream>(BlockReader(path).ReadAll());
+}
+
+void WriteSnapshotFile(const std::filesystem::path& path,
+                       std::string_view contents) {
+  BlockWriter writer(path);
+  writer.Append(contents);
+  writer.Finish();
+}
+
+}  // namespace deadfood::storage
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <deadfood/binary/big_endian.hh>
+
+namespace deadfood::storage {
+
+// version of the snapshot format written by `BlockWriter`; files without a
+// header are of version 1, and version 3 keeps the rows of row-layout tables
+// in page files
+constexpr uint32_t kSnapshotVersion = 3;
+
+// Writes a snapshot file: a magic number and the format version, then blocks
+// of up to `kBlockSize` bytes, each preceded by its size and its CRC-32C. A
+// whole block is written per system call.
+class BlockWriter {
+ public:
+  static constexpr size_t kBlockSize = 1 << 20;
+
+  explicit BlockWriter(const std::filesystem::path& path);
+  BlockWriter(const BlockWriter&) = delete;
+  BlockWriter& operator=(const BlockWriter&) = delete;
+  ~BlockWriter();
+
+  // room for a record of `size` bytes; a record never straddles blocks, so
+  // that it can be read in place
+  char* Append(size_t size);
+  // bytes that may span blocks
+  void Append(std::string_view bytes);
+  template <std::unsigned_integral T>
+  void PutUint(T value);
+
+  // writes the last block and flushes the file to disk
+  void Finish();
+
+ private:
+  void WriteBlock();
+  void WriteAll(const char* data, size_t size);
+
+  std::filesystem::path path_;
+  int fd_;
+  std::string block_;
+};
+
+// Reads a file written by `BlockWriter` a block at a time, checking every
+// block against its checksum.
+class BlockReader {
+ public:
+  explicit BlockReader(const std::filesystem::path& path);
+  BlockReader(const BlockReader&) = delete;
+  BlockReader& operator=(const BlockReader&) = delete;
+  ~BlockReader();
+
+  // whether the file at `path` starts with the header of the format
+  static bool HasHeader(const std::filesystem::path& path);
+
+  // the format version of the file
+  [[nodiscard]] uint32_t version() const;
+
+  [[nodiscard]] bool AtEnd();
+  // a record of `size` bytes, appended by a single `Append(size)`
+  const char* Read(size_t size);
+  template <std::unsigned_integral T>
+  T GetUint();
+  // the rest of the file
+  std::string ReadAll();
+
+ private:
+  // loads the next block, returns false at the end of the file
+  bool NextBlock();
+  size_t ReadSome(char* data, size_t size);
+
+  std::filesystem::path path_;
+  int fd_;
+  uint32_t version_;
+  std::string block_;
+  size_t pos_;
+};
+
+// A stream over the contents of a snapshot file of any version, for the small
+// files that are parsed with `binary::Get*`. A missing file gives a stream
+// that is at its end.
+std::unique_ptr<std::istream> OpenSnapshotFile(
+    const std::filesystem::path& path);
+
+// Writes a whole snapshot file of the current version at once.
+void WriteSnapshotFile(const std::filesystem::path& path,
+                       std::string_view contents);
+
+template <std::unsigned_integral T>
+void BlockWriter::PutUint(T value) {
+  binary::EncodeUint(Append(sizeof(T)), value);
+}
+
+template <std::unsigned_integral T>
+T BlockReader::GetUint() {
+  return binary::DecodeUint<T>(Read(sizeof(T)));
+}
+
+}  // namespace deadfood::storage
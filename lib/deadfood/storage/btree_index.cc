@@ -0,0 +1,208 @@
+#include "btree_index.hh"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <deadfood/core/field_key.hh>
+
+namespace deadfood::storage {
+
+// a node is split once it holds more entries than this
+constexpr size_t kNodeCapacity = 64;
+
+struct BTreeEntry {
+  core::FieldVariant key;
+  size_t row_id;
+};
+
+// Leaves hold the entries themselves. Inner nodes hold separators:
+// `children[i]` contains entries less than `entries[i]`, and `entries[i]` is
+// less than or equal to every entry of `children[i + 1]`.
+struct BTreeNode {
+  bool is_leaf = true;
+  std::vector<BTreeEntry> entries;
+  std::vector<std::unique_ptr<BTreeNode>> children;
+  BTreeNode* next = nullptr;
+};
+
+struct BTreeSplit {
+  BTreeEntry separator;
+  std::unique_ptr<BTreeNode> right;
+};
+
+bool EntryLess(const BTreeEntry& lhs, const BTreeEntry& rhs) {
+  const core::FieldKeyLess less;
+  if (less(lhs.key, rhs.key)) {
+    return true;
+  }
+  if (less(rhs.key, lhs.key)) {
+    return false;
+  }
+  return lhs.row_id < rhs.row_id;
+}
+
+// whether entries with `key` lie before the range starting at `bound`
+bool BeforeLower(const core::FieldVariant& key,
+                 const BTreeIndex::Bound& bound) {
+  const core::FieldKeyLess less;
+  return bound.inclusive ? less(key, bound.key) : !less(bound.key, key);
+}
+
+// whether entries with `key` lie after the range ending at `bound`
+bool AfterUpper(const core::FieldVariant& key, const BTreeIndex::Bound& bound) {
+  const core::FieldKeyLess less;
+  return bound.inclusive ? less(bound.key, key) : !less(key, bound.key);
+}
+
+// the leaf and the position in it of the first entry not before `lower`; the
+// position may be the end of the leaf
+std::pair<const BTreeNode*, std::vector<BTreeEntry>::const_iterator>
+SeekBTreeLower(const BTreeNode& root,
+               const std::optional<BTreeIndex::Bound>& lower) {
+  const auto before_lower = [&](const BTreeEntry& entry) {
+    return lower.has_value() && BeforeLower(entry.key, lower.value());
+  };
+  const BTreeNode* node = &root;
+  while (!node->is_leaf) {
+    const auto it = std::partition_point(node->entries.begin(),
+                                         node->entries.end(), before_lower);
+    node = node->children[static_cast<size_t>(
+                              std::distance(node->entries.begin(), it))]
+               .get();
+  }
+  return {node, std::partition_point(node->entries.begin(),
+                                     node->entries.end(), before_lower)};
+}
+
+size_t ChildIndex(const BTreeNode& node, const BTreeEntry& entry) {
+  const auto it = std::upper_bound(node.entries.begin(), node.entries.end(),
+                                   entry, EntryLess);
+  return static_cast<size_t>(std::distance(node.entries.begin(), it));
+}
+
+BTreeSplit SplitNode(BTreeNode& node) {
+  auto right = std::make_unique<BTreeNode>();
+  right->is_leaf = node.is_leaf;
+  const auto mid = static_cast<long>(node.entries.size() / 2);
+  if (node.is_leaf) {
+    right->entries.assign(std::make_move_iterator(node.entries.begin() + mid),
+                          std::make_move_iterator(node.entries.end()));
+    node.entries.erase(node.entries.begin() + mid, node.entries.end());
+    right->next = node.next;
+    node.next = right.get();
+    BTreeEntry separator = right->entries.front();
+    return {std::move(separator), std::move(right)};
+  }
+  // the middle separator moves up to the parent
+  BTreeEntry separator = std::move(node.entries[static_cast<size_t>(mid)]);
+  right->entries.assign(
+      std::make_move_iterator(node.entries.begin() + mid + 1),
+      std::make_move_iterator(node.entries.end()));
+  right->children.assign(
+      std::make_move_iterator(node.children.begin() + mid + 1),
+      std::make_move_iterator(node.children.end()));
+  node.entries.erase(node.entries.begin() + mid, node.entries.end());
+  node.children.erase(node.children.begin() + mid + 1, node.children.end());
+  return {std::move(separator), std::move(right)};
+}
+
+std::optional<BTreeSplit> InsertInto(BTreeNode& node, BTreeEntry entry) {
+  if (node.is_leaf) {
+    const auto it = std::upper_bound(node.entries.begin(), node.entries.end(),
+                                     entry, EntryLess);
+    node.entries.insert(it, std::move(entry));
+  } else {
+    const size_t child = ChildIndex(node, entry);
+    auto split = InsertInto(*node.children[child], std::move(entry));
+    if (!split.has_value()) {
+      return std::nullopt;
+    }
+    node.entries.insert(node.entries.begin() + static_cast<long>(child),
+                        std::move(split->separator));
+    node.children.insert(node.children.begin() + static_cast<long>(child) + 1,
+                         std::move(split->right));
+  }
+  if (node.entries.size() <= kNodeCapacity) {
+    return std::nullopt;
+  }
+  return SplitNode(node);
+}
+
+BTreeIndex::BTreeIndex() : root_{std::make_unique<BTreeNode>()}, size_{0} {}
+
+BTreeIndex::BTreeIndex(BTreeIndex&& other) noexcept = default;
+
+BTreeIndex& BTreeIndex::operator=(BTreeIndex&& other) noexcept = default;
+
+BTreeIndex::~BTreeIndex() = default;
+
+void BTreeIndex::Insert(const core::FieldVariant& key, size_t row_id) {
+  auto split = InsertInto(*root_, BTreeEntry{.key = key, .row_id = row_id});
+  ++size_;
+  if (!split.has_value()) {
+    return;
+  }
+  auto root = std::make_unique<BTreeNode>();
+  root->is_leaf = false;
+  root->entries.emplace_back(std::move(split->separator));
+  root->children.emplace_back(std::move(root_));
+  root->children.emplace_back(std::move(split->right));
+  root_ = std::move(root);
+}
+
+void BTreeIndex::Erase(const core::FieldVariant& key, size_t row_id) {
+  const BTreeEntry entry{.key = key, .row_id = row_id};
+  BTreeNode* node = root_.get();
+  while (!node->is_leaf) {
+    node = node->children[ChildIndex(*node, entry)].get();
+  }
+  const auto it = std::lower_bound(node->entries.begin(), node->entries.end(),
+                                   entry, EntryLess);
+  if (it != node->entries.end() && !EntryLess(entry, *it)) {
+    node->entries.erase(it);
+    --size_;
+  }
+}
+
+size_t BTreeIndex::size() const { return size_; }
+
+std::vector<size_t> BTreeIndex::Find(const core::FieldVariant& key) const {
+  const Bound bound{.key = key, .inclusive = true};
+  return Range(bound, bound);
+}
+
+bool BTreeIndex::Contains(const core::FieldVariant& key) const {
+  const Bound bound{.key = key, .inclusive = true};
+  auto [node, it] = SeekBTreeLower(*root_, bound);
+  // the entry may start the next leaf, past leaves emptied by deletions
+  while (it == node->entries.end()) {
+    node = node->next;
+    if (node == nullptr) {
+      return false;
+    }
+    it = node->entries.begin();
+  }
+  return !AfterUpper(it->key, bound);
+}
+
+std::vector<size_t> BTreeIndex::Range(const std::optional<Bound>& lower,
+                                      const std::optional<Bound>& upper) const {
+  auto [node, it] = SeekBTreeLower(*root_, lower);
+  std::vector<size_t> ret;
+  while (node != nullptr) {
+    for (; it != node->entries.end(); ++it) {
+      if (upper.has_value() && AfterUpper(it->key, upper.value())) {
+        return ret;
+      }
+      ret.emplace_back(it->row_id);
+    }
+    node = node->next;
+    if (node != nullptr) {
+      it = node->entries.begin();
+    }
+  }
+  return ret;
+}
+
+}  // namespace deadfood::storage
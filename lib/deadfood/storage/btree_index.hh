@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <deadfood/core/field.hh>
+
+namespace deadfood::storage {
+
+struct BTreeNode;
+
+// Ordered index over the values of a single column. Entries are (key, rowid)
+// pairs kept in a B+tree whose leaves are linked, so a range is read by one
+// descent followed by a walk along the leaves. Deletion only removes the entry
+// from its leaf: nodes are never merged, which keeps the tree valid at the cost
+// of some slack after many deletions.
+class BTreeIndex {
+ public:
+  struct Bound {
+    core::FieldVariant key;
+    bool inclusive;
+  };
+
+  BTreeIndex();
+  BTreeIndex(BTreeIndex&& other) noexcept;
+  BTreeIndex& operator=(BTreeIndex&& other) noexcept;
+  ~BTreeIndex();
+
+  void Insert(const core::FieldVariant& key, size_t row_id);
+  void Erase(const core::FieldVariant& key, size_t row_id);
+
+  [[nodiscard]] size_t size() const;
+
+  [[nodiscard]] std::vector<size_t> Find(const core::FieldVariant& key) const;
+  [[nodiscard]] bool Contains(const core::FieldVariant& key) const;
+  // rowids of entries between the bounds in key order; a missing bound leaves
+  // that side open
+  [[nodiscard]] std::vector<size_t> Range(
+      const std::optional<Bound>& lower,
+      const std::optional<Bound>& upper) const;
+
+ private:
+  std::unique_ptr<BTreeNode> root_;
+  size_t size_;
+};
+
+}  // namespace deadfood::storage
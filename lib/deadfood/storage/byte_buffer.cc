@@ -1,11 +1,12 @@
 #include "byte_buffer.hh"
 
-namespace deadfood::storage {
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 
-ByteBuffer::ByteBuffer(size_t size, std::unique_ptr<char[]> ptr)
-    : size_{size}, storage_{std::move(ptr)} {}
+namespace deadfood::storage {
 
-const char* ByteBuffer::data() const { return storage_.get(); }
+const char* ByteBuffer::data() const { return storage_; }
 
 size_t ByteBuffer::size() const { return size_; }
 
@@ -27,7 +28,7 @@ float ByteBuffer::ReadFloat(size_t offset) const {
     char s[kFloatSize];
   } tmp{};
 
-  std::copy(storage_.get() + offset, storage_.get() + offset + kFloatSize,
+  std::copy(storage_ + offset, storage_ + offset + kFloatSize,
             tmp.s);
   // TODO: check endianness
   return tmp.d;
@@ -40,22 +41,16 @@ double ByteBuffer::ReadDouble(size_t offset) const {
     char s[kDoubleSize];
   } tmp{};
 
-  std::copy(storage_.get() + offset, storage_.get() + offset + kDoubleSize,
+  std::copy(storage_ + offset, storage_ + offset + kDoubleSize,
             tmp.s);
   // TODO: check endianness
   return tmp.d;
 }
 
 std::string ByteBuffer::ReadVarchar(size_t offset, size_t count) const {
-  std::string ret;
-  for (size_t i = 0; i < count; ++i) {
-    if (storage_[i + offset]) {
-      ret += storage_[i + offset];
-    } else {
-      break;
-    }
-  }
-  return ret;
+  const char* begin = storage_ + offset;
+  const auto* end = static_cast<const char*>(std::memchr(begin, 0, count));
+  return {begin, end == nullptr ? begin + count : end};
 }
 
 void ByteBuffer::WriteBool(size_t offset, bool value) {
@@ -76,7 +71,7 @@ void ByteBuffer::WriteFloat(size_t offset, float value) {
     char s[kFloatSize];
   } tmp{.d = value};
 
-  std::copy(tmp.s, tmp.s + kFloatSize, storage_.get() + offset);
+  std::copy(tmp.s, tmp.s + kFloatSize, storage_ + offset);
   // TODO: check endianness
 }
 
@@ -87,12 +82,15 @@ void ByteBuffer::WriteDouble(size_t offset, double value) {
     char s[kDoubleSize];
   } tmp{.d = value};
 
-  std::copy(tmp.s, tmp.s + kDoubleSize, storage_.get() + offset);
+  std::copy(tmp.s, tmp.s + kDoubleSize, storage_ + offset);
   // TODO: check endianness
 }
 
-void ByteBuffer::WriteVarchar(size_t offset, const char* value, size_t size) {
-  std::copy(value, value + size, storage_.get() + offset);
+void ByteBuffer::WriteVarchar(size_t offset, const char* value, size_t size,
+                              size_t capacity) {
+  const size_t count = std::min(size, capacity);
+  std::copy(value, value + count, storage_ + offset);
+  std::fill(storage_ + offset + count, storage_ + offset + capacity, 0);
 }
 
 void ByteBuffer::WriteByte(size_t offset, char value) {
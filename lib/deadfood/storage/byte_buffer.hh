@@ -1,16 +1,15 @@
 #pragma once
 
-#include <memory>
-#include <span>
+#include <cstddef>
+#include <string>
 
 namespace deadfood::storage {
 
+// Non-owning view over a single row slot. The memory belongs to the
+// `TableStorage` page the slot lives in.
 class ByteBuffer {
  public:
-  explicit ByteBuffer(size_t size)
-      : size_{size}, storage_{std::make_unique<char[]>(size)} {}
-
-  ByteBuffer(size_t size, std::unique_ptr<char[]> ptr);
+  ByteBuffer(char* data, size_t size) : size_{size}, storage_{data} {}
 
   [[nodiscard]] const char* data() const;
   [[nodiscard]] size_t size() const;
@@ -27,11 +26,14 @@ class ByteBuffer {
   void WriteInt(size_t offset, int value);
   void WriteFloat(size_t offset, float value);
   void WriteDouble(size_t offset, double value);
-  void WriteVarchar(size_t offset, const char* value, size_t size);
+  // copies `size` bytes (at most `capacity`) and zero-fills the rest of the
+  // field, so that stale bytes of a reused slot never leak into the value
+  void WriteVarchar(size_t offset, const char* value, size_t size,
+                    size_t capacity);
 
  private:
   size_t size_;
-  std::unique_ptr<char[]> storage_;
+  char* storage_;
 };
 
 }  // namespace deadfood::storage
@@ -7,15 +7,16 @@ const TableStorage& DBStorage::GetConst(const std::string& table_name) const {
 }
 
 TableStorage& DBStorage::Get(const std::string& table_name) {
-  return storage_[table_name];
+  return storage_.at(table_name);
 }
 
 bool DBStorage::Exists(const std::string& table_name) const {
   return storage_.contains(table_name);
 }
 
-void DBStorage::Add(const std::string& table_name) {
-  storage_.emplace(table_name, TableStorage{});
+void DBStorage::Add(const std::string& table_name, const core::Schema& schema,
+                    Layout layout) {
+  storage_.emplace(table_name, TableStorage{schema, layout});
 }
 
 void DBStorage::Add(const std::string& table_name, TableStorage& storage) {
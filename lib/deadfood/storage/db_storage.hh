@@ -16,7 +16,8 @@ class DBStorage {
 
   bool Exists(const std::string& table_name) const;
 
-  void Add(const std::string& table_name);
+  void Add(const std::string& table_name, const core::Schema& schema,
+           Layout layout);
   void Add(const std::string& table_name, TableStorage& storage);
   void Remove(const std::string& table_name);
 
@@ -0,0 +1,40 @@
+#include "hash_index.hh"
+
+namespace deadfood::storage {
+
+void HashIndex::Insert(const core::FieldVariant& key, size_t row_id) {
+  rows_.emplace(key, row_id);
+}
+
+void HashIndex::Erase(const core::FieldVariant& key, size_t row_id) {
+  auto [it, end] = rows_.equal_range(key);
+  for (; it != end; ++it) {
+    if (it->second == row_id) {
+      rows_.erase(it);
+      return;
+    }
+  }
+}
+
+std::vector<size_t> HashIndex::Find(const core::FieldVariant& key) const {
+  std::vector<size_t> ret;
+  auto [it, end] = rows_.equal_range(key);
+  for (; it != end; ++it) {
+    ret.emplace_back(it->second);
+  }
+  return ret;
+}
+
+size_t HashIndex::Count(const core::FieldVariant& key, size_t limit) const {
+  size_t counter = 0;
+  auto [it, end] = rows_.equal_range(key);
+  for (; it != end; ++it) {
+    ++counter;
+    if (limit != 0 && counter >= limit) {
+      break;
+    }
+  }
+  return counter;
+}
+
+}  // namespace deadfood::storage
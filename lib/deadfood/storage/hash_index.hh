@@ -0,0 +1,27 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <deadfood/core/field.hh>
+#include <deadfood/core/field_key.hh>
+
+namespace deadfood::storage {
+
+// Maps values of a single column to the ids of rows holding them.
+class HashIndex {
+ public:
+  void Insert(const core::FieldVariant& key, size_t row_id);
+  void Erase(const core::FieldVariant& key, size_t row_id);
+
+  [[nodiscard]] std::vector<size_t> Find(const core::FieldVariant& key) const;
+  [[nodiscard]] size_t Count(const core::FieldVariant& key,
+                             size_t limit = 0) const;
+
+ private:
+  std::unordered_multimap<core::FieldVariant, size_t, core::FieldKeyHash,
+                          core::FieldKeyEqual>
+      rows_;
+};
+
+}  // namespace deadfood::storage
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace deadfood::storage {
+
+// How a table keeps its rows in memory.
+enum class Layout : uint8_t {
+  // whole rows side by side, the null bits in front of each row
+  Row,
+  // one contiguous array and one null bitmap per column
+  Column
+};
+
+}  // namespace deadfood::storage
@@ -0,0 +1,106 @@
+#include "manifest.hh"
+
+#include <algorithm>
+#include <array>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#include <deadfood/binary/get.hh>
+#include <deadfood/binary/put.hh>
+#include <deadfood/storage/block_file.hh>
+#include <deadfood/storage/wal.hh>
+
+namespace deadfood::storage {
+
+constexpr std::string_view kManifestFileName = ".manifest";
+constexpr std::array<std::string_view, 5> kCatalogFileNames = {
+    ".schema", ".constraints", ".indices", ".layouts", ".stats"};
+
+std::string CatalogFileName(const std::string& name, uint64_t generation) {
+  return name + "." + std::to_string(generation);
+}
+
+std::string SegmentFileName(const std::string& table_name, size_t segment,
+                            uint64_t generation) {
+  return table_name + "." + std::to_string(segment) + "." +
+         std::to_string(generation) + ".dat";
+}
+
+std::string PageFileName(const std::string& table_name, size_t segment,
+                         uint64_t generation) {
+  return table_name + "." + std::to_string(segment) + "." +
+         std::to_string(generation) + ".pages";
+}
+
+std::optional<Manifest> ReadManifest(const std::filesystem::path& path) {
+  if (!std::filesystem::exists(path / kManifestFileName)) {
+    return std::nullopt;
+  }
+  auto file = OpenSnapshotFile(path / kManifestFileName);
+  auto& stream = *file;
+  Manifest manifest{.generation = binary::GetUint<uint64_t>(stream),
+                    .tables = {}};
+  const auto tables_count = binary::GetUint<uint32_t>(stream);
+  for (uint32_t i = 0; i < tables_count; ++i) {
+    auto& segments = manifest.tables[binary::GetCString(stream)];
+    segments.resize(binary::GetUint<uint32_t>(stream));
+    for (auto& generation : segments) {
+      generation = binary::GetUint<uint64_t>(stream);
+    }
+  }
+  if (!stream) {
+    throw std::runtime_error("the manifest is corrupted");
+  }
+  return manifest;
+}
+
+void WriteManifest(const std::filesystem::path& path,
+                   const Manifest& manifest) {
+  const auto temp_path = path / (std::string{kManifestFileName} + ".tmp");
+  {
+    std::ostringstream stream;
+    binary::PutUint<uint64_t>(stream, manifest.generation);
+    binary::PutUint<uint32_t>(stream,
+                              static_cast<uint32_t>(manifest.tables.size()));
+    for (const auto& [table_name, segments] : manifest.tables) {
+      binary::PutCString(stream, table_name);
+      binary::PutUint<uint32_t>(stream, static_cast<uint32_t>(segments.size()));
+      for (const auto generation : segments) {
+        binary::PutUint<uint64_t>(stream, generation);
+      }
+    }
+    WriteSnapshotFile(temp_path, stream.view());
+  }
+  std::filesystem::rename(temp_path, path / kManifestFileName);
+  SyncPath(path);
+}
+
+void RemoveUnusedFiles(const std::filesystem::path& path,
+                       const Manifest& manifest) {
+  std::set<std::string> used;
+  for (const auto name : kCatalogFileNames) {
+    used.insert(CatalogFileName(std::string{name}, manifest.generation));
+  }
+  for (const auto& [table_name, segments] : manifest.tables) {
+    for (size_t segment = 0; segment < segments.size(); ++segment) {
+      used.insert(SegmentFileName(table_name, segment, segments[segment]));
+      used.insert(PageFileName(table_name, segment, segments[segment]));
+    }
+  }
+  const auto is_snapshot_file = [](const std::string& name) {
+    return name.ends_with(".dat") || name.ends_with(".pages") ||
+           std::ranges::any_of(kCatalogFileNames, [&](std::string_view file) {
+             return name.starts_with(file);
+           });
+  };
+  for (const auto& entry : std::filesystem::directory_iterator(path)) {
+    const auto name = entry.path().filename().string();
+    if (is_snapshot_file(name) && !used.contains(name)) {
+      std::filesystem::remove(entry.path());
+    }
+  }
+}
+
+}  // namespace deadfood::storage
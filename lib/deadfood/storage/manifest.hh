@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace deadfood::storage {
+
+// The files making up the snapshot in a directory. Every checkpoint is a new
+// generation: the files it writes are named after it, and the manifest is
+// replaced only once they are all on disk, so a crash leaves the previous
+// snapshot whole. Segments that did not change keep their older files.
+struct Manifest {
+  // generation of the latest checkpoint, which wrote the catalog files
+  uint64_t generation = 0;
+  // for every table, the generation of the file of each of its segments
+  std::map<std::string, std::vector<uint64_t>> tables;
+};
+
+// the name of a catalog file (".schema", ...) of a generation
+std::string CatalogFileName(const std::string& name, uint64_t generation);
+std::string SegmentFileName(const std::string& table_name, size_t segment,
+                            uint64_t generation);
+// the rows of a segment of a row-layout table, next to its segment file
+std::string PageFileName(const std::string& table_name, size_t segment,
+                         uint64_t generation);
+
+// the manifest of the snapshot in `path`, nullopt for a snapshot made before
+// manifests or no snapshot at all
+std::optional<Manifest> ReadManifest(const std::filesystem::path& path);
+// atomically replaces the manifest of `path`
+void WriteManifest(const std::filesystem::path& path,
+                   const Manifest& manifest);
+// removes the snapshot files in `path` that `manifest` does not refer to,
+// including those of snapshots made before manifests
+void RemoveUnusedFiles(const std::filesystem::path& path,
+                       const Manifest& manifest);
+
+}  // namespace deadfood::storage
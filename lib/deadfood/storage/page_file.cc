@@ -0,0 +1,172 @@
+#include "page_file.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <deadfood/binary/big_endian.hh>
+#include <deadfood/storage/block_file.hh>
+#include <deadfood/util/crc32c.hh>
+#include <deadfood/util/system_error.hh>
+
+namespace deadfood::storage {
+
+constexpr std::array<char, 8> kPageFileMagic = {'\x89', 'D', 'F', 'P',
+                                                '\r',   '\n', '\x1a', '\n'};
+// pages handed to a single writev
+constexpr size_t kPagesPerWrite = 64;
+
+void WritePageFile(const std::filesystem::path& path,
+                   std::span<const char* const> pages, size_t page_size) {
+  uint32_t crc = 0;
+  for (const char* page : pages) {
+    crc = util::Crc32c(page, page_size, crc);
+  }
+  std::array<char, PageFile::kPageFileHeaderSize> header{};
+  char* pos = std::ranges::copy(kPageFileMagic, header.begin()).out;
+  pos = binary::EncodeUint(pos, kSnapshotVersion);
+  pos = binary::EncodeUint(pos, static_cast<uint32_t>(page_size));
+  pos = binary::EncodeUint<uint64_t>(pos, pages.size());
+  binary::EncodeUint(pos, crc);
+
+  const int fd =
+      ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw util::SystemError("cannot create " + path.string());
+  }
+  // the pages are written from where they are, a batch per system call
+  std::vector<iovec> batch;
+  batch.push_back({header.data(), header.size()});
+  size_t next = 0;
+  while (!batch.empty() || next < pages.size()) {
+    while (next < pages.size() && batch.size() < kPagesPerWrite) {
+      batch.push_back({const_cast<char*>(pages[next++]), page_size});
+    }
+    auto written = ::writev(fd, batch.data(), static_cast<int>(batch.size()));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      const auto error = util::SystemError("cannot write " + path.string());
+      ::close(fd);
+      throw error;
+    }
+    // drop what was written, keeping the rest of a partly written buffer
+    auto it = batch.begin();
+    for (; it != batch.end() && static_cast<size_t>(written) >= it->iov_len;
+         ++it) {
+      written -= static_cast<ssize_t>(it->iov_len);
+    }
+    if (it != batch.end()) {
+      it->iov_base = static_cast<char*>(it->iov_base) + written;
+      it->iov_len -= static_cast<size_t>(written);
+    }
+    batch.erase(batch.begin(), it);
+  }
+  if (::fsync(fd) != 0) {
+    const auto error = util::SystemError("cannot sync " + path.string());
+    ::close(fd);
+    throw error;
+  }
+  if (::close(fd) != 0) {
+    throw util::SystemError("cannot close " + path.string());
+  }
+}
+
+PageFile::PageFile(const std::filesystem::path& path, size_t page_size,
+                   bool map)
+    : page_size_{page_size}, page_count_{0}, pages_{nullptr} {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw util::SystemError("cannot open " + path.string());
+  }
+  const auto read_all = [&](char* data, size_t size, off_t offset) {
+    while (size != 0) {
+      const auto got = ::pread(fd, data, size, offset);
+      if (got < 0 && errno == EINTR) {
+        continue;
+      }
+      if (got <= 0) {
+        return false;
+      }
+      data += got;
+      size -= static_cast<size_t>(got);
+      offset += got;
+    }
+    return true;
+  };
+  struct stat info {};
+  std::array<char, kPageFileHeaderSize> header{};
+  if (::fstat(fd, &info) != 0) {
+    const auto error = util::SystemError("cannot stat " + path.string());
+    ::close(fd);
+    throw error;
+  }
+  if (!read_all(header.data(), header.size(), 0)) {
+    ::close(fd);
+    throw std::runtime_error(path.string() + " is truncated");
+  }
+  // version, page size, page count and checksum follow the magic number
+  const char* fields = header.data() + kPageFileMagic.size();
+  const auto version = binary::DecodeUint<uint32_t>(fields);
+  const auto file_page_size = binary::DecodeUint<uint32_t>(fields + 4);
+  page_count_ = binary::DecodeUint<uint64_t>(fields + 8);
+  const auto crc = binary::DecodeUint<uint32_t>(fields + 16);
+  const size_t size = page_count_ * page_size_;
+  if (!std::equal(kPageFileMagic.begin(), kPageFileMagic.end(),
+                  header.begin()) ||
+      version > kSnapshotVersion || file_page_size != page_size_ ||
+      static_cast<size_t>(info.st_size) != kPageFileHeaderSize + size) {
+    ::close(fd);
+    throw std::runtime_error(path.string() + " is corrupted");
+  }
+
+  if (map) {
+    const size_t length = kPageFileHeaderSize + size;
+    void* mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      const auto error = util::SystemError("cannot map " + path.string());
+      ::close(fd);
+      throw error;
+    }
+    // the mapping outlives the descriptor
+    ::close(fd);
+    memory_ = std::shared_ptr<char[]>(
+        static_cast<char*>(mapping),
+        [length](char* data) { ::munmap(data, length); });
+    pages_ = memory_.get() + kPageFileHeaderSize;
+    return;
+  }
+
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  memory_ = std::make_shared_for_overwrite<char[]>(size);
+  pages_ = memory_.get();
+  const bool complete =
+      read_all(pages_, size, static_cast<off_t>(kPageFileHeaderSize));
+  ::close(fd);
+  if (!complete) {
+    throw std::runtime_error(path.string() + " is truncated");
+  }
+  if (util::Crc32c(pages_, size) != crc) {
+    throw std::runtime_error(path.string() + " is corrupted");
+  }
+}
+
+size_t PageFile::page_count() const { return page_count_; }
+
+std::shared_ptr<char[]> PageFile::page(size_t index) const {
+  return {memory_, pages_ + index * page_size_};
+}
+
+}  // namespace deadfood::storage
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace deadfood::storage {
+
+// Writes the pages of a row-layout table as they are in memory: a header of
+// `kPageFileHeaderSize` bytes (magic number, format version, page size, page
+// count and the CRC-32C of the pages), then the pages back to back. The
+// header fills an OS page, so a mapping of the file has its first page
+// aligned.
+void WritePageFile(const std::filesystem::path& path,
+                   std::span<const char* const> pages, size_t page_size);
+
+// The pages of a file written by `WritePageFile`. Read into memory, they are
+// checked against their checksum. Mapped, nothing is read until a page is
+// touched, and the pages are only checked to fit in the file: the mapping is
+// private, so a page stays shared with the page cache until it is written to,
+// when the kernel copies it. The files of a snapshot are never rewritten, so
+// the mapping keeps showing what the file held when it was opened.
+class PageFile {
+ public:
+  static constexpr size_t kPageFileHeaderSize = 4096;
+
+  PageFile(const std::filesystem::path& path, size_t page_size, bool map);
+
+  [[nodiscard]] size_t page_count() const;
+  // the page shares ownership of the memory of the whole file, which lives as
+  // long as one of its pages does
+  [[nodiscard]] std::shared_ptr<char[]> page(size_t index) const;
+
+ private:
+  size_t page_size_;
+  size_t page_count_;
+  // the mapping of the file or the buffer the pages were read into
+  std::shared_ptr<char[]> memory_;
+  char* pages_;
+};
+
+}  // namespace deadfood::storage
@@ -1,18 +1,372 @@
 #include "table_storage.hh"
 
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#include <deadfood/core/schema.hh>
+
 namespace deadfood::storage {
 
-ByteBuffer& TableStorage::GetByRowId(size_t row_id) {
-  return storage_.at(row_id);
+constexpr size_t kSlotsPerWord = 64;
+// the compactor leaves smaller amounts of dead slots alone
+constexpr size_t kMinDeadSlotsToCompact = 1024;
+
+size_t RowsPerPageShift(size_t row_size) {
+  size_t shift = 0;
+  while ((static_cast<size_t>(2) << shift) * std::max<size_t>(row_size, 1) <=
+         TableStorage::kPageSize) {
+    ++shift;
+  }
+  return shift;
 }
 
+TableStorage::TableStorage(const core::Schema& schema, Layout layout)
+    : layout_{layout},
+      row_size_{schema.size()},
+      page_shift_{RowsPerPageShift(row_size_)},
+      slot_mask_{(static_cast<size_t>(1) << page_shift_) - 1},
+      dead_count_{0},
+      next_row_id_{0} {
+  for (const auto& field : schema.fields()) {
+    offsets_.emplace_back(schema.Offset(field));
+    widths_.emplace_back(schema.field_info(field).size());
+  }
+  if (layout_ == Layout::Column) {
+    columns_.resize(widths_.size());
+    null_bitmaps_.resize(widths_.size());
+  }
+}
+
+Layout TableStorage::layout() const { return layout_; }
+
+size_t TableStorage::row_size() const { return row_size_; }
+
+size_t TableStorage::size() const { return slots_.size(); }
+
+size_t TableStorage::slot_count() const { return row_ids_.size(); }
+
 bool TableStorage::Exists(size_t row_id) const {
-  return storage_.contains(row_id);
+  return slots_.contains(row_id);
+}
+
+size_t TableStorage::dead_count() const { return dead_count_; }
+
+bool TableStorage::IsLive(size_t slot) const {
+  return ((tombstones_[slot / kSlotsPerWord] >> (slot % kSlotsPerWord)) & 1) ==
+         0;
+}
+
+size_t TableStorage::NextLiveSlot(size_t slot, size_t end) const {
+  end = std::min(end, slot_count());
+  while (slot < end) {
+    const uint64_t live =
+        ~tombstones_[slot / kSlotsPerWord] >> (slot % kSlotsPerWord);
+    if (live != 0) {
+      slot += static_cast<size_t>(std::countr_zero(live));
+      break;
+    }
+    slot = (slot / kSlotsPerWord + 1) * kSlotsPerWord;
+  }
+  return std::min(slot, end);
+}
+
+size_t TableStorage::RowIdAt(size_t slot) const { return row_ids_[slot]; }
+
+size_t TableStorage::SlotOf(size_t row_id) const { return slots_.at(row_id); }
+
+bool TableStorage::IsNull(size_t slot, size_t field) const {
+  if (layout_ == Layout::Column) {
+    return (null_bitmaps_[field][slot / 8] >> (slot % 8)) & 1;
+  }
+  return (static_cast<uint8_t>(slot_data(slot)[field / 8]) >> (field % 8)) & 1;
+}
+
+void TableStorage::SetNull(size_t slot, size_t field, bool is_null) {
+  // fields are only ever written after their null bit is set
+  MarkDirty(slot);
+  uint8_t* byte =
+      layout_ == Layout::Column
+          ? &null_bitmaps_[field][slot / 8]
+          : reinterpret_cast<uint8_t*>(slot_data(slot) + field / 8);
+  const auto bit_mask =
+      static_cast<uint8_t>(1 << (layout_ == Layout::Column ? slot % 8
+                                                           : field % 8));
+  if (is_null) {
+    *byte = static_cast<uint8_t>(*byte | bit_mask);
+  } else {
+    *byte = static_cast<uint8_t>(*byte & ~bit_mask);
+  }
+}
+
+ByteBuffer TableStorage::GetCell(size_t slot, size_t field) {
+  return {cell_data(slot, field), widths_[field]};
+}
+
+void TableStorage::ReadRow(size_t slot, char* data) const {
+  if (layout_ == Layout::Row) {
+    std::copy_n(slot_data(slot), row_size_, data);
+    return;
+  }
+  std::fill_n(data, row_size_, 0);
+  for (size_t field = 0; field < widths_.size(); ++field) {
+    if (IsNull(slot, field)) {
+      data[field / 8] = static_cast<char>(data[field / 8] | (1 << (field % 8)));
+    }
+    std::copy_n(cell_data(slot, field), widths_[field], data + offsets_[field]);
+  }
+}
+
+void TableStorage::WriteRow(size_t slot, const char* data) {
+  MarkDirty(slot);
+  if (layout_ == Layout::Row) {
+    std::copy_n(data, row_size_, slot_data(slot));
+    return;
+  }
+  for (size_t field = 0; field < widths_.size(); ++field) {
+    SetNull(slot, field,
+            (static_cast<uint8_t>(data[field / 8]) >> (field % 8)) & 1);
+    std::copy_n(data + offsets_[field], widths_[field], cell_data(slot, field));
+  }
+}
+
+size_t TableStorage::Insert() { return Insert(next_row_id_); }
+
+size_t TableStorage::Insert(size_t row_id) {
+  if (slots_.contains(row_id)) {
+    throw std::runtime_error("row with id " + std::to_string(row_id) +
+                             " already exists");
+  }
+  const size_t slot = AllocateSlot();
+  row_ids_[slot] = row_id;
+  slots_.emplace(row_id, slot);
+  next_row_id_ = std::max(next_row_id_, row_id + 1);
+  return slot;
+}
+
+void TableStorage::Reserve(size_t rows) {
+  const size_t slots = row_ids_.size() + rows;
+  if (layout_ == Layout::Row) {
+    const size_t pages = (slots + slot_mask_) >> page_shift_;
+    while (pages_.size() < pages) {
+      pages_.emplace_back(std::make_shared<char[]>(page_size()));
+    }
+  } else {
+    for (size_t field = 0; field < widths_.size(); ++field) {
+      columns_[field].reserve(slots * widths_[field]);
+      null_bitmaps_[field].reserve((slots + 7) / 8);
+    }
+  }
+  row_ids_.reserve(slots);
+  tombstones_.reserve((slots + kSlotsPerWord - 1) / kSlotsPerWord);
+  slots_.reserve(slots_.size() + rows);
+}
+
+void TableStorage::RemoveSlot(size_t slot) {
+  if (slot >= row_ids_.size() || !IsLive(slot)) {
+    return;
+  }
+  slots_.erase(row_ids_[slot]);
+  row_ids_[slot] = kNoRow;
+  tombstones_[slot / kSlotsPerWord] |= uint64_t{1} << (slot % kSlotsPerWord);
+  ++dead_count_;
+  MarkDirty(slot);
+}
+
+void TableStorage::InsertTombstone() {
+  const size_t slot = AllocateSlot();
+  tombstones_[slot / kSlotsPerWord] |= uint64_t{1} << (slot % kSlotsPerWord);
+  ++dead_count_;
+}
+
+bool TableStorage::NeedsCompaction() const {
+  return dead_count_ >= kMinDeadSlotsToCompact &&
+         dead_count_ * 2 >= slot_count();
+}
+
+void TableStorage::MoveSlot(size_t from, size_t to) {
+  MarkDirty(to);
+  if (layout_ == Layout::Row) {
+    std::copy_n(slot_data(from), row_size_, slot_data(to));
+  } else {
+    for (size_t field = 0; field < widths_.size(); ++field) {
+      std::copy_n(cell_data(from, field), widths_[field],
+                  cell_data(to, field));
+      SetNull(to, field, IsNull(from, field));
+    }
+  }
+  row_ids_[to] = row_ids_[from];
+  slots_[row_ids_[to]] = to;
+}
+
+void TableStorage::Compact() {
+  if (dead_count_ == 0) {
+    return;
+  }
+  size_t live = 0;
+  for (size_t slot = NextLiveSlot(0, slot_count()); slot < slot_count();
+       slot = NextLiveSlot(slot + 1, slot_count())) {
+    if (slot != live) {
+      MoveSlot(slot, live);
+    }
+    ++live;
+  }
+  // the segment the table now ends in loses its dead slots at the end
+  if (live % kSegmentSlots != 0) {
+    MarkDirty(live);
+  }
+
+  // slots past the live rows must read as zeroes when handed out again
+  if (layout_ == Layout::Row) {
+    pages_.resize((live + slot_mask_) >> page_shift_);
+    pages_.shrink_to_fit();
+    if ((live & slot_mask_) != 0) {
+      std::fill_n(slot_data(live),
+                  (slot_mask_ + 1 - (live & slot_mask_)) * row_size_, 0);
+    }
+  } else {
+    for (size_t field = 0; field < widths_.size(); ++field) {
+      columns_[field].resize(live * widths_[field]);
+      columns_[field].shrink_to_fit();
+      auto& nulls = null_bitmaps_[field];
+      nulls.resize((live + 7) / 8);
+      nulls.shrink_to_fit();
+      if (live % 8 != 0) {
+        nulls.back() = static_cast<uint8_t>(nulls.back() &
+                                            ((1 << (live % 8)) - 1));
+      }
+    }
+  }
+  row_ids_.resize(live);
+  row_ids_.shrink_to_fit();
+  tombstones_.assign((live + kSlotsPerWord - 1) / kSlotsPerWord, 0);
+  dead_count_ = 0;
+  dirty_segments_.resize(segment_count());
+}
+
+size_t TableStorage::page_size() const {
+  return (slot_mask_ + 1) * row_size_;
+}
+
+size_t TableStorage::slots_per_page() const { return slot_mask_ + 1; }
+
+const char* TableStorage::page(size_t index) const {
+  return pages_[index].get();
+}
+
+void TableStorage::AppendPage(std::shared_ptr<char[]> page) {
+  if (layout_ != Layout::Row ||
+      row_ids_.size() != pages_.size() << page_shift_) {
+    throw std::runtime_error("a page is appended before its slots");
+  }
+  pages_.push_back(std::move(page));
+}
+
+size_t TableStorage::segment_count() const {
+  return (slot_count() + kSegmentSlots - 1) / kSegmentSlots;
+}
+
+bool TableStorage::IsSegmentDirty(size_t segment) const {
+  return segment < dirty_segments_.size() && dirty_segments_[segment];
+}
+
+void TableStorage::MarkClean() {
+  dirty_segments_.assign(dirty_segments_.size(), false);
+}
+
+void TableStorage::MarkDirty(size_t slot) {
+  const size_t segment = slot / kSegmentSlots;
+  if (segment >= dirty_segments_.size()) {
+    dirty_segments_.resize(segment + 1);
+  }
+  dirty_segments_[segment] = true;
+}
+
+HashIndex& TableStorage::AddHashIndex(const std::string& field_name) {
+  return hash_indices_[field_name];
+}
+
+HashIndex* TableStorage::hash_index(const std::string& field_name) {
+  auto it = hash_indices_.find(field_name);
+  return it == hash_indices_.end() ? nullptr : &it->second;
+}
+
+const HashIndex* TableStorage::hash_index(const std::string& field_name) const {
+  auto it = hash_indices_.find(field_name);
+  return it == hash_indices_.end() ? nullptr : &it->second;
+}
+
+std::unordered_map<std::string, HashIndex>& TableStorage::hash_indices() {
+  return hash_indices_;
+}
+
+BTreeIndex& TableStorage::AddBTreeIndex(const std::string& field_name) {
+  return btree_indices_[field_name];
+}
+
+void TableStorage::RemoveBTreeIndex(const std::string& field_name) {
+  btree_indices_.erase(field_name);
+}
+
+BTreeIndex* TableStorage::btree_index(const std::string& field_name) {
+  auto it = btree_indices_.find(field_name);
+  return it == btree_indices_.end() ? nullptr : &it->second;
+}
+
+const BTreeIndex* TableStorage::btree_index(
+    const std::string& field_name) const {
+  auto it = btree_indices_.find(field_name);
+  return it == btree_indices_.end() ? nullptr : &it->second;
+}
+
+std::unordered_map<std::string, BTreeIndex>& TableStorage::btree_indices() {
+  return btree_indices_;
+}
+
+size_t TableStorage::AllocateSlot() {
+  const size_t slot = row_ids_.size();
+  if (layout_ == Layout::Row) {
+    if ((slot >> page_shift_) == pages_.size()) {
+      // make_shared value-initializes the page, so fresh slots are zeroed
+      pages_.emplace_back(std::make_shared<char[]>(page_size()));
+    }
+  } else {
+    for (size_t field = 0; field < widths_.size(); ++field) {
+      columns_[field].resize((slot + 1) * widths_[field]);
+      if (slot % 8 == 0) {
+        null_bitmaps_[field].emplace_back(0);
+      }
+    }
+  }
+  row_ids_.emplace_back(kNoRow);
+  if (slot % kSlotsPerWord == 0) {
+    tombstones_.emplace_back(0);
+  }
+  MarkDirty(slot);
+  return slot;
+}
+
+const char* TableStorage::slot_data(size_t slot) const {
+  return pages_[slot >> page_shift_].get() + (slot & slot_mask_) * row_size_;
+}
+
+char* TableStorage::slot_data(size_t slot) {
+  return pages_[slot >> page_shift_].get() + (slot & slot_mask_) * row_size_;
+}
+
+const char* TableStorage::cell_data(size_t slot, size_t field) const {
+  if (layout_ == Layout::Column) {
+    return columns_[field].data() + slot * widths_[field];
+  }
+  return slot_data(slot) + offsets_[field];
 }
 
-std::map<size_t, ByteBuffer>& TableStorage::storage() { return storage_; }
-const std::map<size_t, ByteBuffer>& TableStorage::storage_const() const {
-  return storage_;
+char* TableStorage::cell_data(size_t slot, size_t field) {
+  if (layout_ == Layout::Column) {
+    return columns_[field].data() + slot * widths_[field];
+  }
+  return slot_data(slot) + offsets_[field];
 }
 
-}  // namespace deadfood::storage
\ No newline at end of file
+}  // namespace deadfood::storage
@@ -1,24 +1,159 @@
 #pragma once
 
-#include <map>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
+#include <deadfood/storage/btree_index.hh>
 #include <deadfood/storage/byte_buffer.hh>
+#include <deadfood/storage/hash_index.hh>
+#include <deadfood/storage/layout.hh>
+
+namespace deadfood::core {
+class Schema;
+}  // namespace deadfood::core
 
 namespace deadfood::storage {
 
+// Fixed-stride table heap. With the row layout, rows are kept in large
+// contiguous pages of `row_size()`-sized slots, so a full scan is a sequential
+// sweep over memory. With the column layout, every column is an array of its
+// own with a separate null bitmap, so a scan touches only the columns it
+// reads. A rowid -> slot directory provides point access.
+//
+// Deleting a row only sets its bit in a tombstone bitmap, which scans skip a
+// word of 64 slots at a time. The slots are reclaimed by `Compact`, which
+// slides the live rows down over the dead ones.
+//
+// The pages of the row layout are shared pointers, so that a page can point
+// into a mapped snapshot file and keep the mapping alive.
+//
+// For incremental checkpoints the slots are grouped in segments of
+// `kSegmentSlots`, and a segment is dirty once one of its slots changes.
+//
+// Fields are addressed by their index in the schema. `ReadRow` / `WriteRow`
+// convert a slot from / to the row image (null bits followed by the fields at
+// their schema offsets) regardless of the layout.
 class TableStorage {
  public:
-  ByteBuffer& GetByRowId(size_t row_id);
+  static constexpr size_t kPageSize = 1 << 16;
+  static constexpr size_t kNoRow = static_cast<size_t>(-1);
+  static constexpr size_t kSegmentSlots = 1 << 16;
+
+  explicit TableStorage(const core::Schema& schema,
+                        Layout layout = Layout::Row);
+  TableStorage(const TableStorage&) = delete;
+  TableStorage& operator=(const TableStorage&) = delete;
+  TableStorage(TableStorage&&) = default;
+  TableStorage& operator=(TableStorage&&) = default;
+
+  [[nodiscard]] Layout layout() const;
+  // size of the row image
+  [[nodiscard]] size_t row_size() const;
+  // number of live rows
+  [[nodiscard]] size_t size() const;
+  // number of slots ever handed out, including free ones
+  [[nodiscard]] size_t slot_count() const;
+
+  // number of slots of deleted rows not yet reclaimed
+  [[nodiscard]] size_t dead_count() const;
 
   [[nodiscard]] bool Exists(size_t row_id) const;
+  [[nodiscard]] bool IsLive(size_t slot) const;
+  // the first live slot in [slot, end), or `end` if there is none
+  [[nodiscard]] size_t NextLiveSlot(size_t slot, size_t end) const;
+  [[nodiscard]] size_t RowIdAt(size_t slot) const;
+  [[nodiscard]] size_t SlotOf(size_t row_id) const;
+
+  [[nodiscard]] bool IsNull(size_t slot, size_t field) const;
+  void SetNull(size_t slot, size_t field, bool is_null);
+  // view over the bytes of a single field
+  ByteBuffer GetCell(size_t slot, size_t field);
+
+  void ReadRow(size_t slot, char* data) const;
+  void WriteRow(size_t slot, const char* data);
+
+  // allocates a zeroed slot for a new row and returns the slot index
+  size_t Insert();
+  size_t Insert(size_t row_id);
+  // makes room for `rows` more rows at once, so that inserting them does not
+  // reallocate as it goes
+  void Reserve(size_t rows);
 
-  std::map<size_t, ByteBuffer>& storage();
-  [[nodiscard]] const std::map<size_t, ByteBuffer>& storage_const() const;
+  // tombstones the row in `slot`
+  void RemoveSlot(size_t slot);
+  // appends the slot of a deleted row, to restore a table slot by slot
+  void InsertTombstone();
 
+  // whether dead slots make up enough of the table for compacting to pay
+  [[nodiscard]] bool NeedsCompaction() const;
+  // moves the live rows to the first slots, keeping their order, and frees
+  // the rest; row ids stay, slot numbers change
+  void Compact();
 
+  // pages of the row layout, each of `page_size()` bytes holding the images
+  // of `slots_per_page()` slots, a power of two
+  [[nodiscard]] size_t page_size() const;
+  [[nodiscard]] size_t slots_per_page() const;
+  [[nodiscard]] const char* page(size_t index) const;
+  // appends a page holding the images of the next slots, which are then added
+  // by `Insert(row_id)` and `InsertTombstone` without being written; the
+  // slots of the pages before must all be in use
+  void AppendPage(std::shared_ptr<char[]> page);
+
+  [[nodiscard]] size_t segment_count() const;
+  // whether a slot of the segment changed since the last `MarkClean`
+  [[nodiscard]] bool IsSegmentDirty(size_t segment) const;
+  void MarkClean();
+
+  // indices are keyed by column name and are kept up to date by `TableScan`
+  HashIndex& AddHashIndex(const std::string& field_name);
+  [[nodiscard]] HashIndex* hash_index(const std::string& field_name);
+  [[nodiscard]] const HashIndex* hash_index(
+      const std::string& field_name) const;
+  [[nodiscard]] std::unordered_map<std::string, HashIndex>& hash_indices();
+
+  BTreeIndex& AddBTreeIndex(const std::string& field_name);
+  void RemoveBTreeIndex(const std::string& field_name);
+  [[nodiscard]] BTreeIndex* btree_index(const std::string& field_name);
+  [[nodiscard]] const BTreeIndex* btree_index(
+      const std::string& field_name) const;
+  [[nodiscard]] std::unordered_map<std::string, BTreeIndex>& btree_indices();
 
  private:
-  std::map<size_t, ByteBuffer> storage_;
+  size_t AllocateSlot();
+  void MoveSlot(size_t from, size_t to);
+  void MarkDirty(size_t slot);
+  [[nodiscard]] const char* slot_data(size_t slot) const;
+  char* slot_data(size_t slot);
+  [[nodiscard]] const char* cell_data(size_t slot, size_t field) const;
+  char* cell_data(size_t slot, size_t field);
+
+  Layout layout_;
+  size_t row_size_;
+  // position of every field in the row image and its width
+  std::vector<size_t> offsets_;
+  std::vector<size_t> widths_;
+
+  // row layout
+  size_t page_shift_;
+  size_t slot_mask_;
+  std::vector<std::shared_ptr<char[]>> pages_;
+  // column layout
+  std::vector<std::vector<char>> columns_;
+  std::vector<std::vector<uint8_t>> null_bitmaps_;
+
+  std::vector<size_t> row_ids_;
+  // bit `s % 64` of word `s / 64` is set if slot `s` holds a deleted row
+  std::vector<uint64_t> tombstones_;
+  size_t dead_count_;
+  std::vector<bool> dirty_segments_;
+  std::unordered_map<size_t, size_t> slots_;
+  size_t next_row_id_;
+  std::unordered_map<std::string, HashIndex> hash_indices_;
+  std::unordered_map<std::string, BTreeIndex> btree_indices_;
 };
 
 }  // namespace deadfood::storage
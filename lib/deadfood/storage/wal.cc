@@ -0,0 +1,154 @@
+#include "wal.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <deadfood/binary/big_endian.hh>
+#include <deadfood/util/crc32c.hh>
+#include <deadfood/util/system_error.hh>
+
+namespace deadfood::storage {
+
+constexpr size_t kFrameHeaderSize = 2 * sizeof(uint32_t);
+
+WriteAheadLog::WriteAheadLog(const std::filesystem::path& path)
+    : path_{path},
+      fd_{::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                 0644)},
+      queued_{0},
+      synced_{0},
+      writing_{false},
+      broken_{false} {
+  if (fd_ < 0) {
+    throw util::SystemError("cannot open the log");
+  }
+  // the log may have just been created, its directory entry has to last too
+  try {
+    const auto directory = path.parent_path();
+    SyncPath(directory.empty() ? "." : directory);
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+}
+
+WriteAheadLog::~WriteAheadLog() { ::close(fd_); }
+
+const std::filesystem::path& WriteAheadLog::path() const { return path_; }
+
+void WriteAheadLog::Append(std::string_view payload) {
+  if (payload.size() > UINT32_MAX) {
+    throw std::runtime_error("statement too large to log");
+  }
+  std::unique_lock lock(mutex_);
+  char header[kFrameHeaderSize];
+  binary::EncodeUint(
+      binary::EncodeUint(header, static_cast<uint32_t>(payload.size())),
+      util::Crc32c(payload.data(), payload.size()));
+  pending_.append(header, kFrameHeaderSize);
+  pending_.append(payload);
+  const uint64_t frame = ++queued_;
+
+  while (synced_ < frame) {
+    if (broken_) {
+      throw std::runtime_error("the log could not be written");
+    }
+    if (writing_) {
+      durable_.wait(lock);
+      continue;
+    }
+    // lead: write everything queued so far, ours included
+    writing_ = true;
+    std::string frames;
+    frames.swap(pending_);
+    const uint64_t last = queued_;
+    lock.unlock();
+    try {
+      Write(frames);
+    } catch (...) {
+      lock.lock();
+      writing_ = false;
+      broken_ = true;
+      durable_.notify_all();
+      throw;
+    }
+    lock.lock();
+    writing_ = false;
+    synced_ = last;
+    durable_.notify_all();
+  }
+}
+
+void WriteAheadLog::Write(const std::string& frames) const {
+  const char* data = frames.data();
+  size_t left = frames.size();
+  while (left != 0) {
+    const auto written = ::write(fd_, data, left);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw util::SystemError("cannot write the log");
+    }
+    data += written;
+    left -= static_cast<size_t>(written);
+  }
+  if (::fdatasync(fd_) != 0) {
+    throw util::SystemError("cannot sync the log");
+  }
+}
+
+void WriteAheadLog::Truncate() {
+  std::unique_lock lock(mutex_);
+  durable_.wait(lock, [&] { return !writing_; });
+  if (::ftruncate(fd_, 0) != 0 || ::fdatasync(fd_) != 0) {
+    throw util::SystemError("cannot truncate the log");
+  }
+}
+
+std::vector<std::string> WriteAheadLog::Recover(
+    const std::filesystem::path& path) {
+  std::vector<std::string> payloads;
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    return payloads;
+  }
+  const std::string log{std::istreambuf_iterator<char>(stream),
+                        std::istreambuf_iterator<char>()};
+  size_t pos = 0;
+  while (log.size() - pos >= kFrameHeaderSize) {
+    const size_t size = binary::DecodeUint<uint32_t>(log.data() + pos);
+    const auto crc =
+        binary::DecodeUint<uint32_t>(log.data() + pos + sizeof(uint32_t));
+    const size_t begin = pos + kFrameHeaderSize;
+    if (log.size() - begin < size ||
+        util::Crc32c(log.data() + begin, size) != crc) {
+      break;
+    }
+    payloads.emplace_back(log, begin, size);
+    pos = begin + size;
+  }
+  if (pos != log.size()) {
+    std::filesystem::resize_file(path, pos);
+  }
+  return payloads;
+}
+
+void SyncPath(const std::filesystem::path& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw util::SystemError("cannot open " + path.string());
+  }
+  const int ret = ::fsync(fd);
+  ::close(fd);
+  if (ret != 0) {
+    throw util::SystemError("cannot sync " + path.string());
+  }
+}
+
+}  // namespace deadfood::storage
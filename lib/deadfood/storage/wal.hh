@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace deadfood::storage {
+
+// Append-only log of frames, each holding the changes made by one statement.
+// A frame is the size of its payload, the CRC-32C of the payload and the
+// payload itself, so a frame torn by a crash is recognized and dropped.
+//
+// Statements committing at the same time share one write and one sync (group
+// commit): a committer that finds no write in progress becomes the leader and
+// writes the frames of everyone who queued meanwhile in a single append, the
+// others wait until their frame is durable.
+class WriteAheadLog {
+ public:
+  explicit WriteAheadLog(const std::filesystem::path& path);
+  WriteAheadLog(const WriteAheadLog&) = delete;
+  WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+  ~WriteAheadLog();
+
+  [[nodiscard]] const std::filesystem::path& path() const;
+
+  // appends a frame holding `payload` and returns once it is on disk
+  void Append(std::string_view payload);
+  // drops every frame, once a checkpoint holds their changes
+  void Truncate();
+
+  // Returns the payloads of the log at `path` in order, which may not exist.
+  // The log is cut after the last intact frame, so that frames appended later
+  // do not follow a torn one.
+  static std::vector<std::string> Recover(const std::filesystem::path& path);
+
+ private:
+  // writes `frames` at the end of the file and syncs it
+  void Write(const std::string& frames) const;
+
+  std::filesystem::path path_;
+  int fd_;
+  std::mutex mutex_;
+  std::condition_variable durable_;
+  // frames queued since the leader took the last ones
+  std::string pending_;
+  // frames are numbered from 1 as they are queued
+  uint64_t queued_;
+  uint64_t synced_;
+  bool writing_;
+  // set when a write fails, every later commit fails too
+  bool broken_;
+};
+
+// flushes the file or directory at `path` to disk
+void SyncPath(const std::filesystem::path& path);
+
+}  // namespace deadfood::storage
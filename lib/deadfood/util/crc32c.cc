@@ -0,0 +1,32 @@
+#include "crc32c.hh"
+
+#include <array>
+
+namespace deadfood::util {
+
+constexpr uint32_t kCrc32cPolynomial = 0x82f63b78;  // reversed
+
+constexpr std::array<uint32_t, 256> MakeCrc32cTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t byte = 0; byte < table.size(); ++byte) {
+    uint32_t crc = byte;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? kCrc32cPolynomial : 0);
+    }
+    table[byte] = crc;
+  }
+  return table;
+}
+
+constexpr auto kCrc32cTable = MakeCrc32cTable();
+
+uint32_t Crc32c(const char* data, size_t size, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) {
+    crc = (crc >> 8) ^
+          kCrc32cTable[(crc ^ static_cast<unsigned char>(data[i])) & 0xff];
+  }
+  return ~crc;
+}
+
+}  // namespace deadfood::util
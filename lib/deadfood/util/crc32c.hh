@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace deadfood::util {
+
+// CRC-32C (Castagnoli) of `size` bytes, continuing from `crc` so that a
+// buffer can be checksummed in pieces.
+uint32_t Crc32c(const char* data, size_t size, uint32_t crc = 0);
+
+}  // namespace deadfood::util
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <ranges>
+#include <string>
+
 #include <deadfood/lex/lex.hh>
 #include <deadfood/parse/parser_error.hh>
 #include <deadfood/util/str.hh>
@@ -65,4 +71,26 @@ inline std::pair<std::optional<std::string>, std::string> GetFullFieldName(
   return {std::nullopt, name};
 }
 
+// the index of the field named `name` among `fields`; `t.a` and `a` name the
+// same field if one of them is not qualified, but an exact match comes first
+template <std::ranges::random_access_range R, typename Proj = std::identity>
+inline std::optional<size_t> FindFieldName(const R& fields,
+                                           const std::string& name,
+                                           Proj proj = {}) {
+  auto it = std::ranges::find(fields, name, proj);
+  if (it == std::ranges::end(fields)) {
+    const auto [table, field] = GetFullFieldName(name);
+    it = std::ranges::find_if(fields, [&](const auto& other) {
+      const auto [other_table, other_field] =
+          GetFullFieldName(std::invoke(proj, other));
+      return other_field == field &&
+             (!table.has_value() || !other_table.has_value());
+    });
+  }
+  if (it == std::ranges::end(fields)) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(it - std::ranges::begin(fields));
+}
+
 }  // namespace deadfood::parse::util
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace deadfood::util {
+
+// `what`, followed by what `errno` says went wrong
+inline std::runtime_error SystemError(const std::string& what) {
+  return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+}  // namespace deadfood::util
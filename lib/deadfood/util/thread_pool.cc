@@ -0,0 +1,131 @@
+#include "thread_pool.hh"
+
+#include <algorithm>
+#include <utility>
+
+namespace deadfood::util {
+
+ThreadPool::ThreadPool(size_t threads)
+    : queues_(std::max<size_t>(threads, 1)),
+      task_{nullptr},
+      generation_{0},
+      remaining_{0},
+      active_{0},
+      stop_{false} {
+  for (size_t worker = 0; worker < queues_.size(); ++worker) {
+    threads_.emplace_back([this, worker] { WorkerLoop(worker); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+ThreadPool& ThreadPool::Shared() {
+  static ThreadPool pool(std::thread::hardware_concurrency());
+  return pool;
+}
+
+size_t ThreadPool::size() const { return queues_.size(); }
+
+void ThreadPool::Run(size_t count,
+                     const std::function<void(size_t, size_t)>& task) {
+  if (count == 0) {
+    return;
+  }
+  std::lock_guard run_lock(run_mutex_);
+  std::unique_lock lock(mutex_);
+  // a worker of the previous batch may still be looking for work to steal
+  done_.wait(lock, [&] { return active_ == 0; });
+  const size_t workers = queues_.size();
+  for (size_t worker = 0; worker < workers; ++worker) {
+    std::lock_guard queue_lock(queues_[worker].mutex);
+    auto& tasks = queues_[worker].tasks;
+    for (size_t i = worker * count / workers;
+         i < (worker + 1) * count / workers; ++i) {
+      tasks.push_back(i);
+    }
+  }
+  task_ = &task;
+  remaining_ = count;
+  error_ = nullptr;
+  ++generation_;
+  wake_.notify_all();
+  done_.wait(lock, [&] { return remaining_ == 0; });
+  task_ = nullptr;
+  if (error_ != nullptr) {
+    std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+}
+
+void ThreadPool::WorkerLoop(size_t worker) {
+  size_t seen = 0;
+  while (true) {
+    const std::function<void(size_t, size_t)>* task = nullptr;
+    {
+      std::unique_lock lock(mutex_);
+      wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+      task = task_;
+      if (task == nullptr) {
+        continue;
+      }
+      ++active_;
+    }
+
+    size_t i = 0;
+    while (PopTask(worker, i)) {
+      std::exception_ptr error;
+      try {
+        (*task)(worker, i);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard lock(mutex_);
+      if (error != nullptr && error_ == nullptr) {
+        error_ = error;
+      }
+      --remaining_;
+    }
+
+    std::lock_guard lock(mutex_);
+    --active_;
+    if (remaining_ == 0 || active_ == 0) {
+      done_.notify_all();
+    }
+  }
+}
+
+bool ThreadPool::PopTask(size_t worker, size_t& task) {
+  {
+    auto& own = queues_[worker];
+    std::lock_guard lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = own.tasks.front();
+      own.tasks.pop_front();
+      return true;
+    }
+  }
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    auto& other = queues_[(worker + offset) % queues_.size()];
+    std::lock_guard lock(other.mutex);
+    if (!other.tasks.empty()) {
+      task = other.tasks.back();
+      other.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace deadfood::util
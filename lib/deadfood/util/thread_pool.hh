@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace deadfood::util {
+
+// A fixed set of worker threads running batches of indexed tasks. Every
+// worker owns a queue of task indices, dealt out as one contiguous block per
+// worker; a worker whose queue runs dry steals from the back of the others,
+// so uneven tasks still keep all of them busy.
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t threads);
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool();
+
+  // the pool shared by all queries, with a worker per hardware thread
+  static ThreadPool& Shared();
+
+  [[nodiscard]] size_t size() const;
+
+  // Runs `task(worker, i)` for every `i` below `count` and waits for all of
+  // them. `worker` is below `size()` and a worker runs one task at a time, so
+  // it can index per-worker state. The first exception a task throws is
+  // rethrown once all tasks are done. Must not be called from a task.
+  void Run(size_t count, const std::function<void(size_t, size_t)>& task);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  void WorkerLoop(size_t worker);
+  bool PopTask(size_t worker, size_t& task);
+
+  std::vector<Queue> queues_;
+  std::vector<std::thread> threads_;
+  // serializes `Run` calls
+  std::mutex run_mutex_;
+  // guards everything below
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(size_t, size_t)>* task_;
+  size_t generation_;
+  size_t remaining_;
+  // workers that may still be taking tasks of the current batch
+  size_t active_;
+  std::exception_ptr error_;
+  bool stop_;
+};
+
+}  // namespace deadfood::util
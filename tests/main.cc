@@ -1,34 +1,75 @@
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <fstream>
+#include <numeric>
+#include <thread>
+
 #include <deadfood/database.hh>
+#include <deadfood/binary/put.hh>
+#include <deadfood/storage/block_file.hh>
+#include <deadfood/storage/page_file.hh>
 
 #include <deadfood/lex/lex.hh>
 
 #include <deadfood/parse/create_table_parser.hh>
+#include <deadfood/parse/create_index_parser.hh>
 #include <deadfood/parse/drop_table_parser.hh>
+#include <deadfood/parse/drop_index_parser.hh>
+#include <deadfood/parse/analyze_parser.hh>
+#include <deadfood/parse/vacuum_parser.hh>
 #include <deadfood/parse/insert_parser.hh>
 #include <deadfood/parse/select_parser.hh>
 #include <deadfood/parse/update_parser.hh>
 #include <deadfood/parse/delete_parser.hh>
 
 #include <deadfood/exec/create_table.hh>
+#include <deadfood/exec/create_index.hh>
 #include <deadfood/exec/drop_table.hh>
+#include <deadfood/exec/drop_index.hh>
+#include <deadfood/exec/analyze.hh>
+#include <deadfood/exec/vacuum.hh>
 #include <deadfood/exec/insert_into.hh>
 #include <deadfood/exec/select.hh>
 #include <deadfood/exec/update.hh>
 #include <deadfood/exec/delete.hh>
+#include <deadfood/exec/dql_util.hh>
+
+#include <deadfood/scan/distinct_scan.hh>
+#include <deadfood/scan/hash_join_scan.hh>
+#include <deadfood/scan/limit_scan.hh>
+#include <deadfood/scan/parallel_scan.hh>
+#include <deadfood/scan/radix_join_scan.hh>
+#include <deadfood/scan/select_scan.hh>
+#include <deadfood/expr/expr_convert.hh>
+#include <deadfood/expr/scan_selector/simple_scan_selector.hh>
+#include <deadfood/util/thread_pool.hh>
 
 namespace deadfood::tests {
 
 std::optional<std::pair<std::unique_ptr<scan::IScan>, std::vector<std::string>>>
 ProcessQueryInternal(Database& db, const std::string& query) {
   auto tokens = lex::Lex(query);
-  if (IsKeyword(tokens[0], lex::Keyword::Create)) {  // create table query
+  if (IsKeyword(tokens[0], lex::Keyword::Create) && tokens.size() > 1 &&
+      IsKeyword(tokens[1], lex::Keyword::Index)) {  // create index query
+    const auto q = parse::ParseCreateIndexQuery(tokens);
+    exec::ExecuteCreateIndexQuery(db, q);
+  } else if (IsKeyword(tokens[0], lex::Keyword::Create)) {  // create table
     const auto q = parse::ParseCreateTableQuery(tokens);
     exec::ExecuteCreateTableQuery(db, q);
+  } else if (IsKeyword(tokens[0], lex::Keyword::Drop) && tokens.size() > 1 &&
+             IsKeyword(tokens[1], lex::Keyword::Index)) {  // drop index query
+    const auto q = parse::ParseDropIndexQuery(tokens);
+    exec::ExecuteDropIndexQuery(db, q);
   } else if (IsKeyword(tokens[0], lex::Keyword::Drop)) {  // drop table query
     const auto q = parse::ParseDropTableQuery(tokens);
     exec::ExecuteDropTableQuery(db, q);
+  } else if (IsKeyword(tokens[0], lex::Keyword::Analyze)) {  // analyze query
+    const auto q = parse::ParseAnalyzeQuery(tokens);
+    exec::ExecuteAnalyzeQuery(db, q);
+  } else if (IsKeyword(tokens[0], lex::Keyword::Vacuum)) {  // vacuum query
+    const auto q = parse::ParseVacuumQuery(tokens);
+    exec::ExecuteVacuumQuery(db, q);
   } else if (IsKeyword(tokens[0], lex::Keyword::Update)) {  // update query
     const auto q = parse::ParseUpdateQuery(tokens);
     exec::ExecuteUpdateQuery(db, q);
@@ -193,6 +234,57 @@ TEST(ForeignKeyInsertGood, db) {
   ProcessQueryInternal(db, "INSERT INTO test_tbl2 VALUES ('Egor', 5)");
 }
 
+TEST(BulkInsert, db) {
+  Database db;
+  ProcessQueryInternal(db,
+                       "CREATE TABLE m (id INT PRIMARY KEY, name VARCHAR(8))");
+  ProcessQueryInternal(db,
+                       "CREATE TABLE s (id INT PRIMARY KEY, m_id INT, "
+                       "v DOUBLE, FOREIGN KEY m_id REFERENCES m (id)) "
+                       "WITH (storage = column)");
+  std::string masters = "INSERT INTO m VALUES (0, 'n0')";
+  for (int k = 1; k < 100; ++k) {
+    masters += ", (" + std::to_string(k) + ", 'n" + std::to_string(k) + "')";
+  }
+  ProcessQueryInternal(db, masters);
+  std::string rows = "INSERT INTO s VALUES (0, 0, -1)";
+  for (int k = 1; k < 5000; ++k) {
+    rows += ", (" + std::to_string(k) + ", " + std::to_string(k % 100) +
+            ", -" + std::to_string(k) + ")";
+  }
+  ProcessQueryInternal(db, rows);
+  ASSERT_EQ(db.table_storage("s").size(), 5000);
+
+  const auto count = [&](const std::string& query) {
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    EXPECT_TRUE(scan->Next());
+    return scan->GetField(fields[0]);
+  };
+  ASSERT_EQ(count("SELECT count(*) AS c FROM s WHERE s.m_id = 7"),
+            core::FieldVariant{50});
+  ASSERT_EQ(count("SELECT v FROM s WHERE s.id = 4321"),
+            core::FieldVariant{-4321.0});
+  // literals and computed values mix
+  ProcessQueryInternal(db, "INSERT INTO s VALUES (-1, 2 + 3, 2 * -4)");
+  ASSERT_EQ(count("SELECT v FROM s WHERE s.id = -1"),
+            core::FieldVariant{-8.0});
+
+  // a violation anywhere rejects the whole statement
+  ASSERT_THROW(ProcessQueryInternal(
+                   db, "INSERT INTO s VALUES (6000, 1, 0), (6000, 2, 0)"),
+               std::runtime_error);
+  ASSERT_THROW(ProcessQueryInternal(
+                   db, "INSERT INTO s VALUES (6000, 1, 0), (4999, 2, 0)"),
+               std::runtime_error);
+  ASSERT_THROW(ProcessQueryInternal(
+                   db, "INSERT INTO s VALUES (6000, 1, 0), (6001, 100, 0)"),
+               std::runtime_error);
+  ASSERT_EQ(db.table_storage("s").size(), 5001);
+  ASSERT_EQ(db.table_storage("s").hash_index("id")->Count(6000), 0);
+}
+
 TEST(ForeignKeyUpdateGood, db) {
   Database db;
   ProcessQueryInternal(db,
@@ -590,4 +682,1695 @@ TEST(ComplexExpr, db) {
   ASSERT_FALSE(scan->Next());
 }
 
+TEST(DeleteThenInsert, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE test_tbl (a INT, b VARCHAR(10))");
+  ProcessQueryInternal(
+      db, "INSERT INTO test_tbl VALUES (1, 'abcdefghij'), (2, 'klmnopqrst')");
+  ProcessQueryInternal(db, "DELETE FROM test_tbl WHERE a = 1");
+  ProcessQueryInternal(db, "INSERT INTO test_tbl VALUES (3, 'xy')");
+  auto result = ProcessQueryInternal(db, "SELECT a, b FROM test_tbl");
+  ASSERT_TRUE(result.has_value());
+  auto& [scan, fields] = result.value();
+  size_t count = 0;
+  while (scan->Next()) {
+    ++count;
+    if (scan->GetField("a") == core::FieldVariant(3)) {
+      ASSERT_EQ(scan->GetField("b"), core::FieldVariant(std::string("xy")));
+    } else {
+      ASSERT_EQ(scan->GetField("a"), core::FieldVariant(2));
+    }
+  }
+  ASSERT_EQ(count, 2);
+}
+
+TEST(UpdateNullToValue, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE test_tbl (a INT, b INT)");
+  ProcessQueryInternal(db, "INSERT INTO test_tbl VALUES (1, NULL)");
+  ProcessQueryInternal(db, "UPDATE test_tbl SET b = 5");
+  auto result = ProcessQueryInternal(db, "SELECT a, b FROM test_tbl");
+  ASSERT_TRUE(result.has_value());
+  auto& [scan, fields] = result.value();
+  ASSERT_TRUE(scan->Next());
+  ASSERT_EQ(scan->GetField("b"), core::FieldVariant(5));
+  ASSERT_FALSE(scan->Next());
+}
+
+TEST(UpdateInPlace, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE m (id INT UNIQUE, name VARCHAR(8))");
+  ProcessQueryInternal(db,
+                       "CREATE TABLE s (id INT PRIMARY KEY, m_id INT, "
+                       "FOREIGN KEY m_id REFERENCES m (id))");
+  for (int k = 0; k < 100; ++k) {
+    ProcessQueryInternal(db, "INSERT INTO m VALUES (" + std::to_string(k) +
+                                 ", 'n')");
+  }
+  ProcessQueryInternal(db, "INSERT INTO s VALUES (1, 10), (2, 20)");
+  const auto column = [&](const std::string& query) {
+    std::vector<core::FieldVariant> ret;
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    while (scan->Next()) {
+      ret.push_back(scan->GetField(fields[0]));
+    }
+    return ret;
+  };
+
+  // uniqueness holds for the rows as they end up, not as they were
+  ProcessQueryInternal(db, "UPDATE m SET id = id WHERE id < 5");
+  ProcessQueryInternal(db, "UPDATE m SET id = id + 100 WHERE id > 50");
+  ASSERT_EQ(column("SELECT id FROM m WHERE m.id > 140").size(), 49);
+  ASSERT_THROW(ProcessQueryInternal(db, "UPDATE m SET id = 1000 WHERE id > 90"),
+               std::runtime_error);
+  ASSERT_THROW(
+      ProcessQueryInternal(db, "UPDATE m SET id = id + 1 WHERE id = 3"),
+      std::runtime_error);
+  ASSERT_EQ(column("SELECT id FROM m WHERE m.id = 1000").size(), 0);
+  ASSERT_EQ(column("SELECT id FROM m WHERE m.id = 3").size(), 1);
+
+  // referenced values cannot go away, referencing ones must exist
+  ASSERT_THROW(ProcessQueryInternal(db, "UPDATE m SET id = 500 WHERE id = 10"),
+               std::runtime_error);
+  ProcessQueryInternal(db, "UPDATE m SET name = 'x' WHERE id = 10");
+  ProcessQueryInternal(db, "UPDATE s SET m_id = 30 WHERE id = 1");
+  ASSERT_THROW(ProcessQueryInternal(db, "UPDATE s SET m_id = 77 WHERE id = 1"),
+               std::runtime_error);
+  ASSERT_EQ(column("SELECT m_id FROM s"),
+            std::vector<core::FieldVariant>({30, 20}));
+  ProcessQueryInternal(db, "UPDATE m SET id = 500 WHERE id = 10");
+  ASSERT_EQ(column("SELECT name FROM m WHERE m.id = 500"),
+            std::vector<core::FieldVariant>({"x"}));
+}
+
+TEST(Vacuum, db) {
+  for (const std::string layout : {"row", "column"}) {
+    Database db;
+    ProcessQueryInternal(db, "CREATE TABLE t (i INT PRIMARY KEY, "
+                             "s VARCHAR(8)) WITH (storage = " +
+                                 layout + ")");
+    ProcessQueryInternal(db,
+                         "CREATE TABLE r (i INT, FOREIGN KEY i REFERENCES t "
+                         "(i))");
+    std::string rows = "INSERT INTO t VALUES (0, NULL)";
+    for (int k = 1; k < 3000; ++k) {
+      rows += ", (" + std::to_string(k) + ", " +
+              (k % 3 == 0 ? "NULL" : "'v" + std::to_string(k) + "'") + ")";
+    }
+    ProcessQueryInternal(db, rows);
+    ProcessQueryInternal(db, "INSERT INTO r VALUES (2500)");
+    auto& storage = db.table_storage("t");
+    const auto column = [&](const std::string& query) {
+      std::vector<core::FieldVariant> ret;
+      auto result = ProcessQueryInternal(db, query);
+      EXPECT_TRUE(result.has_value());
+      auto& [scan, fields] = result.value();
+      while (scan->Next()) {
+        ret.push_back(scan->GetField(fields[0]));
+      }
+      return ret;
+    };
+
+    // a few deleted rows stay as tombstones until VACUUM
+    ProcessQueryInternal(db, "DELETE FROM t WHERE i < 10");
+    ASSERT_EQ(storage.slot_count(), 3000);
+    ASSERT_EQ(storage.dead_count(), 10);
+    ASSERT_EQ(column("SELECT i FROM t").size(), 2990);
+    ProcessQueryInternal(db, "VACUUM t");
+    ASSERT_EQ(storage.slot_count(), 2990);
+    ASSERT_EQ(storage.dead_count(), 0);
+
+    // a referenced row keeps the whole statement from deleting anything
+    ASSERT_THROW(ProcessQueryInternal(db, "DELETE FROM t WHERE i > 2000"),
+                 std::runtime_error);
+    ASSERT_EQ(storage.size(), 2990);
+
+    // once most of the table is dead it is compacted right away
+    ProcessQueryInternal(db, "DELETE FROM t WHERE i < 2000");
+    ASSERT_EQ(storage.slot_count(), 1000);
+    ASSERT_EQ(column("SELECT i FROM t WHERE t.i < 2003"),
+              std::vector<core::FieldVariant>({2000, 2001, 2002}));
+    ASSERT_EQ(column("SELECT s FROM t WHERE t.i = 2997"),
+              std::vector<core::FieldVariant>({core::null_t{}}));
+    ASSERT_EQ(column("SELECT s FROM t WHERE t.i = 2998"),
+              std::vector<core::FieldVariant>({"v2998"}));
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (7, NULL)");
+    ASSERT_EQ(column("SELECT s FROM t WHERE t.i = 7"),
+              std::vector<core::FieldVariant>({core::null_t{}}));
+    ASSERT_EQ(column("SELECT i FROM t").back(), core::FieldVariant{7});
+    ProcessQueryInternal(db, "VACUUM");
+    ASSERT_THROW(ProcessQueryInternal(db, "VACUUM nope"), std::runtime_error);
+  }
+}
+
+TEST(IndexedLookup, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE test_tbl (a INT UNIQUE, b INT)");
+  for (int i = 0; i < 100; ++i) {
+    ProcessQueryInternal(db, "INSERT INTO test_tbl VALUES (" +
+                                 std::to_string(i) + ", " +
+                                 std::to_string(i * 2) + ")");
+  }
+  ProcessQueryInternal(db, "UPDATE test_tbl SET a = 200 WHERE a = 42");
+  ProcessQueryInternal(db, "DELETE FROM test_tbl WHERE a = 7");
+  ASSERT_THROW(
+      ProcessQueryInternal(db, "UPDATE test_tbl SET a = 200 WHERE a = 1"),
+      std::runtime_error);
+  ASSERT_THROW(ProcessQueryInternal(db, "INSERT INTO test_tbl VALUES (8, 0)"),
+               std::runtime_error);
+  ProcessQueryInternal(db, "INSERT INTO test_tbl VALUES (42, 1)");
+
+  auto result = ProcessQueryInternal(
+      db, "SELECT t.b FROM test_tbl AS t WHERE t.a = 200 AND t.b > 0");
+  ASSERT_TRUE(result.has_value());
+  {
+    auto& [scan, fields] = result.value();
+    ASSERT_TRUE(scan->Next());
+    ASSERT_EQ(scan->GetField("t.b"), core::FieldVariant(84));
+    ASSERT_FALSE(scan->Next());
+  }
+
+  result = ProcessQueryInternal(db, "SELECT b FROM test_tbl WHERE 42.0 = test_tbl.a");
+  ASSERT_TRUE(result.has_value());
+  {
+    auto& [scan, fields] = result.value();
+    ASSERT_TRUE(scan->Next());
+    ASSERT_EQ(scan->GetField("b"), core::FieldVariant(1));
+    ASSERT_FALSE(scan->Next());
+  }
+
+  result = ProcessQueryInternal(db, "SELECT a, b FROM test_tbl WHERE a = 7");
+  ASSERT_TRUE(result.has_value());
+  ASSERT_FALSE(result.value().first->Next());
+}
+
+size_t CountRows(scan::IScan& scan) {
+  size_t count = 0;
+  while (scan.Next()) {
+    ++count;
+  }
+  return count;
+}
+
+TEST(OrderedIndexRange, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE test_tbl (a INT, b INT)");
+  ProcessQueryInternal(db, "CREATE INDEX test_idx ON test_tbl (a)");
+  for (int i = 0; i < 500; ++i) {
+    ProcessQueryInternal(db, "INSERT INTO test_tbl VALUES (" +
+                                 std::to_string(i % 250) + ", " +
+                                 std::to_string(i) + ")");
+  }
+  ProcessQueryInternal(db, "DELETE FROM test_tbl WHERE a < 10");
+  ProcessQueryInternal(db, "UPDATE test_tbl SET a = 1000 WHERE a = 100");
+
+  auto result = ProcessQueryInternal(
+      db, "SELECT a, b FROM test_tbl WHERE a >= 240 AND 245 > a");
+  ASSERT_TRUE(result.has_value());
+  {
+    auto& [scan, fields] = result.value();
+    size_t count = 0;
+    while (scan->Next()) {
+      const int a = std::get<int>(scan->GetField("a"));
+      ASSERT_TRUE(240 <= a && a < 245);
+      ++count;
+    }
+    ASSERT_EQ(count, 10);
+  }
+
+  result = ProcessQueryInternal(db, "SELECT a, b FROM test_tbl WHERE a > 998");
+  ASSERT_TRUE(result.has_value());
+  ASSERT_EQ(CountRows(*result.value().first), 2);
+
+  result = ProcessQueryInternal(
+      db, "SELECT a, b FROM test_tbl WHERE a <= 11.5 AND b > 300");
+  ASSERT_TRUE(result.has_value());
+  ASSERT_EQ(CountRows(*result.value().first), 0);
+
+  result = ProcessQueryInternal(db, "SELECT a, b FROM test_tbl WHERE a <= 11");
+  ASSERT_TRUE(result.has_value());
+  ASSERT_EQ(CountRows(*result.value().first), 4);
+}
+
+TEST(IndexedNullKeys, db) {
+  // an index changes neither the rows of a query nor whether it fails
+  using Row = std::vector<core::FieldVariant>;
+  const auto rows = [](Database& db, const std::string& where)
+      -> std::optional<std::vector<Row>> {
+    try {
+      auto result =
+          ProcessQueryInternal(db, "SELECT id, x FROM a WHERE " + where);
+      auto& [scan, fields] = result.value();
+      std::vector<Row> ret;
+      while (scan->Next()) {
+        ret.push_back({scan->GetField("id"), scan->GetField("x")});
+      }
+      return ret;
+    } catch (const std::runtime_error&) {
+      return std::nullopt;
+    }
+  };
+  const auto index_scan = [](Database& db, const std::string& where) {
+    const auto query =
+        parse::ParseSelectQuery(lex::Lex("SELECT id, x FROM a WHERE " + where));
+    return exec::util::GetIndexScan(db, "a", "a", query.predicate.value());
+  };
+
+  Database plain;
+  Database ordered;
+  Database hashed;
+  ProcessQueryInternal(plain, "CREATE TABLE a (id INT, x INT)");
+  ProcessQueryInternal(ordered, "CREATE TABLE a (id INT, x INT)");
+  ProcessQueryInternal(ordered, "CREATE INDEX ix ON a (x)");
+  ProcessQueryInternal(hashed, "CREATE TABLE a (id INT, x INT UNIQUE)");
+  for (auto* db : {&plain, &ordered, &hashed}) {
+    ProcessQueryInternal(
+        *db, "INSERT INTO a VALUES (1, 10), (2, 20), (3, NULL), (4, 40)");
+  }
+
+  const std::vector<std::string> predicates{
+      "x > 15",  "x >= 15", "x < 25", "x = 20",
+      "20 = x",  "15 < x",  "x > 15 AND x < 30"};
+  // comparing a number with NULL fails, so the NULL key keeps the indices out
+  ASSERT_FALSE(rows(plain, "x > 15").has_value());
+  ASSERT_EQ(index_scan(ordered, "x > 15"), nullptr);
+  ASSERT_EQ(index_scan(hashed, "x = 20"), nullptr);
+  for (const auto& where : predicates) {
+    const auto expected = rows(plain, where);
+    ASSERT_EQ(rows(ordered, where), expected) << where;
+    ASSERT_EQ(rows(hashed, where), expected) << where;
+  }
+
+  for (auto* db : {&plain, &ordered, &hashed}) {
+    ProcessQueryInternal(*db, "DELETE FROM a WHERE id = 3");
+  }
+  ASSERT_NE(index_scan(ordered, "x > 15"), nullptr);
+  ASSERT_NE(index_scan(hashed, "x = 20"), nullptr);
+  for (const auto& where : predicates) {
+    const auto expected = rows(plain, where);
+    ASSERT_TRUE(expected.has_value()) << where;
+    ASSERT_EQ(rows(ordered, where), expected) << where;
+    ASSERT_EQ(rows(hashed, where), expected) << where;
+  }
+
+  // a string compared with a number fails as well, whichever side is indexed
+  for (const std::string where : {"x = 'abc'", "'abc' < x"}) {
+    ASSERT_EQ(index_scan(ordered, where), nullptr) << where;
+    ASSERT_EQ(index_scan(hashed, where), nullptr) << where;
+    ASSERT_FALSE(rows(plain, where).has_value()) << where;
+    ASSERT_FALSE(rows(ordered, where).has_value()) << where;
+    ASSERT_FALSE(rows(hashed, where).has_value()) << where;
+  }
+  ProcessQueryInternal(ordered, "CREATE TABLE b (s VARCHAR(4))");
+  ProcessQueryInternal(ordered, "CREATE INDEX iy ON b (s)");
+  ProcessQueryInternal(ordered, "INSERT INTO b VALUES ('one')");
+  const auto count = [&](const std::string& where) {
+    auto result =
+        ProcessQueryInternal(ordered, "SELECT s FROM b WHERE " + where);
+    return CountRows(*result.value().first);
+  };
+  ASSERT_EQ(count("s = 'one'"), 1);
+  ASSERT_THROW(count("s = 1"), std::runtime_error);
+}
+
+TEST(OrderedIndexDumpLoadDrop, db) {
+  const auto path =
+      std::filesystem::temp_directory_path() / "deadfood_index_dump";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  {
+    Database db;
+    ProcessQueryInternal(db, "CREATE TABLE test_tbl (a INT, b VARCHAR(10))");
+    ProcessQueryInternal(db, "CREATE INDEX test_idx ON test_tbl (b)");
+    ASSERT_THROW(
+        ProcessQueryInternal(db, "CREATE INDEX test_idx ON test_tbl (a)"),
+        std::runtime_error);
+    ASSERT_THROW(ProcessQueryInternal(db, "CREATE INDEX idx ON test_tbl (c)"),
+                 std::runtime_error);
+    ProcessQueryInternal(
+        db, "INSERT INTO test_tbl VALUES (1, 'one'), (2, 'two'), (3, 'one')");
+    Dump(db, path);
+  }
+  Database db = Load(path);
+  ASSERT_TRUE(db.indices().contains("test_idx"));
+  auto result =
+      ProcessQueryInternal(db, "SELECT a, b FROM test_tbl WHERE b = 'one'");
+  ASSERT_TRUE(result.has_value());
+  ASSERT_EQ(CountRows(*result.value().first), 2);
+
+  ProcessQueryInternal(db, "DROP INDEX test_idx");
+  ASSERT_THROW(ProcessQueryInternal(db, "DROP INDEX test_idx"),
+               std::runtime_error);
+  ProcessQueryInternal(db, "CREATE INDEX test_idx ON test_tbl (a)");
+  ProcessQueryInternal(db, "DROP TABLE test_tbl");
+  ASSERT_TRUE(db.indices().empty());
+  std::filesystem::remove_all(path);
+}
+
+TEST(HashJoin, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE t1 (id INT, v INT)");
+  ProcessQueryInternal(db, "CREATE TABLE t2 (ref INT, w INT)");
+  for (int i = 0; i < 50; ++i) {
+    ProcessQueryInternal(db, "INSERT INTO t1 VALUES (" + std::to_string(i) +
+                                 ", " + std::to_string(i) + ")");
+  }
+  for (int i = 0; i < 100; ++i) {
+    ProcessQueryInternal(db, "INSERT INTO t2 VALUES (" +
+                                 std::to_string(i % 60) + ", " +
+                                 std::to_string(i) + ")");
+  }
+
+  auto result = ProcessQueryInternal(
+      db, "SELECT t1.id, u.w FROM t1 JOIN t2 u ON u.ref = t1.id");
+  ASSERT_TRUE(result.has_value());
+  {
+    auto& [scan, fields] = result.value();
+    size_t count = 0;
+    while (scan->Next()) {
+      ASSERT_EQ(std::get<int>(scan->GetField("u.w")) % 60,
+                std::get<int>(scan->GetField("t1.id")));
+      ++count;
+    }
+    ASSERT_EQ(count, 90);
+  }
+
+  result = ProcessQueryInternal(db,
+                                "SELECT t1.id, u.w FROM t1 LEFT JOIN t2 u ON "
+                                "u.ref = t1.id AND u.w > 50");
+  ASSERT_TRUE(result.has_value());
+  {
+    auto& [scan, fields] = result.value();
+    size_t count = 0;
+    size_t null_count = 0;
+    while (scan->Next()) {
+      if (std::holds_alternative<core::null_t>(scan->GetField("u.w"))) {
+        ASSERT_GE(std::get<int>(scan->GetField("t1.id")), 40);
+        ++null_count;
+      }
+      ++count;
+    }
+    ASSERT_EQ(count, 50);
+    ASSERT_EQ(null_count, 10);
+  }
+
+  result = ProcessQueryInternal(
+      db, "SELECT t1.id, u.ref FROM t1 RIGHT JOIN t2 u ON t1.id = u.ref");
+  ASSERT_TRUE(result.has_value());
+  {
+    auto& [scan, fields] = result.value();
+    size_t count = 0;
+    size_t null_count = 0;
+    while (scan->Next()) {
+      if (std::holds_alternative<core::null_t>(scan->GetField("t1.id"))) {
+        ASSERT_GE(std::get<int>(scan->GetField("u.ref")), 50);
+        ++null_count;
+      }
+      ++count;
+    }
+    ASSERT_EQ(count, 100);
+    ASSERT_EQ(null_count, 10);
+  }
+
+  // a number is not hashed against a string: the nested loop reports the
+  // comparison as an error
+  ProcessQueryInternal(db, "CREATE TABLE t3 (s VARCHAR(4))");
+  ProcessQueryInternal(db, "INSERT INTO t3 VALUES ('one')");
+  for (const std::string query :
+       {"SELECT t1.id, u.s FROM t1 JOIN t3 u ON t1.id = u.s",
+        "SELECT t1.id, u.s FROM t1 LEFT JOIN t3 u ON u.s = t1.id",
+        "SELECT t1.id, t3.s FROM t1, t3 WHERE t1.id = t3.s"}) {
+    ASSERT_THROW(
+        {
+          auto mismatched = ProcessQueryInternal(db, query);
+          CountRows(*mismatched.value().first);
+        },
+        std::runtime_error)
+        << query;
+  }
+}
+
+TEST(DumpLoad, db) {
+  const auto path = std::filesystem::temp_directory_path() / "deadfood_dump";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  {
+    Database db;
+    ProcessQueryInternal(db, "CREATE TABLE test_tbl (a INT, b VARCHAR(10))");
+    ProcessQueryInternal(
+        db, "INSERT INTO test_tbl VALUES (1, 'one'), (2, 'two'), (3, NULL)");
+    ProcessQueryInternal(db, "DELETE FROM test_tbl WHERE a = 2");
+    Dump(db, path);
+  }
+  Database db = Load(path);
+  auto result = ProcessQueryInternal(db, "SELECT a, b FROM test_tbl");
+  ASSERT_TRUE(result.has_value());
+  auto& [scan, fields] = result.value();
+  ASSERT_TRUE(scan->Next());
+  ASSERT_EQ(scan->GetField("a"), core::FieldVariant(1));
+  ASSERT_EQ(scan->GetField("b"), core::FieldVariant(std::string("one")));
+  ASSERT_TRUE(scan->Next());
+  ASSERT_EQ(scan->GetField("a"), core::FieldVariant(3));
+  ASSERT_EQ(scan->GetField("b"), core::FieldVariant(core::null_t{}));
+  ASSERT_FALSE(scan->Next());
+  std::filesystem::remove_all(path);
+}
+
+TEST(WriteAheadLog, db) {
+  const auto path = std::filesystem::temp_directory_path() / "deadfood_wal";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  const auto values = [](Database& db, const std::string& query) {
+    std::vector<core::FieldVariant> ret;
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    while (scan->Next()) {
+      for (const auto& field : fields) {
+        ret.push_back(scan->GetField(field));
+      }
+    }
+    return ret;
+  };
+  const std::vector<core::FieldVariant> expected{1, "one", 3, core::null_t{},
+                                                 4, "four"};
+  {
+    // nothing is dumped: the changes only reach the log
+    Database db = Load(path);
+    ProcessQueryInternal(db, "CREATE TABLE m (a INT UNIQUE, b VARCHAR(8))");
+    ProcessQueryInternal(db,
+                         "CREATE TABLE s (a INT, FOREIGN KEY a REFERENCES m "
+                         "(a)) WITH (storage = column)");
+    ProcessQueryInternal(db, "CREATE TABLE gone (a INT)");
+    ProcessQueryInternal(
+        db, "INSERT INTO m VALUES (1, 'one'), (2, 'two'), (3, 'three')");
+    ProcessQueryInternal(db, "INSERT INTO s VALUES (1), (3)");
+    ProcessQueryInternal(db, "DELETE FROM m WHERE a = 2");
+    ProcessQueryInternal(db, "UPDATE m SET b = NULL WHERE a = 3");
+    ProcessQueryInternal(db, "INSERT INTO m VALUES (4, 'four')");
+    ProcessQueryInternal(db, "CREATE INDEX m_b ON m (b)");
+    ProcessQueryInternal(db, "DROP TABLE gone");
+    // a failed statement logs nothing
+    ASSERT_THROW(ProcessQueryInternal(db, "INSERT INTO s VALUES (2)"),
+                 std::runtime_error);
+  }
+  {
+    // a frame torn by a crash is dropped
+    std::ofstream wal(path / ".wal", std::ios::binary | std::ios::app);
+    wal << "torn";
+  }
+  for (int pass = 0; pass < 2; ++pass) {
+    Database db = Load(path);
+    ASSERT_EQ(values(db, "SELECT a, b FROM m"), expected);
+    ASSERT_EQ(values(db, "SELECT a FROM s"),
+              std::vector<core::FieldVariant>({1, 3}));
+    ASSERT_FALSE(db.Exists("gone"));
+    ASSERT_TRUE(db.indices().contains("m_b"));
+    ASSERT_EQ(db.table_storage("s").layout(), storage::Layout::Column);
+    ASSERT_THROW(ProcessQueryInternal(db, "INSERT INTO m VALUES (1, 'x')"),
+                 std::runtime_error);
+    ASSERT_THROW(ProcessQueryInternal(db, "DELETE FROM m WHERE a = 3"),
+                 std::runtime_error);
+    if (pass == 0) {
+      // a checkpoint empties the log
+      Dump(db, path);
+      ASSERT_EQ(std::filesystem::file_size(path / ".wal"), 0);
+    }
+  }
+
+  // commits from several threads all reach the log, in whole frames
+  {
+    storage::WriteAheadLog wal(path / "group.wal");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&wal, t] {
+        for (int i = 0; i < 50; ++i) {
+          wal.Append(std::string(static_cast<size_t>(t + 1), 'a'));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  const auto frames = storage::WriteAheadLog::Recover(path / "group.wal");
+  ASSERT_EQ(frames.size(), 200);
+  ASSERT_TRUE(std::ranges::all_of(frames, [](const std::string& frame) {
+    return !frame.empty() && frame.size() <= 4 &&
+           frame == std::string(frame.size(), 'a');
+  }));
+
+  // a change the log cannot take must not reach a snapshot either: the
+  // database refuses later writes and checkpoints
+  if (std::filesystem::exists("/dev/full")) {
+    Database db = Load(path);
+    db.set_wal(std::make_unique<storage::WriteAheadLog>("/dev/full"));
+    ASSERT_THROW(ProcessQueryInternal(db, "INSERT INTO m VALUES (5, 'five')"),
+                 std::runtime_error);
+    ASSERT_TRUE(db.failed());
+    ASSERT_THROW(ProcessQueryInternal(db, "CREATE TABLE t (a INT)"),
+                 std::runtime_error);
+    ASSERT_FALSE(db.Exists("t"));
+    ASSERT_THROW(Dump(db, path), std::runtime_error);
+    ASSERT_EQ(values(db, "SELECT a FROM s"),
+              std::vector<core::FieldVariant>({1, 3}));
+  }
+  {
+    Database db = Load(path);
+    ASSERT_EQ(values(db, "SELECT a, b FROM m"), expected);
+  }
+  std::filesystem::remove_all(path);
+}
+
+TEST(IncrementalCheckpoint, db) {
+  const auto path =
+      std::filesystem::temp_directory_path() / "deadfood_checkpoint";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  const auto data_files = [&] {
+    std::set<std::string> ret;
+    for (const auto& entry : std::filesystem::directory_iterator(path)) {
+      if (entry.path().extension() == ".dat") {
+        ret.insert(entry.path().filename().string());
+      }
+    }
+    return ret;
+  };
+  const auto values = [](Database& db, const std::string& query) {
+    std::vector<core::FieldVariant> ret;
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    while (scan->Next()) {
+      ret.push_back(scan->GetField(fields[0]));
+    }
+    return ret;
+  };
+  // 70000 rows make two segments
+  std::string rows = "INSERT INTO big VALUES (0, 0)";
+  for (int i = 1; i < 70000; ++i) {
+    rows += ", (" + std::to_string(i) + ", 0)";
+  }
+  {
+    Database db = Load(path);
+    ProcessQueryInternal(db, "CREATE TABLE big (i INT, v INT)");
+    ProcessQueryInternal(db,
+                         "CREATE TABLE small (i INT) WITH (storage = column)");
+    ProcessQueryInternal(db, rows);
+    ProcessQueryInternal(db, "INSERT INTO small VALUES (1), (2)");
+    Dump(db, path);
+    ASSERT_EQ(data_files(), std::set<std::string>({"big.0.1.dat",
+                                                   "big.1.1.dat",
+                                                   "small.0.1.dat"}));
+    // only the segment holding the changed row is written again
+    ProcessQueryInternal(db, "UPDATE big SET v = 7 WHERE big.i = 69000");
+    Dump(db, path);
+    ASSERT_EQ(data_files(), std::set<std::string>({"big.0.1.dat",
+                                                   "big.1.2.dat",
+                                                   "small.0.1.dat"}));
+    ProcessQueryInternal(db, "DELETE FROM small WHERE i = 1");
+  }
+  {
+    // the delete comes from the log; the dead slot it leaves is kept by the
+    // checkpoint, so that the segments line up again after loading
+    Database db = Load(path);
+    ASSERT_EQ(db.table_storage("small").dead_count(), 1);
+    Dump(db, path);
+    ASSERT_EQ(data_files(), std::set<std::string>({"big.0.1.dat",
+                                                   "big.1.2.dat",
+                                                   "small.0.3.dat"}));
+  }
+  {
+    Database db = Load(path);
+    ASSERT_EQ(db.table_storage("small").dead_count(), 1);
+    Dump(db, path);
+    ASSERT_EQ(data_files(), std::set<std::string>({"big.0.1.dat",
+                                                   "big.1.2.dat",
+                                                   "small.0.3.dat"}));
+    // compacting moves every row
+    ProcessQueryInternal(db, "DELETE FROM big WHERE big.i < 10");
+    ProcessQueryInternal(db, "VACUUM big");
+    Dump(db, path);
+    ASSERT_EQ(data_files(), std::set<std::string>({"big.0.5.dat",
+                                                   "big.1.5.dat",
+                                                   "small.0.3.dat"}));
+  }
+  Database db = Load(path);
+  ASSERT_EQ(values(db, "SELECT v FROM big WHERE big.i = 69000"),
+            std::vector<core::FieldVariant>({7}));
+  ASSERT_EQ(values(db, "SELECT i FROM big").size(), 69990);
+  ASSERT_EQ(values(db, "SELECT i FROM small"),
+            std::vector<core::FieldVariant>({2}));
+  std::filesystem::remove_all(path);
+}
+
+TEST(LoadBeforeManifests, db) {
+  const auto path = std::filesystem::temp_directory_path() / "deadfood_v1";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  {
+    // a snapshot as dumps wrote them before manifests: unversioned catalog
+    // files and one file of live rows per table
+    Database db;
+    ProcessQueryInternal(db, "CREATE TABLE t (a INT, b VARCHAR(4))");
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (1, 'x'), (2, NULL)");
+    const auto& schema = db.schemas().at("t");
+    std::ofstream schema_stream(path / ".schema", std::ios::binary);
+    binary::PutCString(schema_stream, "t");
+    binary::PutUint<uint32_t>(schema_stream, 2);
+    for (const std::string field : {"a", "b"}) {
+      binary::PutCString(schema_stream, field);
+      binary::PutUint<uint8_t>(schema_stream, 1);
+      binary::PutUint<uint8_t>(schema_stream, 0);
+      binary::PutUint<uint8_t>(
+          schema_stream,
+          static_cast<uint8_t>(schema.field_info(field).type()));
+      binary::PutUint<uint32_t>(
+          schema_stream,
+          static_cast<uint32_t>(schema.field_info(field).size()));
+    }
+    const auto& storage = db.table_storage("t");
+    std::vector<char> row(storage.row_size());
+    std::ofstream table_stream(path / "t.dat", std::ios::binary);
+    for (size_t slot = 0; slot < storage.slot_count(); ++slot) {
+      storage.ReadRow(slot, row.data());
+      binary::PutUint<size_t>(table_stream, storage.RowIdAt(slot));
+      binary::PutBytes(table_stream, row.data(), row.size());
+    }
+  }
+  for (int pass = 0; pass < 2; ++pass) {
+    Database db = Load(path);
+    auto result = ProcessQueryInternal(db, "SELECT a, b FROM t");
+    ASSERT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    ASSERT_TRUE(scan->Next());
+    ASSERT_EQ(scan->GetField("b"), core::FieldVariant("x"));
+    ASSERT_TRUE(scan->Next());
+    ASSERT_EQ(scan->GetField("b"), core::FieldVariant(core::null_t{}));
+    ASSERT_FALSE(scan->Next());
+    // the first checkpoint moves the snapshot to the new files
+    Dump(db, path);
+    ASSERT_FALSE(std::filesystem::exists(path / "t.dat"));
+    ASSERT_FALSE(std::filesystem::exists(path / ".schema"));
+  }
+  std::filesystem::remove_all(path);
+}
+
+TEST(SnapshotFormat, db) {
+  const auto path = std::filesystem::temp_directory_path() / "deadfood_v2";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+
+  // records are never split, so 1000-byte ones leave some room in a block
+  {
+    storage::BlockWriter writer(path / "blocks");
+    for (uint32_t i = 0; i < 3000; ++i) {
+      writer.PutUint(i);
+      std::fill_n(writer.Append(1000), 1000, static_cast<char>(i));
+    }
+    writer.Finish();
+  }
+  ASSERT_GT(std::filesystem::file_size(path / "blocks"),
+            2 * storage::BlockWriter::kBlockSize);
+  {
+    storage::BlockReader reader(path / "blocks");
+    for (uint32_t i = 0; i < 3000; ++i) {
+      ASSERT_EQ(reader.GetUint<uint32_t>(), i);
+      const char* record = reader.Read(1000);
+      ASSERT_TRUE(std::all_of(record, record + 1000, [&](char ch) {
+        return ch == static_cast<char>(i);
+      }));
+    }
+    ASSERT_TRUE(reader.AtEnd());
+  }
+
+  {
+    Database db;
+    ProcessQueryInternal(db, "CREATE TABLE t (a INT, b VARCHAR(4))");
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (1, 'x'), (2, NULL)");
+    Dump(db, path);
+  }
+  ASSERT_TRUE(storage::BlockReader::HasHeader(path / "t.0.1.dat"));
+  ASSERT_TRUE(storage::BlockReader::HasHeader(path / ".schema.1"));
+  ASSERT_EQ(Load(path).table_storage("t").size(), 2);
+  {
+    // a flipped bit in a row is caught by the checksum of its block
+    std::fstream file(path / "t.0.1.dat",
+                      std::ios::binary | std::ios::in | std::ios::out);
+    file.seekg(-1, std::ios::end);
+    const char last = static_cast<char>(file.get());
+    file.seekp(-1, std::ios::end);
+    file.put(static_cast<char>(last ^ 1));
+  }
+  ASSERT_THROW(Load(path), std::runtime_error);
+  {
+    // so is a file of a later version
+    std::fstream file(path / "t.0.1.dat",
+                      std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(8);
+    binary::PutUint<uint32_t>(file, storage::kSnapshotVersion + 1);
+  }
+  ASSERT_THROW(Load(path), std::runtime_error);
+  std::filesystem::remove_all(path);
+}
+
+TEST(MappedLoad, db) {
+  const auto path = std::filesystem::temp_directory_path() / "deadfood_mmap";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  const auto value = [](Database& db, const std::string& query) {
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    EXPECT_TRUE(scan->Next());
+    return scan->GetField(fields[0]);
+  };
+  const auto contents = [](const std::filesystem::path& file) {
+    std::ifstream stream(file, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(stream), {});
+  };
+  std::string rows = "INSERT INTO t VALUES (0, 0)";
+  for (int i = 1; i < 5000; ++i) {
+    rows += ", (" + std::to_string(i) + ", " + std::to_string(i % 7) + ")";
+  }
+  {
+    Database db;
+    ProcessQueryInternal(db, "CREATE TABLE t (i INT, v INT)");
+    ProcessQueryInternal(db, "CREATE TABLE c (i INT) WITH (storage = column)");
+    ProcessQueryInternal(db, rows);
+    ProcessQueryInternal(db, "INSERT INTO c VALUES (1), (2)");
+    ProcessQueryInternal(db, "DELETE FROM t WHERE i < 10");
+    const auto& storage = db.table_storage("t");
+    // the rows span two pages, written as they are
+    ASSERT_EQ((storage.slot_count() + storage.slots_per_page() - 1) /
+                  storage.slots_per_page(),
+              2);
+    Dump(db, path);
+    ASSERT_EQ(std::filesystem::file_size(path / "t.0.1.pages"),
+              storage::PageFile::kPageFileHeaderSize + 2 * storage.page_size());
+  }
+  ASSERT_FALSE(std::filesystem::exists(path / "c.0.1.pages"));
+
+  const auto pages = contents(path / "t.0.1.pages");
+  {
+    Database db = Load(path, {.map_files = true});
+    ASSERT_EQ(db.table_storage("t").size(), 4990);
+    ASSERT_EQ(db.table_storage("c").size(), 2);
+    ASSERT_EQ(value(db, "SELECT v FROM t WHERE t.i = 4321"),
+              core::FieldVariant{4321 % 7});
+    ProcessQueryInternal(db, "UPDATE t SET v = 100 WHERE i = 4321");
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (5000, 1)");
+    ASSERT_EQ(value(db, "SELECT v FROM t WHERE t.i = 4321"),
+              core::FieldVariant{100});
+    // the pages written to are private copies, the file stays as it was
+    ASSERT_EQ(contents(path / "t.0.1.pages"), pages);
+    Dump(db, path);
+  }
+  {
+    Database db = Load(path);
+    ASSERT_EQ(db.table_storage("t").size(), 4991);
+    ASSERT_EQ(value(db, "SELECT v FROM t WHERE t.i = 4321"),
+              core::FieldVariant{100});
+    ASSERT_EQ(value(db, "SELECT v FROM t WHERE t.i = 5000"),
+              core::FieldVariant{1});
+  }
+
+  {
+    // pages that are read are checked, mapped ones are not
+    std::fstream file(path / "t.0.2.pages",
+                      std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(storage::PageFile::kPageFileHeaderSize + 100);
+    file.put('\x7f');
+  }
+  ASSERT_THROW(Load(path), std::runtime_error);
+  ASSERT_NO_THROW(Load(path, {.map_files = true}));
+  std::filesystem::remove_all(path);
+}
+
+TEST(LazyLoad, db) {
+  const auto path = std::filesystem::temp_directory_path() / "deadfood_lazy";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  {
+    Database db;
+    ProcessQueryInternal(db, "CREATE TABLE u (a INT UNIQUE)");
+    ProcessQueryInternal(db, "CREATE TABLE o (v INT)");
+    ProcessQueryInternal(db, "CREATE TABLE c (i INT) WITH (storage = column)");
+    ProcessQueryInternal(db, "CREATE INDEX o_v ON o (v)");
+    ProcessQueryInternal(db, "INSERT INTO u VALUES (1), (2)");
+    ProcessQueryInternal(db, "INSERT INTO o VALUES (3), (1), (2)");
+    ProcessQueryInternal(db, "INSERT INTO c VALUES (5)");
+    Dump(db, path);
+  }
+  {
+    Database db = Load(path, {.lazy = true});
+    ASSERT_EQ(db.table_names(), std::set<std::string>({"c", "o", "u"}));
+    ASSERT_FALSE(db.IsLoaded("u"));
+    ASSERT_EQ(db.layout("c"), storage::Layout::Column);
+    ASSERT_FALSE(db.IsLoaded("c"));
+
+    // a table gets its indices as it is loaded
+    ASSERT_THROW(ProcessQueryInternal(db, "INSERT INTO u VALUES (2)"),
+                 std::runtime_error);
+    ASSERT_TRUE(db.IsLoaded("u"));
+    ASSERT_FALSE(db.IsLoaded("o"));
+    ASSERT_NE(db.table_storage("o").btree_index("v"), nullptr);
+    ProcessQueryInternal(db, "INSERT INTO u VALUES (3)");
+
+    // the table never used keeps its files
+    Dump(db, path);
+    ASSERT_FALSE(db.IsLoaded("c"));
+    ASSERT_TRUE(std::filesystem::exists(path / "c.0.1.dat"));
+    ProcessQueryInternal(db, "INSERT INTO c VALUES (6)");
+  }
+  {
+    // the change logged since is replayed into the table it loads
+    Database db = Load(path, {.lazy = true});
+    ASSERT_TRUE(db.IsLoaded("c"));
+    ASSERT_FALSE(db.IsLoaded("o"));
+    ASSERT_EQ(db.table_storage("c").size(), 2);
+  }
+  {
+    Database db = Load(path);
+    for (const auto& table_name : db.table_names()) {
+      ASSERT_TRUE(db.IsLoaded(table_name));
+    }
+    ASSERT_EQ(db.table_storage("u").size(), 3);
+    ASSERT_EQ(db.table_storage("o").size(), 3);
+    ASSERT_NE(db.table_storage("u").hash_index("a"), nullptr);
+  }
+  std::filesystem::remove_all(path);
+}
+
+TEST(BatchMatchesRowwise, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE t (a INT, b FLOAT, c VARCHAR(8))");
+  for (int i = 0; i < 100; ++i) {
+    const auto b = i % 9 == 0 ? std::string{"NULL"} : std::to_string(i) + ".5";
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (" + std::to_string(i) +
+                                 ", " + b + ", 'x" + std::to_string(i % 3) +
+                                 "')");
+  }
+
+  ProcessQueryInternal(db, "CREATE TABLE l (id INT, x INT)");
+  ProcessQueryInternal(db, "CREATE TABLE r (id INT, y INT)");
+  ProcessQueryInternal(db, "INSERT INTO l VALUES (1, 10), (2, 20)");
+  ProcessQueryInternal(db, "INSERT INTO r VALUES (1, 5)");
+
+  // the second query is a nested-loop LEFT JOIN, which the default
+  // `NextBatch` goes through row by row
+  for (const std::string query :
+       {"SELECT a, c, a * 2 + b AS s FROM t WHERE a > 10 AND c = 'x1' OR "
+        "s IS NULL",
+        "SELECT l.id, q.y FROM l LEFT JOIN r q ON l.x < q.y + 8"}) {
+    std::vector<std::vector<core::FieldVariant>> rowwise;
+    {
+      auto result = ProcessQueryInternal(db, query);
+      ASSERT_TRUE(result.has_value());
+      auto& [scan, fields] = result.value();
+      while (scan->Next()) {
+        auto& row = rowwise.emplace_back();
+        for (const auto& field : fields) {
+          row.push_back(scan->GetField(field));
+        }
+      }
+    }
+    ASSERT_GT(rowwise.size(), 0);
+
+    std::vector<std::vector<core::FieldVariant>> batched;
+    {
+      auto result = ProcessQueryInternal(db, query);
+      ASSERT_TRUE(result.has_value());
+      auto& [scan, fields] = result.value();
+      scan::ColumnBatch batch{fields, 7};
+      while (scan->NextBatch(batch)) {
+        for (const auto row : batch.selection()) {
+          auto& values = batched.emplace_back();
+          for (size_t i = 0; i < fields.size(); ++i) {
+            values.push_back(batch.column(i).Get(row));
+          }
+        }
+      }
+      // an exhausted scan stays exhausted
+      ASSERT_FALSE(scan->NextBatch(batch));
+      ASSERT_FALSE(scan->Next());
+    }
+    ASSERT_EQ(rowwise, batched) << query;
+  }
+}
+
+TEST(BoundFieldsOuterJoin, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE t1 (id INT)");
+  ProcessQueryInternal(db, "CREATE TABLE t2 (ref INT, w INT)");
+  ProcessQueryInternal(db, "INSERT INTO t1 VALUES (1), (2), (3)");
+  ProcessQueryInternal(db, "INSERT INTO t2 VALUES (1, 10), (3, 30)");
+
+  // the first query takes the hash join, the second the nested loop
+  for (const std::string on : {"u.ref = t1.id", "u.ref = t1.id OR u.ref < 0"}) {
+    auto result = ProcessQueryInternal(
+        db, "SELECT t1.id, u.w + 1 AS x FROM t1 LEFT JOIN t2 u ON " + on);
+    ASSERT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    size_t count = 0;
+    while (scan->Next()) {
+      const auto id = std::get<int>(scan->GetField("t1.id"));
+      const auto x = scan->GetField("x");
+      if (id == 2) {
+        ASSERT_TRUE(std::holds_alternative<core::null_t>(x));
+      } else {
+        ASSERT_EQ(std::get<int>(x), id * 10 + 1);
+      }
+      ++count;
+    }
+    ASSERT_EQ(count, 3);
+  }
+}
+
+TEST(ColumnStorage, db) {
+  const auto path =
+      std::filesystem::temp_directory_path() / "deadfood_column_dump";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  {
+    Database db;
+    ProcessQueryInternal(db,
+                         "CREATE TABLE t (a INT PRIMARY KEY, b VARCHAR(10), "
+                         "c DOUBLE) WITH (storage = column)");
+    ASSERT_EQ(db.table_storage("t").layout(), storage::Layout::Column);
+    ASSERT_THROW(ProcessQueryInternal(
+                     db, "CREATE TABLE u (a INT) WITH (storage = diagonal)"),
+                 std::runtime_error);
+    for (int i = 0; i < 20; ++i) {
+      ProcessQueryInternal(db, "INSERT INTO t VALUES (" + std::to_string(i) +
+                                   ", 'v" + std::to_string(i % 4) + "', " +
+                                   (i % 5 == 0 ? "NULL" : "1.5") + ")");
+    }
+    ProcessQueryInternal(db, "DELETE FROM t WHERE a < 5");
+    ProcessQueryInternal(db, "UPDATE t SET c = 2.5 WHERE a = 10");
+    // a reused slot must not keep the values of the deleted row
+    ProcessQueryInternal(db, "INSERT INTO t (a) VALUES (100)");
+    Dump(db, path);
+  }
+  Database db = Load(path);
+  ASSERT_EQ(db.table_storage("t").layout(), storage::Layout::Column);
+
+  auto result = ProcessQueryInternal(db, "SELECT a, b, c FROM t WHERE a = 100");
+  ASSERT_TRUE(result.has_value());
+  {
+    auto& [scan, fields] = result.value();
+    ASSERT_TRUE(scan->Next());
+    ASSERT_EQ(std::get<std::string>(scan->GetField("b")), "");
+    ASSERT_EQ(std::get<double>(scan->GetField("c")), 0.0);
+    ASSERT_FALSE(scan->Next());
+  }
+  result = ProcessQueryInternal(db, "SELECT a, c FROM t");
+  ASSERT_TRUE(result.has_value());
+  {
+    auto& [scan, fields] = result.value();
+    size_t null_count = 0;
+    while (scan->Next()) {
+      null_count += std::holds_alternative<core::null_t>(scan->GetField("c"));
+    }
+    ASSERT_EQ(null_count, 2);
+  }
+  result = ProcessQueryInternal(db, "SELECT b FROM t WHERE b = 'v1'");
+  ASSERT_TRUE(result.has_value());
+  ASSERT_EQ(CountRows(*result.value().first), 4);
+  result = ProcessQueryInternal(db, "SELECT a, c FROM t WHERE c = 2.5");
+  ASSERT_TRUE(result.has_value());
+  ASSERT_EQ(CountRows(*result.value().first), 1);
+  std::filesystem::remove_all(path);
+}
+
+TEST(SimdFilterMatchesRowwise, db) {
+  Database db;
+  ProcessQueryInternal(
+      db, "CREATE TABLE t (i INT, f FLOAT, d DOUBLE, b BOOLEAN, j INT)");
+  // an odd row count leaves tails behind every vector width
+  for (int k = 0; k < 203; ++k) {
+    const auto f = k % 11 == 0 ? std::string{"NULL"} : std::to_string(k % 17);
+    ProcessQueryInternal(
+        db, "INSERT INTO t VALUES (" + std::to_string(k % 23) + ", " + f +
+                ", " + std::to_string(k) + ".25, " +
+                (k % 3 == 0 ? "1" : "0") + ", " +
+                std::to_string(k % 7) + ")");
+  }
+
+  for (const std::string predicate :
+       {"i = 5", "i < 10", "i > 10", "10 < i", "j = i", "j < i", "f = 3",
+        "f < 8", "8 < j", "f < 2.5", "d < 100.25", "d > 99.5", "d = 50.25",
+        "b = 1", "i < 10.5", "i < 12 AND d > 20"}) {
+    const auto query = "SELECT i, f, d, b, j FROM t WHERE " + predicate;
+    auto rowwise = ProcessQueryInternal(db, query);
+    ASSERT_TRUE(rowwise.has_value());
+    const auto expected = CountRows(*rowwise.value().first);
+
+    auto batched = ProcessQueryInternal(db, query);
+    ASSERT_TRUE(batched.has_value());
+    auto& [scan, fields] = batched.value();
+    scan::ColumnBatch batch{fields};
+    size_t count = 0;
+    while (scan->NextBatch(batch)) {
+      count += batch.selection().size();
+    }
+    ASSERT_EQ(count, expected) << predicate;
+  }
+}
+
+TEST(TypedMatchesInterpreted, db) {
+  Database db;
+  ProcessQueryInternal(db,
+                       "CREATE TABLE t (i INT, f FLOAT, d DOUBLE, b BOOLEAN)");
+  for (int k = 0; k < 60; ++k) {
+    const auto f = k % 7 == 0 ? std::string{"NULL"} : std::to_string(k % 13);
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (" + std::to_string(k % 11) +
+                                 ", " + f + ", " + std::to_string(k) +
+                                 ".25, " + (k % 4 == 0 ? "1" : "0") + ")");
+  }
+
+  // rows are evaluated by the compiled trees, batches by the interpreted
+  // expressions they were compiled from
+  for (const std::string predicate :
+       {"NOT i < 5 AND f < 10 OR b = 1", "i >= 3 XOR d <= 40.25",
+        "f = 3 OR f < 2", "f * 2 < i", "f != 4 AND NOT b = 1",
+        "i + d / 2 >= 10", "-i < -4 OR f / 4 < 1.5"}) {
+    const auto query =
+        "SELECT i, f, d, b, i * 2 + d AS s, f / 2 - i AS g, i / 3 AS q "
+        "FROM t WHERE " +
+        predicate;
+    std::vector<std::vector<core::FieldVariant>> rowwise;
+    {
+      auto result = ProcessQueryInternal(db, query);
+      ASSERT_TRUE(result.has_value());
+      auto& [scan, fields] = result.value();
+      while (scan->Next()) {
+        auto& row = rowwise.emplace_back();
+        for (const auto& field : fields) {
+          row.push_back(scan->GetField(field));
+        }
+      }
+    }
+    ASSERT_GT(rowwise.size(), 0) << predicate;
+
+    std::vector<std::vector<core::FieldVariant>> batched;
+    {
+      auto result = ProcessQueryInternal(db, query);
+      ASSERT_TRUE(result.has_value());
+      auto& [scan, fields] = result.value();
+      scan::ColumnBatch batch{fields, 16};
+      while (scan->NextBatch(batch)) {
+        for (const auto row : batch.selection()) {
+          auto& values = batched.emplace_back();
+          for (size_t i = 0; i < fields.size(); ++i) {
+            values.push_back(batch.column(i).Get(row));
+          }
+        }
+      }
+    }
+    ASSERT_EQ(rowwise, batched) << predicate;
+  }
+}
+
+TEST(PredicatePushdown, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE a (id INT, x INT)");
+  ProcessQueryInternal(db, "CREATE TABLE b (aid INT, y INT)");
+  ProcessQueryInternal(db, "CREATE TABLE c (z INT)");
+  for (int k = 0; k < 40; ++k) {
+    ProcessQueryInternal(db, "INSERT INTO a VALUES (" + std::to_string(k) +
+                                 ", " + std::to_string(k % 4) + ")");
+  }
+  for (int k = 0; k < 60; ++k) {
+    ProcessQueryInternal(db, "INSERT INTO b VALUES (" +
+                                 std::to_string(k % 45) + ", " +
+                                 std::to_string(k % 3) + ")");
+  }
+  for (int k = 0; k < 5; ++k) {
+    ProcessQueryInternal(db, "INSERT INTO c VALUES (" + std::to_string(k) + ")");
+  }
+
+  // a WHERE clause under OR is not split, so it is checked on the product;
+  // the join order may differ, the rows may not
+  const auto rows = [&](const std::string& select, const std::string& where) {
+    std::vector<std::vector<core::FieldVariant>> ret;
+    auto result = ProcessQueryInternal(db, select + " WHERE " + where);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    while (scan->Next()) {
+      auto& row = ret.emplace_back();
+      for (const auto& field : fields) {
+        row.push_back(scan->GetField(field));
+      }
+    }
+    std::ranges::sort(ret);
+    return ret;
+  };
+  const std::vector<std::pair<std::string, std::string>> queries = {
+      {"SELECT a.id, b.y FROM a, b", "a.id = b.aid AND a.x = 1 AND b.y = 2"},
+      {"SELECT * FROM a, b, c", "a.id = b.aid AND b.y = c.z AND a.x < 3"},
+      {"SELECT * FROM a, c", "a.x = c.z AND a.id < 10 AND c.z > 0"},
+      {"SELECT a.id, bb.y FROM a LEFT JOIN b bb ON a.id = bb.aid",
+       "bb.y = 2 AND a.x = 1"},
+      {"SELECT a.id, a.x, bb.y FROM a RIGHT JOIN b bb ON a.id = bb.aid",
+       "a.x = 1 AND bb.y < 2"}};
+  for (const auto& [select, where] : queries) {
+    const auto pushed = rows(select, where);
+    ASSERT_GT(pushed.size(), 0) << select;
+    ASSERT_EQ(pushed, rows(select, "(" + where + ") OR 1 = 0")) << select;
+  }
+
+  // every conjunct is consumed below the top of the plan
+  auto result = ProcessQueryInternal(
+      db, "SELECT a.id, b.y FROM a, b WHERE a.id = b.aid AND b.y = 2");
+  ASSERT_TRUE(result.has_value());
+  ASSERT_NE(dynamic_cast<scan::HashJoinScan*>(result.value().first.get()),
+            nullptr);
+}
+
+TEST(Statistics, db) {
+  const auto path = std::filesystem::temp_directory_path() / "deadfood_stats";
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  {
+    Database db;
+    ProcessQueryInternal(db, "CREATE TABLE t (a INT, b INT, c VARCHAR(4))");
+    ProcessQueryInternal(db, "CREATE TABLE u (b INT)");
+    for (int i = 0; i < 100; ++i) {
+      const auto b = i % 10 == 0 ? std::string{"NULL"} : std::to_string(i % 5);
+      ProcessQueryInternal(db, "INSERT INTO t VALUES (" + std::to_string(i) +
+                                   ", " + b + ", 'x')");
+    }
+    ProcessQueryInternal(db, "INSERT INTO u VALUES (1), (2)");
+    ASSERT_THROW(ProcessQueryInternal(db, "ANALYZE v"), std::runtime_error);
+    ProcessQueryInternal(db, "ANALYZE t");
+    ASSERT_TRUE(db.stats().contains("t"));
+    ASSERT_FALSE(db.stats().contains("u"));
+    ProcessQueryInternal(db, "ANALYZE");
+    ASSERT_TRUE(db.stats().contains("u"));
+    Dump(db, path);
+  }
+  Database db = Load(path);
+  std::filesystem::remove_all(path);
+  ASSERT_EQ(db.stats().size(), 2);
+  const auto& stats = db.stats().at("t");
+  ASSERT_EQ(stats.row_count, 100);
+  ASSERT_EQ(stats.columns.at("a").null_count, 0);
+  ASSERT_EQ(stats.columns.at("a").distinct_count, 100);
+  ASSERT_EQ(stats.columns.at("a").bounds.size(), 17);
+  ASSERT_EQ(stats.columns.at("a").bounds.front(), 0);
+  ASSERT_EQ(stats.columns.at("a").bounds.back(), 99);
+  ASSERT_EQ(stats.columns.at("b").null_count, 10);
+  ASSERT_EQ(stats.columns.at("b").distinct_count, 5);
+  ASSERT_EQ(stats.columns.at("c").distinct_count, 1);
+  ASSERT_TRUE(stats.columns.at("c").bounds.empty());
+
+  ASSERT_EQ(exec::util::EstimateRows(db, "t"), 100);
+  ASSERT_EQ(exec::util::EstimateDistinct(db, "t", "b"), 5);
+  const auto selectivity = [&](const std::string& where) {
+    const auto query =
+        parse::ParseSelectQuery(lex::Lex("SELECT a, b FROM t WHERE " + where));
+    return exec::util::EstimateSelectivity(db, "t", "t",
+                                           query.predicate.value());
+  };
+  ASSERT_NEAR(selectivity("a < 50"), 0.5, 0.05);
+  ASSERT_NEAR(selectivity("b = 3"), 0.18, 0.01);
+  ASSERT_NEAR(selectivity("b != 3"), 0.82, 0.01);
+  ASSERT_NEAR(selectivity("a < 50 AND b = 3"), 0.09, 0.01);
+  ASSERT_LT(selectivity("a < 10"), selectivity("a < 50 OR a < 10") + 1e-9);
+
+  // an index that would return most of the table is not worth using
+  ProcessQueryInternal(db, "CREATE INDEX t_a ON t (a)");
+  const auto index_scan = [&](const std::string& where) {
+    const auto query =
+        parse::ParseSelectQuery(lex::Lex("SELECT a FROM t WHERE " + where));
+    return exec::util::GetIndexScan(db, "t", "t", query.predicate.value());
+  };
+  ASSERT_NE(index_scan("a = 7"), nullptr);
+  ASSERT_NE(index_scan("a < 10"), nullptr);
+  ASSERT_EQ(index_scan("a > 10"), nullptr);
+
+  // the join order follows the estimates, the rows do not
+  const auto count = [&](const std::string& query) {
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    size_t rows = 0;
+    while (result.value().first->Next()) {
+      ++rows;
+    }
+    return rows;
+  };
+  ASSERT_EQ(count("SELECT * FROM t, u WHERE t.b = u.b"), 40);
+  ASSERT_EQ(count("SELECT * FROM u, t WHERE t.b = u.b AND t.a < 50"), 20);
+}
+
+TEST(ThreadPool, db) {
+  util::ThreadPool pool(4);
+  std::vector<int> runs(1000);
+  std::vector<size_t> busy(pool.size());
+  pool.Run(runs.size(), [&](size_t worker, size_t i) {
+    ++runs[i];
+    ++busy[worker];
+  });
+  ASSERT_TRUE(std::ranges::all_of(runs, [](int n) { return n == 1; }));
+  ASSERT_EQ(std::accumulate(busy.begin(), busy.end(), size_t{0}), 1000);
+
+  ASSERT_THROW(pool.Run(10,
+                        [](size_t, size_t i) {
+                          if (i == 7) {
+                            throw std::runtime_error("task failed");
+                          }
+                        }),
+               std::runtime_error);
+  // the pool is still usable after a failed batch
+  std::atomic<size_t> done = 0;
+  pool.Run(3, [&](size_t, size_t) { ++done; });
+  ASSERT_EQ(done, 3);
+}
+
+TEST(ParallelScan, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE t (a INT, b VARCHAR(8))");
+  for (int i = 0; i < 500; ++i) {
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (" + std::to_string(i) +
+                                 ", 'x" + std::to_string(i % 7) + "')");
+  }
+  ProcessQueryInternal(db, "DELETE FROM t WHERE a < 20");
+
+  util::ThreadPool pool(3);
+  const auto parse = [](const std::string& where) {
+    return parse::ParseSelectQuery(lex::Lex("SELECT a, b FROM t WHERE " + where))
+        .predicate.value();
+  };
+  for (const auto& where : {"a / 3 * 3 = a AND b != 'x2'", "a > 1000", "a >= 0"}) {
+    const auto predicate = parse(where);
+    const auto build = [&](std::unique_ptr<scan::TableScan> table) {
+      expr::ExprTreeConverter converter{
+          std::make_unique<expr::SimpleScanSelector>(table.get())};
+      auto expr = converter.ConvertExprTreeToIExpr(predicate);
+      return std::make_unique<scan::SelectScan>(std::move(table),
+                                                expr::BoolExpr(std::move(expr)));
+    };
+    std::vector<std::pair<core::FieldVariant, core::FieldVariant>> serial;
+    auto scan = build(db.GetTableScan("t"));
+    while (scan->Next()) {
+      serial.emplace_back(scan->GetField("a"), scan->GetField("b"));
+    }
+    // tiny morsels so that every worker gets several of them
+    scan::ParallelScan parallel(db.table_storage("t"), db.schemas().at("t"),
+                                "t", build, {"a", "b"}, pool, 16);
+    for (int pass = 0; pass < 2; ++pass) {
+      std::vector<std::pair<core::FieldVariant, core::FieldVariant>> rows;
+      parallel.BeforeFirst();
+      while (parallel.Next()) {
+        rows.emplace_back(parallel.GetField("t.a"), parallel.GetField("b"));
+      }
+      ASSERT_EQ(rows, serial) << where;
+    }
+  }
+
+  // errors raised on a worker reach the caller
+  const auto bad = parse("a < 'x'");
+  scan::ParallelScan failing(
+      db.table_storage("t"), db.schemas().at("t"), "t",
+      [&](std::unique_ptr<scan::TableScan> table) {
+        expr::ExprTreeConverter converter{
+            std::make_unique<expr::SimpleScanSelector>(table.get())};
+        auto expr = converter.ConvertExprTreeToIExpr(bad);
+        return std::make_unique<scan::SelectScan>(
+            std::move(table), expr::BoolExpr(std::move(expr)));
+      },
+      {"a"}, pool, 16);
+  ASSERT_THROW(failing.Next(), std::runtime_error);
+}
+
+TEST(RadixJoin, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE a (id INT, k INT)");
+  ProcessQueryInternal(db, "CREATE TABLE b (k INT, v VARCHAR(8))");
+  for (int i = 0; i < 300; ++i) {
+    const auto k = i % 11 == 0 ? std::string{"NULL"} : std::to_string(i % 40);
+    ProcessQueryInternal(db, "INSERT INTO a VALUES (" + std::to_string(i) +
+                                 ", " + k + ")");
+  }
+  for (int i = 0; i < 120; ++i) {
+    const auto k = i % 13 == 0 ? std::string{"NULL"} : std::to_string(i % 55);
+    ProcessQueryInternal(db, "INSERT INTO b VALUES (" + k + ", 'v" +
+                                 std::to_string(i) + "')");
+  }
+  ProcessQueryInternal(db, "DELETE FROM a WHERE id < 15");
+
+  const auto predicate =
+      parse::ParseSelectQuery(
+          lex::Lex("SELECT * FROM a WHERE a.k = b.k AND a.id != 20"))
+          .predicate.value();
+  const auto rows = [&](scan::IScan& join) {
+    expr::ExprTreeConverter converter{
+        std::make_unique<expr::SimpleScanSelector>(&join)};
+    auto expr = converter.ConvertExprTreeToIExpr(predicate);
+    if (auto* radix = dynamic_cast<scan::RadixJoinScan*>(&join)) {
+      radix->set_predicate(std::move(expr));
+    } else {
+      dynamic_cast<scan::HashJoinScan&>(join).set_predicate(std::move(expr));
+    }
+    std::vector<std::vector<core::FieldVariant>> ret;
+    join.BeforeFirst();
+    while (join.Next()) {
+      ret.push_back({join.GetField("a.id"), join.GetField("a.k"),
+                     join.GetField("b.k"), join.GetField("b.v")});
+    }
+    std::ranges::sort(ret);
+    return ret;
+  };
+
+  util::ThreadPool pool(3);
+  using Mode = scan::HashJoinScan::Mode;
+  for (const auto mode :
+       {Mode::Inner, Mode::PreserveProbe, Mode::PreserveBuild}) {
+    scan::HashJoinScan hash(db.GetTableScan("a"), db.GetTableScan("b"), "a.k",
+                            "b.k", mode);
+    const auto expected = rows(hash);
+    ASSERT_GT(expected.size(), 0);
+    for (const size_t radix_bits : {size_t{0}, size_t{1}, size_t{3}}) {
+      scan::RadixJoinScan radix(db.GetTableScan("a"), db.GetTableScan("b"),
+                                "a.k", "b.k", mode, pool, radix_bits);
+      ASSERT_EQ(rows(radix), expected) << radix_bits;
+      // the partitions are reused by a second pass
+      ASSERT_EQ(rows(radix), expected) << radix_bits;
+    }
+  }
+}
+
+TEST(GroupBy, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE t (k INT, v DOUBLE, s VARCHAR(8))");
+
+  const auto rows = [&](const std::string& query) {
+    std::vector<std::vector<core::FieldVariant>> ret;
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    while (scan->Next()) {
+      auto& row = ret.emplace_back();
+      for (const auto& field : fields) {
+        row.push_back(scan->GetField(field));
+      }
+    }
+    return ret;
+  };
+  using Row = std::vector<core::FieldVariant>;
+
+  // the aggregates of no rows at all
+  ASSERT_EQ(rows("SELECT COUNT(*) AS n, SUM(k) AS sk, MAX(s) AS m FROM t"),
+            std::vector<Row>({{0, core::null_t{}, core::null_t{}}}));
+  ASSERT_TRUE(rows("SELECT k, COUNT(*) AS n FROM t GROUP BY k").empty());
+
+  // enough groups for the table to grow a few times
+  for (int i = 0; i < 1000; ++i) {
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (" +
+                                 std::to_string(i % 300) + ", " +
+                                 std::to_string(i) + ".5, 's" +
+                                 std::to_string(i % 3) + "')");
+  }
+  ProcessQueryInternal(db, "INSERT INTO t VALUES (NULL, 1.0, NULL)");
+  ProcessQueryInternal(db, "INSERT INTO t VALUES (NULL, 2.0, 's0')");
+
+  const auto groups =
+      rows("SELECT k, COUNT(*) AS n, SUM(v) AS total, AVG(v) AS mean FROM t "
+           "GROUP BY k");
+  ASSERT_EQ(groups.size(), 301);
+  for (size_t i = 0; i < 300; ++i) {
+    // groups come out in the order they were first seen
+    ASSERT_EQ(groups[i][0], core::FieldVariant(static_cast<int>(i)));
+    const int count = i < 100 ? 4 : 3;
+    double total = 0;
+    for (int j = 0; j < count; ++j) {
+      total += static_cast<double>(i) + 300.0 * j + 0.5;
+    }
+    ASSERT_EQ(groups[i][1], core::FieldVariant(count));
+    ASSERT_EQ(groups[i][2], core::FieldVariant(total));
+    ASSERT_EQ(groups[i][3], core::FieldVariant(total / count));
+  }
+  ASSERT_EQ(groups[300], Row({core::null_t{}, 2, 3.0, 1.5}));
+
+  ASSERT_EQ(rows("SELECT s, COUNT(*) AS n, COUNT(k) AS nk, MIN(k) AS lo, "
+                 "MAX(k) AS hi, SUM(k) AS total FROM t GROUP BY s"),
+            std::vector<Row>({{"s0", 335, 334, 0, 297, 46233},
+                              {"s1", 333, 333, 1, 298, 46467},
+                              {"s2", 333, 333, 2, 299, 46800},
+                              {core::null_t{}, 1, 0, core::null_t{},
+                               core::null_t{}, core::null_t{}}}));
+
+  // WHERE filters the rows, HAVING the groups, which are computed by
+  // expression
+  ASSERT_EQ(rows("SELECT k + 1 AS next, SUM(k) * 2 AS twice FROM t "
+                 "WHERE t.k < 150 GROUP BY k + 1 HAVING COUNT(*) > 3 AND "
+                 "next > 98"),
+            std::vector<Row>({{99, 784}, {100, 792}}));
+  ASSERT_EQ(rows("SELECT COUNT(*) AS n, SUM(k) AS sk FROM t WHERE t.k < 3"),
+            std::vector<Row>({{12, 12}}));
+
+  ASSERT_THROW(rows("SELECT s, COUNT(*) AS n FROM t GROUP BY k"),
+               std::runtime_error);
+  ASSERT_THROW(rows("SELECT k FROM t WHERE COUNT(*) > 1"), std::runtime_error);
+  ASSERT_THROW(rows("SELECT SUM(COUNT(k)) AS n FROM t"), std::runtime_error);
+  ASSERT_THROW(rows("SELECT SUM(s) AS n FROM t"), std::runtime_error);
+  ASSERT_THROW(rows("SELECT COUNT(k AS n FROM t"), std::runtime_error);
+
+  // a sum past the range of INT does not wrap around
+  ProcessQueryInternal(db, "CREATE TABLE big (k INT)");
+  ProcessQueryInternal(
+      db, "INSERT INTO big VALUES (2147483647), (2147483647), (1)");
+  ASSERT_EQ(rows("SELECT SUM(k) AS total, AVG(k) AS mean FROM big"),
+            std::vector<Row>({{4294967295.0, 1431655765.0}}));
+  ASSERT_EQ(rows("SELECT SUM(k) AS total FROM big WHERE big.k < 2"),
+            std::vector<Row>({{1}}));
+}
+
+TEST(OrderBy, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE t (i INT, d DOUBLE, s VARCHAR(16))");
+  std::vector<std::vector<core::FieldVariant>> expected;
+  for (int k = 0; k < 500; ++k) {
+    // negative numbers, long shared string prefixes and NULLs in every column
+    const int i = (k * 37) % 101 - 50;
+    // whole numbers, which survive the round trip through a literal
+    const double d = k % 7 == 0 ? -(k % 13) : (k % 41) * 3 - 20;
+    const std::string s = "prefix__" + std::to_string((k * 7) % 23);
+    const auto null_or = [&](int every, const core::FieldVariant& value) {
+      return k % every == 0 ? core::FieldVariant(core::null_t{}) : value;
+    };
+    expected.push_back({null_or(11, i), null_or(17, d), null_or(19, s)});
+    const auto literal = [](const core::FieldVariant& value) {
+      return std::visit(
+          [](auto&& arg) -> std::string {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, core::null_t>) {
+              return "NULL";
+            } else if constexpr (std::is_same_v<T, std::string>) {
+              return "'" + arg + "'";
+            } else {
+              return std::to_string(arg);
+            }
+          },
+          value);
+    };
+    const auto& row = expected.back();
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (" + literal(row[0]) +
+                                 ", " + literal(row[1]) + ", " +
+                                 literal(row[2]) + ")");
+  }
+
+  const auto rows = [&](const std::string& query) {
+    std::vector<std::vector<core::FieldVariant>> ret;
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    while (scan->Next()) {
+      auto& row = ret.emplace_back();
+      for (const auto& field : fields) {
+        row.push_back(scan->GetField(field));
+      }
+    }
+    return ret;
+  };
+  // (column, descending) pairs; ties keep the table order
+  const auto sorted = [&](std::vector<std::pair<size_t, bool>> keys) {
+    auto ret = expected;
+    const core::FieldKeyLess less;
+    std::ranges::stable_sort(ret, [&](const auto& lhs, const auto& rhs) {
+      for (const auto& [column, descending] : keys) {
+        if (less(lhs[column], rhs[column])) {
+          return !descending;
+        }
+        if (less(rhs[column], lhs[column])) {
+          return descending;
+        }
+      }
+      return false;
+    });
+    return ret;
+  };
+
+  ASSERT_EQ(rows("SELECT i, d, s FROM t ORDER BY i"), sorted({{0, false}}));
+  ASSERT_EQ(rows("SELECT i, d, s FROM t ORDER BY d DESC"),
+            sorted({{1, true}}));
+  ASSERT_EQ(rows("SELECT i, d, s FROM t ORDER BY s ASC, i DESC"),
+            sorted({{2, false}, {0, true}}));
+  ASSERT_EQ(rows("SELECT i, d, s FROM t ORDER BY s DESC, d"),
+            sorted({{2, true}, {1, false}}));
+
+  // by a computed field, by a column that is not selected, and from a
+  // subquery
+  const auto by_i = sorted({{0, false}});
+  auto result = rows("SELECT s, i * 2 AS twice FROM t ORDER BY twice");
+  ASSERT_EQ(result.size(), by_i.size());
+  for (size_t k = 0; k < result.size(); ++k) {
+    ASSERT_EQ(result[k][0], by_i[k][2]);
+  }
+  result = rows("SELECT s FROM t ORDER BY i");
+  for (size_t k = 0; k < result.size(); ++k) {
+    ASSERT_EQ(result[k][0], by_i[k][2]);
+  }
+  ASSERT_EQ(rows("SELECT x FROM (SELECT i AS x FROM t ORDER BY d) ORDER BY x "
+                 "DESC")
+                .front(),
+            std::vector<core::FieldVariant>({core::null_t{}}));
+  ASSERT_THROW(rows("SELECT i FROM t ORDER BY"), std::runtime_error);
+}
+
+TEST(Limit, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE t (i INT, v INT)");
+  for (int k = 0; k < 3000; ++k) {
+    ProcessQueryInternal(db, "INSERT INTO t VALUES (" + std::to_string(k) +
+                                 ", " + std::to_string((k * 7919) % 1000) +
+                                 ")");
+  }
+  const auto rows = [&](const std::string& query) {
+    std::vector<std::vector<core::FieldVariant>> ret;
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    while (scan->Next()) {
+      auto& row = ret.emplace_back();
+      for (const auto& field : fields) {
+        row.push_back(scan->GetField(field));
+      }
+    }
+    return ret;
+  };
+  const auto slice = [](const auto& all, size_t offset, size_t limit) {
+    const size_t begin = std::min(offset, all.size());
+    const size_t end = std::min(offset + limit, all.size());
+    return std::vector(all.begin() + static_cast<std::ptrdiff_t>(begin),
+                       all.begin() + static_cast<std::ptrdiff_t>(end));
+  };
+
+  // the top-N heap returns what a full sort does, ties in table order
+  for (const std::string order : {"v", "v DESC", "v, i DESC"}) {
+    const auto all = rows("SELECT i, v FROM t ORDER BY " + order);
+    ASSERT_EQ(all.size(), 3000);
+    for (const auto& [limit, offset] : std::vector<std::pair<size_t, size_t>>{
+             {0, 0}, {1, 0}, {10, 0}, {10, 25}, {100, 2950}, {5000, 3}}) {
+      ASSERT_EQ(rows("SELECT i, v FROM t ORDER BY " + order + " LIMIT " +
+                     std::to_string(limit) + " OFFSET " +
+                     std::to_string(offset)),
+                slice(all, offset, limit))
+          << order << " " << limit << " " << offset;
+    }
+  }
+  const auto all = rows("SELECT i, v FROM t WHERE t.v < 500");
+  ASSERT_EQ(rows("SELECT i, v FROM t WHERE t.v < 500 LIMIT 7 OFFSET 40"),
+            slice(all, 40, 7));
+  ASSERT_EQ(rows("SELECT i, v FROM t WHERE t.v < 500 OFFSET 1400"),
+            slice(all, 1400, all.size()));
+
+  // batches read no rows past the limit
+  scan::LimitScan limited(db.GetTableScan("t"), 5, 3);
+  scan::ColumnBatch batch({"t.i"});
+  limited.BeforeFirst();
+  ASSERT_TRUE(limited.NextBatch(batch));
+  ASSERT_EQ(batch.size(), 8);
+  ASSERT_EQ(batch.selection(), std::vector<uint32_t>({3, 4, 5, 6, 7}));
+  ASSERT_EQ(batch.capacity(), scan::ColumnBatch::kDefaultCapacity);
+  ASSERT_FALSE(limited.NextBatch(batch));
+}
+
+TEST(SetOperations, db) {
+  Database db;
+  ProcessQueryInternal(db, "CREATE TABLE a (k INT, s VARCHAR(8))");
+  ProcessQueryInternal(db, "CREATE TABLE b (k FLOAT, s VARCHAR(8))");
+  for (const std::string values :
+       {"1, 'x'", "1, 'x'", "2, 'y'", "NULL, 'z'", "NULL, 'z'"}) {
+    ProcessQueryInternal(db, "INSERT INTO a VALUES (" + values + ")");
+  }
+  for (const std::string values : {"1, 'x'", "3, 'w'", "NULL, 'z'"}) {
+    ProcessQueryInternal(db, "INSERT INTO b VALUES (" + values + ")");
+  }
+  const auto rows = [&](const std::string& query) {
+    std::vector<std::vector<core::FieldVariant>> ret;
+    auto result = ProcessQueryInternal(db, query);
+    EXPECT_TRUE(result.has_value());
+    auto& [scan, fields] = result.value();
+    while (scan->Next()) {
+      auto& row = ret.emplace_back();
+      for (const auto& field : fields) {
+        row.push_back(scan->GetField(field));
+      }
+    }
+    return ret;
+  };
+  using Rows = std::vector<std::vector<core::FieldVariant>>;
+  const core::FieldVariant null = core::null_t{};
+
+  // NULLs are not distinct from each other, first occurrences are kept
+  ASSERT_EQ(rows("SELECT DISTINCT k, s FROM a"),
+            Rows({{1, "x"}, {2, "y"}, {null, "z"}}));
+  ASSERT_EQ(rows("SELECT DISTINCT s FROM a WHERE a.k < 2"), Rows({{"x"}}));
+  ASSERT_EQ(rows("SELECT DISTINCT count(*) AS c FROM a GROUP BY s"),
+            Rows({{2}, {1}}));
+
+  // 1 and 1.0 are the same value
+  ASSERT_EQ(rows("SELECT k, s FROM a UNION SELECT k, s FROM b"),
+            Rows({{1, "x"}, {2, "y"}, {null, "z"}, {3.0F, "w"}}));
+  ASSERT_EQ(rows("SELECT k, s FROM a UNION ALL SELECT k, s FROM b").size(), 8);
+  ASSERT_EQ(rows("SELECT k, s FROM a INTERSECT SELECT k, s FROM b"),
+            Rows({{1, "x"}, {null, "z"}}));
+  ASSERT_EQ(rows("SELECT k, s FROM a EXCEPT SELECT k, s FROM b"),
+            Rows({{2, "y"}}));
+  // left to right, ORDER BY and LIMIT apply to the whole result
+  ASSERT_EQ(rows("SELECT s FROM a UNION ALL SELECT s FROM b EXCEPT "
+                 "SELECT s FROM b WHERE b.k < 2"),
+            Rows({{"y"}, {"z"}, {"w"}}));
+  ASSERT_EQ(rows("SELECT k, s FROM a UNION SELECT k, s FROM b "
+                 "ORDER BY s DESC LIMIT 2"),
+            Rows({{null, "z"}, {2, "y"}}));
+  ASSERT_EQ(rows("SELECT * FROM (SELECT s FROM a INTERSECT SELECT s FROM b)"),
+            Rows({{"x"}, {"z"}}));
+
+  ASSERT_THROW(
+      ProcessQueryInternal(db, "SELECT k FROM a UNION SELECT k, s FROM b"),
+      std::runtime_error);
+  ASSERT_THROW(ProcessQueryInternal(
+                   db, "SELECT k FROM a UNION SELECT k FROM b ORDER BY s"),
+               std::runtime_error);
+  ASSERT_THROW(ProcessQueryInternal(
+                   db, "SELECT k FROM a ORDER BY k UNION SELECT k FROM b"),
+               parse::ParserError);
+  ASSERT_THROW(ProcessQueryInternal(
+                   db, "SELECT k FROM a INTERSECT ALL SELECT k FROM b"),
+               parse::ParserError);
+
+  // batches drop the repeated rows from their selection
+  scan::DistinctScan distinct(db.GetTableScan("a"), {"a.s"});
+  scan::ColumnBatch batch({"a.k"});
+  distinct.BeforeFirst();
+  ASSERT_TRUE(distinct.NextBatch(batch));
+  ASSERT_EQ(batch.selection(), std::vector<uint32_t>({0, 2, 3}));
+  ASSERT_FALSE(distinct.NextBatch(batch));
+}
+
 }  // namespace deadfood::tests
\ No newline at end of file